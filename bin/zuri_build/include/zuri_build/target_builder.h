@@ -1,6 +1,10 @@
 #ifndef ZURI_BUILD_TARGET_BUILDER_H
 #define ZURI_BUILD_TARGET_BUILDER_H
 
+#include <span>
+
+#include <absl/synchronization/mutex.h>
+
 #include <lyric_build/lyric_builder.h>
 #include <tempo_utils/result.h>
 #include <zuri_distributor/runtime.h>
@@ -16,16 +20,38 @@ namespace zuri_build {
             std::shared_ptr<zuri_tooling::BuildGraph> buildGraph,
             lyric_build::LyricBuilder *builder,
             absl::flat_hash_map<std::string,tempo_utils::Url> &&targetBases,
-            const std::filesystem::path &installRoot);
+            const std::filesystem::path &installRoot,
+            int targetParallelism = 1);
 
         tempo_utils::Result<std::filesystem::path> buildTarget(const std::string &targetName);
+        tempo_utils::Result<absl::flat_hash_map<std::string,std::filesystem::path>> buildTargets(
+            std::span<const std::string> targetNames);
 
     private:
         std::shared_ptr<zuri_distributor::Runtime> m_runtime;
         std::shared_ptr<zuri_tooling::BuildGraph> m_buildGraph;
+        absl::Mutex m_builderLock;
         lyric_build::LyricBuilder *m_builder;
         absl::flat_hash_map<std::string,tempo_utils::Url> m_targetBases;
         std::filesystem::path m_installRoot;
+        int m_targetParallelism;
+
+        struct TargetModule {
+            tempo_utils::UrlPath modulePath;
+            lyric_build::LyricMetadata metadata;
+            std::shared_ptr<const tempo_utils::ImmutableBytes> content;
+        };
+
+        tempo_utils::Result<std::filesystem::path> buildScheduledTarget(
+            const std::string &targetName,
+            const absl::flat_hash_map<std::string,tempo_utils::Url> &targetBases);
+        tempo_utils::Result<tempo_utils::Url> installTarget(const std::filesystem::path &targetPath);
+        tempo_utils::Result<lyric_build::TargetComputationSet> computeTarget(
+            const lyric_build::TaskId &target,
+            const lyric_build::ComputeTargetOverrides &overrides);
+
+        tempo_utils::Result<std::vector<TargetModule>> loadTargetModules(
+            const lyric_build::TaskState &collectModulesState);
 
         tempo_utils::Result<std::filesystem::path> buildProgramTarget(
             const std::string &targetName,
@@ -11,6 +11,12 @@
 
 namespace zuri_build {
 
+    /**
+     * dot suffix of the file written alongside a target package which records the inputs the
+     * package was written from.
+     */
+    constexpr const char * const kTargetInputsDotSuffix = ".inputs";
+
     class TargetWriter {
     public:
         TargetWriter(
@@ -20,6 +26,8 @@ namespace zuri_build {
 
         tempo_utils::Status configure();
 
+        tempo_utils::Result<Option<std::filesystem::path>> findUnchangedTarget(std::string_view inputsDigest);
+
         void setDescription(std::string_view description);
         void setOwner(std::string_view owner);
         void setHomepage(std::string_view homepage);
@@ -27,6 +35,9 @@ namespace zuri_build {
         void setProgramMain(const lyric_common::ModuleLocation &programMain);
 
         tempo_utils::Status addRequirement(const zuri_packager::PackageSpecifier &specifier);
+        tempo_utils::Status addModuleRequirements(
+            const lyric_build::LyricMetadata &metadata,
+            std::shared_ptr<const tempo_utils::ImmutableBytes> content);
 
         tempo_utils::Status writeModule(
             const tempo_utils::UrlPath &modulePath,
@@ -40,6 +51,8 @@ namespace zuri_build {
         std::filesystem::path m_installRoot;
         zuri_packager::PackageSpecifier m_specifier;
 
+        std::string m_inputsDigest;
+
         std::vector<std::string> m_systemLibNames;
         std::vector<std::filesystem::path> m_distributionLibDirectories;
 
@@ -70,9 +83,11 @@ namespace zuri_build {
             const tempo_utils::UrlPath &path,
             std::span<const tu_uint8> content);
 
+        tempo_utils::Result<std::string> digestInputs(std::string_view inputsDigest);
         tempo_utils::Status determineLibrariesNeeded();
 
         tempo_utils::Status writePackageConfig();
+        tempo_utils::Status writeTargetInputs(const std::filesystem::path &packagePath);
     };
 }
 
@@ -19,6 +19,7 @@ zuri_build::ImportSolver::configure()
             "import solver is already configured");
 
     zuri_distributor::HttpPackageResolverOptions resolverOptions;
+    resolverOptions.metadataCache = m_runtime->getPackageDatabase();
     std::shared_ptr<zuri_distributor::AbstractPackageResolver> resolver;
     TU_ASSIGN_OR_RETURN (resolver, zuri_distributor::HttpPackageResolver::create(resolverOptions));
 
@@ -130,7 +131,8 @@ zuri_build::ImportSolver::installImports(std::shared_ptr<lyric_importer::Shortcu
 
         // request download if the package is not present in any of the available caches
         if (!m_runtime->containsPackage(selection.specifier)) {
-            TU_RETURN_IF_NOT_OK (m_fetcher->requestFile(selection.url, selection.specifier.toString()));
+            TU_RETURN_IF_NOT_OK (m_fetcher->requestFile(
+                selection.url, selection.specifier.toString(), selection.sha256));
             numPackagesToInstall++;
         } else {
             TU_LOG_V << "ignoring " << selection.specifier.toString() << ": already installed";
@@ -161,15 +163,20 @@ zuri_build::ImportSolver::installImports(std::shared_ptr<lyric_importer::Shortcu
     // fetch missing dependencies
     TU_RETURN_IF_NOT_OK (m_fetcher->fetchFiles());
 
-    // install fetched dependencies into import package cache
+    // install fetched dependencies into import package cache in a single transaction
+    std::vector<zuri_distributor::RuntimeInstallable> installables;
     for (const auto &selection : dependencyOrder) {
         auto id = selection.specifier.toString();
         if (m_fetcher->hasResult(id)) {
             auto result = m_fetcher->getResult(id);
             TU_RETURN_IF_NOT_OK (result.status);
-            TU_RETURN_IF_STATUS (m_runtime->installPackage(result.path));
+            zuri_distributor::RuntimeInstallable installable;
+            TU_ASSIGN_OR_RETURN (installable.reader, zuri_packager::PackageReader::open(result.path));
+            installable.sha256 = result.digest;
+            installables.push_back(std::move(installable));
         }
     }
+    TU_RETURN_IF_STATUS (m_runtime->installPackages(installables));
 
     return targetBases;
 }
\ No newline at end of file
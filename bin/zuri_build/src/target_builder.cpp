@@ -1,94 +1,293 @@
 
+#include <deque>
+#include <thread>
+
+#include <absl/container/flat_hash_set.h>
+#include <absl/synchronization/mutex.h>
+
 #include <tempo_command/command_help.h>
 #include <tempo_config/config_builder.h>
+#include <tempo_security/sha256_hash.h>
+#include <tempo_utils/memory_mapped_bytes.h>
 #include <zuri_build/build_result.h>
 #include <zuri_build/target_builder.h>
 #include <zuri_build/target_writer.h>
 
+/**
+ * Compute the SHA-256 digest of the package file at the specified path.
+ *
+ * @param packagePath The path to the package file.
+ * @return The hex-encoded digest, or a status if the file could not be read.
+ */
+static tempo_utils::Result<std::string>
+digest_package_file(const std::filesystem::path &packagePath)
+{
+    auto mmapFileResult = tempo_utils::MemoryMappedBytes::open(packagePath);
+    if (mmapFileResult.isStatus())
+        return mmapFileResult.getStatus();
+    auto bytes = mmapFileResult.getResult();
+    std::string_view data((const char *) bytes->getData(), bytes->getSize());
+    return tempo_security::Sha256Hash::hash(data);
+}
+
 zuri_build::TargetBuilder::TargetBuilder(
     std::shared_ptr<zuri_distributor::Runtime> runtime,
     std::shared_ptr<zuri_tooling::BuildGraph> buildGraph,
     lyric_build::LyricBuilder *builder,
     absl::flat_hash_map<std::string,tempo_utils::Url> &&targetBases,
-    const std::filesystem::path &installRoot)
+    const std::filesystem::path &installRoot,
+    int targetParallelism)
     : m_runtime(std::move(runtime)),
       m_buildGraph(std::move(buildGraph)),
       m_builder(builder),
       m_targetBases(std::move(targetBases)),
-      m_installRoot(installRoot)
+      m_installRoot(installRoot),
+      m_targetParallelism(targetParallelism)
 {
     TU_ASSERT (m_runtime != nullptr);
     TU_ASSERT (m_buildGraph != nullptr);
     TU_ASSERT (m_builder != nullptr);
     TU_ASSERT (!m_installRoot.empty());
+    if (m_targetParallelism <= 0) {
+        m_targetParallelism = 1;
+    }
 }
 
+/**
+ * Build the specified target and all of its dependent targets.
+ *
+ * @param targetName The name of the target to build.
+ * @return The path to the package file for the target.
+ */
 tempo_utils::Result<std::filesystem::path>
 zuri_build::TargetBuilder::buildTarget(const std::string &targetName)
 {
-    auto targetStore = m_buildGraph->getTargetStore();
+    absl::flat_hash_map<std::string,std::filesystem::path> targetPaths;
+    TU_ASSIGN_OR_RETURN (targetPaths, buildTargets(std::span<const std::string>(&targetName, 1)));
+    return targetPaths[targetName];
+}
 
-    // make a fresh copy of target bases
-    auto targetBases = m_targetBases;
+/**
+ * Build the specified targets and the union of their dependent targets in a single pass, so that
+ * a dependent target shared by several requested targets is built and installed exactly once.
+ * Targets are built as soon as all of the targets they depend on have been built and installed,
+ * so independent targets are built concurrently on up to targetParallelism worker threads.
+ * Task computation is serialized on the builder, which runs the tasks of a target on its own
+ * thread pool, so concurrent workers overlap computing one target with writing and installing
+ * the packages of others.
+ *
+ * @param targetNames The names of the targets to build.
+ * @return Map of each requested target name to the path to the package file for the target.
+ */
+tempo_utils::Result<absl::flat_hash_map<std::string,std::filesystem::path>>
+zuri_build::TargetBuilder::buildTargets(std::span<const std::string> targetNames)
+{
+    // determine the schedule in which to build the specified targets and all of their dependent targets
+    zuri_tooling::BuildSchedule schedule;
+    TU_ASSIGN_OR_RETURN (schedule, m_buildGraph->calculateBuildSchedule(targetNames));
 
-    std::filesystem::path currTargetPath;
+    absl::flat_hash_set<std::string> requestedTargets(targetNames.begin(), targetNames.end());
 
-    // determine the order in which to build the specified target and all of its dependent targets
-    std::vector<std::string> targetBuildOrder;
-    TU_ASSIGN_OR_RETURN (targetBuildOrder, m_buildGraph->calculateBuildOrder(targetName));
+    absl::Mutex lock;
+    absl::CondVar cond;
 
-    // process each target in order
-    for (const auto &currTargetName : targetBuildOrder) {
-        const auto &currEntry = targetStore->getTarget(currTargetName);
+    // the following state is guarded by lock. make a fresh copy of target bases, which are added
+    // to as dependent targets are installed.
+    auto targetBases = m_targetBases;
+    std::deque<std::string> readyTargets;
+    int numRunning = 0;
+    tempo_utils::Status firstError;
+    absl::flat_hash_map<std::string,std::filesystem::path> targetPaths;
+
+    auto work = [&]() {
+        lock.Lock();
+        while (firstError.isOk() && !schedule.isComplete()) {
+            for (auto &readyTarget : schedule.takeReadyTargets()) {
+                readyTargets.push_back(std::move(readyTarget));
+            }
+            if (readyTargets.empty()) {
+                // if nothing is ready and nothing is running then the remaining targets form a cycle
+                if (numRunning == 0) {
+                    firstError = BuildStatus::forCondition(BuildCondition::kBuildInvariant,
+                        "failed to schedule {} remaining targets; dependency cycle detected",
+                        schedule.numRemaining());
+                    break;
+                }
+                cond.Wait(&lock);
+                continue;
+            }
 
-        // package targets are processed during initialization so there is nothing to do
-        if (currEntry->type == zuri_tooling::TargetEntryType::Package) {
-            continue;
-        }
+            auto currTargetName = std::move(readyTargets.front());
+            readyTargets.pop_front();
+            auto currTargetBases = targetBases;
+            // a target must be installed if it is a dependency of another target being built
+            bool isDependency = !requestedTargets.contains(currTargetName) || schedule.hasDependents(currTargetName);
+            numRunning++;
+            lock.Unlock();
+
+            // build the target, and if it is a dependency then install it
+            tempo_utils::Status status;
+            Option<tempo_utils::Url> targetBaseOption;
+            auto buildScheduledTargetResult = buildScheduledTarget(currTargetName, currTargetBases);
+            if (buildScheduledTargetResult.isStatus()) {
+                status = buildScheduledTargetResult.getStatus();
+            } else if (isDependency && !buildScheduledTargetResult.getResult().empty()) {
+                auto installTargetResult = installTarget(buildScheduledTargetResult.getResult());
+                if (installTargetResult.isStatus()) {
+                    status = installTargetResult.getStatus();
+                } else {
+                    targetBaseOption = Option(installTargetResult.getResult());
+                }
+            }
 
-        // construct the shortcut resolver for the target
-        auto targetShortcuts = std::make_shared<lyric_importer::ShortcutResolver>();
-        for (const auto &dependsName : currEntry->depends) {
-            auto entry = targetBases.find(dependsName);
-            if (entry == targetBases.cend())
-                return BuildStatus::forCondition(BuildCondition::kBuildInvariant,
-                    "unknown dependent '{}' for target {}", dependsName, currTargetName);
-            TU_RETURN_IF_NOT_OK (targetShortcuts->insertShortcut(entry->first, entry->second));
+            lock.Lock();
+            numRunning--;
+            if (status.notOk()) {
+                if (firstError.isOk()) {
+                    firstError = status;
+                }
+            } else {
+                if (requestedTargets.contains(currTargetName)) {
+                    targetPaths[currTargetName] = buildScheduledTargetResult.getResult();
+                }
+                if (targetBaseOption.hasValue()) {
+                    targetBases[currTargetName] = targetBaseOption.getValue();
+                }
+                schedule.completeTarget(currTargetName);
+            }
+            cond.SignalAll();
         }
-
-        // build the target
-        switch (currEntry->type) {
-            case zuri_tooling::TargetEntryType::Program:
-                TU_ASSIGN_OR_RETURN (currTargetPath, buildProgramTarget(currTargetName, currEntry, targetShortcuts));
-                break;
-            case zuri_tooling::TargetEntryType::Library:
-                TU_ASSIGN_OR_RETURN (currTargetPath, buildLibraryTarget(currTargetName, currEntry, targetShortcuts));
-                break;
-            default:
-                return tempo_config::ConfigStatus::forCondition(tempo_config::ConfigCondition::kConfigInvariant,
-                    "invalid type for build target {}", currTargetName);
+        cond.SignalAll();
+        lock.Unlock();
+    };
+
+    int numWorkers = std::min(m_targetParallelism, schedule.numTargets());
+    if (numWorkers <= 1) {
+        work();
+    } else {
+        std::vector<std::thread> workers;
+        for (int i = 0; i < numWorkers; i++) {
+            workers.emplace_back(work);
         }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+    }
+    TU_RETURN_IF_NOT_OK (firstError);
 
-        // if we are processing a dependent target then install it in the targets cache
-        if (currTargetName != targetName) {
-            std::shared_ptr<zuri_packager::PackageReader> packageReader;
-            TU_ASSIGN_OR_RETURN (packageReader, zuri_packager::PackageReader::open(currTargetPath));
-            zuri_packager::PackageSpecifier specifier;
-            TU_ASSIGN_OR_RETURN (specifier, packageReader->readPackageSpecifier());
-
-            // if target exists in package cache then remove it first
-            // TODO: if package is unchanged then don't reinstall it
-            if (m_runtime->containsPackage(specifier)) {
-                TU_RETURN_IF_NOT_OK (m_runtime->removePackage(specifier));
-            }
-            TU_RETURN_IF_STATUS (m_runtime->installPackage(packageReader));
+    return targetPaths;
+}
 
-            // add package base for target
-            targetBases[currTargetName] = specifier.toUrl();
-        }
+/**
+ * Build the specified target. All targets which the specified target depends on must have been
+ * built and installed already.
+ *
+ * @param targetName The name of the target to build.
+ * @param targetBases The package bases of the installed targets.
+ * @return The path to the package file for the target, or an empty path if there is nothing to build.
+ */
+tempo_utils::Result<std::filesystem::path>
+zuri_build::TargetBuilder::buildScheduledTarget(
+    const std::string &targetName,
+    const absl::flat_hash_map<std::string,tempo_utils::Url> &targetBases)
+{
+    auto targetStore = m_buildGraph->getTargetStore();
+    const auto &targetEntry = targetStore->getTarget(targetName);
+
+    // package targets are processed during initialization so there is nothing to do
+    if (targetEntry->type == zuri_tooling::TargetEntryType::Package)
+        return std::filesystem::path{};
+
+    // construct the shortcut resolver for the target
+    auto targetShortcuts = std::make_shared<lyric_importer::ShortcutResolver>();
+    for (const auto &dependsName : targetEntry->depends) {
+        auto entry = targetBases.find(dependsName);
+        if (entry == targetBases.cend())
+            return BuildStatus::forCondition(BuildCondition::kBuildInvariant,
+                "unknown dependent '{}' for target {}", dependsName, targetName);
+        TU_RETURN_IF_NOT_OK (targetShortcuts->insertShortcut(entry->first, entry->second));
     }
 
-    return currTargetPath;
+    // build the target
+    switch (targetEntry->type) {
+        case zuri_tooling::TargetEntryType::Program:
+            return buildProgramTarget(targetName, targetEntry, targetShortcuts);
+        case zuri_tooling::TargetEntryType::Library:
+            return buildLibraryTarget(targetName, targetEntry, targetShortcuts);
+        default:
+            return tempo_config::ConfigStatus::forCondition(tempo_config::ConfigCondition::kConfigInvariant,
+                "invalid type for build target {}", targetName);
+    }
+}
+
+/**
+ * Install the package for a dependent target into the runtime.
+ *
+ * @param targetPath The path to the package file for the target.
+ * @return The package base for the target.
+ */
+tempo_utils::Result<tempo_utils::Url>
+zuri_build::TargetBuilder::installTarget(const std::filesystem::path &targetPath)
+{
+    std::shared_ptr<zuri_packager::PackageReader> packageReader;
+    TU_ASSIGN_OR_RETURN (packageReader, zuri_packager::PackageReader::open(targetPath));
+    zuri_packager::PackageSpecifier specifier;
+    TU_ASSIGN_OR_RETURN (specifier, packageReader->getPackageSpecifier());
+
+    // if target exists in package cache then replace it, so that concurrent readers observe
+    // either the previous or the new package. the package digest is recorded on install, so
+    // if the package is unchanged since it was last installed then it is not reinstalled.
+    std::string digest;
+    TU_ASSIGN_OR_RETURN (digest, digest_package_file(targetPath));
+    zuri_distributor::RuntimeInstallOptions installOptions;
+    installOptions.replaceExisting = true;
+    installOptions.skipUnchanged = true;
+    TU_RETURN_IF_STATUS (m_runtime->installPackage(packageReader, digest, installOptions));
+
+    // add package base for target
+    return specifier.toUrl();
+}
+
+/**
+ * Compute the specified build target. The builder is shared by all workers and is not safe to
+ * use concurrently, so computation is serialized.
+ *
+ * @param target The build task to compute.
+ * @param overrides The settings and shortcut overrides for the computation.
+ * @return The target computation set.
+ */
+tempo_utils::Result<lyric_build::TargetComputationSet>
+zuri_build::TargetBuilder::computeTarget(
+    const lyric_build::TaskId &target,
+    const lyric_build::ComputeTargetOverrides &overrides)
+{
+    absl::MutexLock locker(&m_builderLock);
+    return m_builder->computeTarget(target, overrides);
+}
+
+/**
+ * Load the modules collected by the specified collect_modules task from the build cache.
+ *
+ * @param collectModulesState The state of the completed collect_modules task.
+ * @return The collected modules.
+ */
+tempo_utils::Result<std::vector<zuri_build::TargetBuilder::TargetModule>>
+zuri_build::TargetBuilder::loadTargetModules(const lyric_build::TaskState &collectModulesState)
+{
+    auto cache = m_builder->getCache();
+    std::vector<lyric_build::ArtifactId> targetArtifacts;
+    TU_ASSIGN_OR_RETURN (targetArtifacts, cache->findArtifacts(
+        collectModulesState.getGeneration(), collectModulesState.getHash(), {}, {}));
+
+    std::vector<TargetModule> targetModules;
+    for (const auto &artifactId : targetArtifacts) {
+        TargetModule targetModule;
+        targetModule.modulePath = artifactId.getLocation().toPath();
+        TU_ASSIGN_OR_RETURN (targetModule.metadata, cache->loadMetadataFollowingLinks(artifactId));
+        TU_ASSIGN_OR_RETURN (targetModule.content, cache->loadContentFollowingLinks(artifactId));
+        targetModules.push_back(std::move(targetModule));
+    }
+    return targetModules;
 }
 
 tempo_utils::Result<std::filesystem::path>
@@ -125,7 +324,7 @@ zuri_build::TargetBuilder::buildProgramTarget(
 
     // run the build
     lyric_build::TargetComputationSet targetComputationSet;
-    TU_ASSIGN_OR_RETURN (targetComputationSet, m_builder->computeTarget(collectModules, overrides));
+    TU_ASSIGN_OR_RETURN (targetComputationSet, computeTarget(collectModules, overrides));
 
     auto targetComputation = targetComputationSet.getTarget(collectModules);
     if (targetComputation.getState().getStatus() != lyric_build::TaskState::Status::COMPLETED) {
@@ -135,28 +334,36 @@ zuri_build::TargetBuilder::buildProgramTarget(
             "failed to build target '{}'", targetName);
     }
 
+    auto collectModulesComputation = targetComputationSet.getTarget(collectModules);
+    auto collectModulesState = collectModulesComputation.getState();
+
     // construct the target writer
     TargetWriter targetWriter(m_runtime, m_installRoot, program.specifier);
-    TU_RETURN_IF_NOT_OK (targetWriter.configure());
 
     // set the main location
     targetWriter.setProgramMain(program.main);
 
-    auto cache = m_builder->getCache();
-    std::vector<lyric_build::ArtifactId> targetArtifacts;
+    // load the collected modules and add the requirements they import, which are included in the
+    // inputs digest
+    std::vector<TargetModule> targetModules;
+    TU_ASSIGN_OR_RETURN (targetModules, loadTargetModules(collectModulesState));
+    for (const auto &targetModule : targetModules) {
+        TU_RETURN_IF_NOT_OK (targetWriter.addModuleRequirements(targetModule.metadata, targetModule.content));
+    }
 
-    // write collected modules
-    auto collectModulesComputation = targetComputationSet.getTarget(collectModules);
-    auto collectModulesState = collectModulesComputation.getState();
+    // if the package was already written from the same collected modules then reuse it
+    auto inputsDigest = tempo_security::Sha256Hash::hash(collectModulesState.getHash());
+    Option<std::filesystem::path> unchangedTargetOption;
+    TU_ASSIGN_OR_RETURN (unchangedTargetOption, targetWriter.findUnchangedTarget(inputsDigest));
+    if (unchangedTargetOption.hasValue())
+        return unchangedTargetOption.getValue();
 
-    TU_ASSIGN_OR_RETURN (targetArtifacts, cache->findArtifacts(
-        collectModulesState.getGeneration(), collectModulesState.getHash(), {}, {}));
-    for (const auto &artifactId : targetArtifacts) {
-        lyric_build::LyricMetadata metadata;
-        TU_ASSIGN_OR_RETURN (metadata, cache->loadMetadataFollowingLinks(artifactId));
-        std::shared_ptr<const tempo_utils::ImmutableBytes> content;
-        TU_ASSIGN_OR_RETURN (content, cache->loadContentFollowingLinks(artifactId));
-        targetWriter.writeModule(artifactId.getLocation().toPath(), metadata, content);
+    TU_RETURN_IF_NOT_OK (targetWriter.configure());
+
+    // write collected modules
+    for (const auto &targetModule : targetModules) {
+        TU_RETURN_IF_NOT_OK (targetWriter.writeModule(
+            targetModule.modulePath, targetModule.metadata, targetModule.content));
     }
 
     return targetWriter.writeTarget();
@@ -195,7 +402,7 @@ zuri_build::TargetBuilder::buildLibraryTarget(
 
     // run the build
     lyric_build::TargetComputationSet targetComputationSet;
-    TU_ASSIGN_OR_RETURN (targetComputationSet, m_builder->computeTarget(collectModules, overrides));
+    TU_ASSIGN_OR_RETURN (targetComputationSet, computeTarget(collectModules, overrides));
 
     auto targetComputation = targetComputationSet.getTarget(collectModules);
     if (targetComputation.getState().getStatus() != lyric_build::TaskState::Status::COMPLETED) {
@@ -205,25 +412,33 @@ zuri_build::TargetBuilder::buildLibraryTarget(
             "failed to build target '{}'", targetName);
     }
 
+    auto collectModulesComputation = targetComputationSet.getTarget(collectModules);
+    auto collectModulesState = collectModulesComputation.getState();
+
     // construct the target writer
     TargetWriter targetWriter(m_runtime, m_installRoot, library.specifier);
-    TU_RETURN_IF_NOT_OK (targetWriter.configure());
 
-    auto cache = m_builder->getCache();
-    std::vector<lyric_build::ArtifactId> targetArtifacts;
+    // load the collected modules and add the requirements they import, which are included in the
+    // inputs digest
+    std::vector<TargetModule> targetModules;
+    TU_ASSIGN_OR_RETURN (targetModules, loadTargetModules(collectModulesState));
+    for (const auto &targetModule : targetModules) {
+        TU_RETURN_IF_NOT_OK (targetWriter.addModuleRequirements(targetModule.metadata, targetModule.content));
+    }
 
-    // write collected modules
-    auto collectModulesComputation = targetComputationSet.getTarget(collectModules);
-    auto collectModulesState = collectModulesComputation.getState();
+    // if the package was already written from the same collected modules then reuse it
+    auto inputsDigest = tempo_security::Sha256Hash::hash(collectModulesState.getHash());
+    Option<std::filesystem::path> unchangedTargetOption;
+    TU_ASSIGN_OR_RETURN (unchangedTargetOption, targetWriter.findUnchangedTarget(inputsDigest));
+    if (unchangedTargetOption.hasValue())
+        return unchangedTargetOption.getValue();
 
-    TU_ASSIGN_OR_RETURN (targetArtifacts, cache->findArtifacts(
-        collectModulesState.getGeneration(), collectModulesState.getHash(), {}, {}));
-    for (const auto &artifactId : targetArtifacts) {
-        lyric_build::LyricMetadata metadata;
-        TU_ASSIGN_OR_RETURN (metadata, cache->loadMetadataFollowingLinks(artifactId));
-        std::shared_ptr<const tempo_utils::ImmutableBytes> content;
-        TU_ASSIGN_OR_RETURN (content, cache->loadContentFollowingLinks(artifactId));
-        TU_RETURN_IF_NOT_OK (targetWriter.writeModule(artifactId.getLocation().toPath(), metadata, content));
+    TU_RETURN_IF_NOT_OK (targetWriter.configure());
+
+    // write collected modules
+    for (const auto &targetModule : targetModules) {
+        TU_RETURN_IF_NOT_OK (targetWriter.writeModule(
+            targetModule.modulePath, targetModule.metadata, targetModule.content));
     }
 
     return targetWriter.writeTarget();
@@ -1,18 +1,26 @@
 
+#include <algorithm>
 #include <filesystem>
 
 #include <LIEF/MachO.hpp>
 #include <LIEF/ELF.hpp>
 
+#include <absl/strings/str_cat.h>
+
 #include <lyric_build/build_attrs.h>
 #include <lyric_build/build_result.h>
 #include <lyric_common/common_types.h>
 #include <lyric_object/lyric_object.h>
 #include <tempo_config/config_builder.h>
+#include <tempo_config/config_utils.h>
 #include <tempo_config/parse_config.h>
+#include <tempo_security/sha256_hash.h>
+#include <tempo_utils/file_reader.h>
+#include <tempo_utils/file_writer.h>
 #include <tempo_utils/log_message.h>
 #include <tempo_utils/memory_bytes.h>
 #include <zuri_build/target_writer.h>
+#include <zuri_packager/object_cache.h>
 #include <zuri_packager/packaging_conversions.h>
 
 zuri_build::TargetWriter::TargetWriter(
@@ -29,6 +37,19 @@ zuri_build::TargetWriter::TargetWriter(
     TU_ASSERT (m_specifier.isValid());
 }
 
+/**
+ * Returns the options used to write target packages to the specified install root.
+ */
+static zuri_packager::PackageWriterOptions
+make_package_writer_options(const std::filesystem::path &installRoot)
+{
+    zuri_packager::PackageWriterOptions options;
+    options.installRoot = installRoot;
+    options.overwriteFile = true;
+    options.spoolContents = true;
+    return options;
+}
+
 tempo_utils::Status
 zuri_build::TargetWriter::configure()
 {
@@ -39,9 +60,7 @@ zuri_build::TargetWriter::configure()
         return lyric_build::BuildStatus::forCondition(lyric_build::BuildCondition::kBuildInvariant,
             "target writer is already configured");
 
-    zuri_packager::PackageWriterOptions options;
-    options.installRoot = m_installRoot;
-    options.overwriteFile = true;
+    auto options = make_package_writer_options(m_installRoot);
     auto packageWriter = std::make_unique<zuri_packager::PackageWriter>(m_specifier, options);
     TU_RETURN_IF_NOT_OK (packageWriter->configure());
     m_priv->packageWriter = std::move(packageWriter);
@@ -49,6 +68,148 @@ zuri_build::TargetWriter::configure()
     return {};
 }
 
+/**
+ * Returns the path of the file which records the inputs of the specified target package.
+ */
+static std::filesystem::path
+target_inputs_path(const std::filesystem::path &packagePath)
+{
+    auto inputsPath = packagePath;
+    inputsPath += zuri_build::kTargetInputsDotSuffix;
+    return inputsPath;
+}
+
+/**
+ * Returns the identity of the specified package file formatted as a string.
+ */
+static tempo_utils::Result<std::string>
+format_package_identity(const std::filesystem::path &packagePath)
+{
+    zuri_packager::ObjectFileIdentity identity;
+    TU_ASSIGN_OR_RETURN (identity, zuri_packager::get_object_file_identity(packagePath));
+    return absl::StrCat(identity.device, ":", identity.inode, ":", identity.mtimeNanos, ":", identity.size);
+}
+
+/**
+ * Combine the specified digest of the build inputs with the writer inputs which also determine
+ * the package contents: the writer options, the package metadata and requirements, the libraries
+ * available from the system and distribution, and the package configs of the requirements which
+ * determine the libraries needed.
+ *
+ * @param inputsDigest Digest of the build inputs.
+ * @return The digest of all inputs.
+ */
+tempo_utils::Result<std::string>
+zuri_build::TargetWriter::digestInputs(std::string_view inputsDigest)
+{
+    auto options = make_package_writer_options(m_installRoot);
+    auto inputs = absl::StrCat(
+        inputsDigest, "\n",
+        m_specifier.toString(), "\n",
+        options.installRoot.string(), "\n",
+        options.overwriteFile, ":", options.spoolContents, "\n",
+        m_priv->programMain.toString(), "\n",
+        m_priv->description, "\n",
+        m_priv->owner, "\n",
+        m_priv->homepage, "\n",
+        m_priv->license, "\n");
+
+    for (const auto &libraryName : m_systemLibNames) {
+        absl::StrAppend(&inputs, "system:", libraryName, "\n");
+    }
+
+    // the libraries available from the distribution are determined by the contents of the lib directories
+    for (const auto &distributionLibDirectory : m_distributionLibDirectories) {
+        std::vector<std::string> libraryEntries;
+        std::filesystem::directory_iterator it(distributionLibDirectory);
+        for (const auto &entry : it) {
+            if (!entry.is_regular_file())
+                continue;
+            auto libraryName = entry.path().filename().string();
+            if (!libraryName.starts_with("lib"))
+                continue;
+            std::string libraryIdentity;
+            TU_ASSIGN_OR_RETURN (libraryIdentity, format_package_identity(entry.path()));
+            libraryEntries.push_back(absl::StrCat(libraryName, ":", libraryIdentity));
+        }
+        std::sort(libraryEntries.begin(), libraryEntries.end());
+        absl::StrAppend(&inputs, "distribution:", distributionLibDirectory.string(), "\n");
+        for (const auto &libraryEntry : libraryEntries) {
+            absl::StrAppend(&inputs, libraryEntry, "\n");
+        }
+    }
+
+    // the libraries provided by each requirement are determined by the installed package config
+    std::vector<zuri_packager::PackageSpecifier> requirements;
+    for (const auto &entry : m_priv->requirements) {
+        requirements.emplace_back(entry.first, entry.second);
+    }
+    std::sort(requirements.begin(), requirements.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.toString() < rhs.toString();
+    });
+    for (const auto &specifier : requirements) {
+        Option<tempo_config::ConfigMap> packageConfigOption;
+        TU_ASSIGN_OR_RETURN (packageConfigOption, m_runtime->describePackage(specifier));
+        std::string packageConfig;
+        if (packageConfigOption.hasValue()) {
+            TU_RETURN_IF_NOT_OK (tempo_config::write_config_string(packageConfigOption.getValue(), packageConfig));
+        }
+        absl::StrAppend(&inputs, "requirement:", specifier.toString(), "\n", packageConfig, "\n");
+    }
+
+    return tempo_security::Sha256Hash::hash(inputs);
+}
+
+/**
+ * Check whether the package for the target was previously written from the specified inputs and
+ * has not been modified since. The specified digest is combined with the writer inputs, so the
+ * package metadata and requirements must be set before calling this method. The combined digest
+ * is remembered, and is recorded alongside the package when the target is written.
+ *
+ * @param inputsDigest Digest of the build inputs which determine the package contents.
+ * @return The path to the existing package if it is unchanged, otherwise an empty Option.
+ */
+tempo_utils::Result<Option<std::filesystem::path>>
+zuri_build::TargetWriter::findUnchangedTarget(std::string_view inputsDigest)
+{
+    if (m_priv == nullptr)
+        return lyric_build::BuildStatus::forCondition(lyric_build::BuildCondition::kBuildInvariant,
+            "target writer is finished");
+    TU_ASSIGN_OR_RETURN (m_inputsDigest, digestInputs(inputsDigest));
+
+    auto packagePath = m_specifier.toPackagePath(m_installRoot);
+    auto inputsPath = target_inputs_path(packagePath);
+    if (!std::filesystem::is_regular_file(packagePath) || !std::filesystem::is_regular_file(inputsPath))
+        return Option<std::filesystem::path>();
+
+    tempo_utils::FileReader inputsReader(inputsPath);
+    if (!inputsReader.isValid())
+        return Option<std::filesystem::path>();
+    auto inputsBytes = inputsReader.getBytes();
+    std::string_view inputsData((const char *) inputsBytes->getData(), inputsBytes->getSize());
+
+    // if the recorded inputs cannot be parsed then the package is simply rewritten
+    auto readInputsResult = tempo_config::read_config_string(inputsData);
+    if (readInputsResult.isStatus())
+        return Option<std::filesystem::path>();
+    auto inputsMap = readInputsResult.getResult().toMap();
+
+    tempo_config::StringParser stringParser(std::string{});
+    std::string recordedDigest;
+    std::string recordedIdentity;
+    if (tempo_config::parse_config(recordedDigest, stringParser, inputsMap, "inputsDigest").notOk()
+        || tempo_config::parse_config(recordedIdentity, stringParser, inputsMap, "packageIdentity").notOk())
+        return Option<std::filesystem::path>();
+
+    std::string packageIdentity;
+    TU_ASSIGN_OR_RETURN (packageIdentity, format_package_identity(packagePath));
+    if (recordedDigest != m_inputsDigest || recordedIdentity != packageIdentity)
+        return Option<std::filesystem::path>();
+
+    TU_LOG_V << "package " << packagePath << " is unchanged";
+    return Option(packagePath);
+}
+
 void
 zuri_build::TargetWriter::setDescription(std::string_view description)
 {
@@ -174,6 +335,52 @@ zuri_build::TargetWriter::rewritePlugin(const tempo_utils::UrlPath &path, std::s
         "unsupported DSO file type '{}'", pluginName.string());
 }
 
+/**
+ * Add a requirement for each package imported by the specified module. Modules which are not
+ * objects have no imports and are ignored. Requirements must be added before calling
+ * findUnchangedTarget, as they are included in the inputs digest.
+ *
+ * @param metadata The module metadata.
+ * @param content The module content.
+ * @return Status
+ */
+tempo_utils::Status
+zuri_build::TargetWriter::addModuleRequirements(
+    const lyric_build::LyricMetadata &metadata,
+    std::shared_ptr<const tempo_utils::ImmutableBytes> content)
+{
+    if (m_priv == nullptr)
+        return lyric_build::BuildStatus::forCondition(lyric_build::BuildCondition::kBuildInvariant,
+            "target writer is finished");
+
+    std::string contentType;
+    TU_RETURN_IF_NOT_OK (metadata.parseAttr(lyric_build::kLyricBuildContentType, contentType));
+    if (contentType != lyric_common::kObjectContentType)
+        return {};
+
+    lyric_object::LyricObject object(content);
+    for (int i = 0; i < object.numImports(); i++) {
+        auto import = object.getImport(i);
+        auto location = import.getImportLocation();
+
+        // ignore relative imports
+        if (location.isRelative())
+            continue;
+
+        if (import.isSystemBootstrap()) {
+            // TODO: process bootstrap imports
+        } else if (location.getScheme() == "dev.zuri.pkg") {
+            auto specifier = zuri_packager::PackageSpecifier::fromAuthority(location.getAuthority());
+            TU_RETURN_IF_NOT_OK (addRequirement(specifier));
+        } else {
+            return lyric_build::BuildStatus::forCondition(lyric_build::BuildCondition::kBuildInvariant,
+                "unhandled module scheme '{}' for import {}", location.getScheme(), location.toString());
+        }
+    }
+
+    return {};
+}
+
 using perms = std::filesystem::perms;
 
 tempo_utils::Status
@@ -196,25 +403,7 @@ zuri_build::TargetWriter::writeModule(
     TU_RETURN_IF_NOT_OK (metadata.parseAttr(lyric_build::kLyricBuildContentType, contentType));
 
     if (contentType == lyric_common::kObjectContentType) {
-        lyric_object::LyricObject object(content);
-        for (int i = 0; i < object.numImports(); i++) {
-            auto import = object.getImport(i);
-            auto location = import.getImportLocation();
-
-            // ignore relative imports
-            if (location.isRelative())
-                continue;
-
-            if (import.isSystemBootstrap()) {
-                // TODO: process bootstrap imports
-            } else if (location.getScheme() == "dev.zuri.pkg") {
-                auto specifier = zuri_packager::PackageSpecifier::fromAuthority(location.getAuthority());
-                TU_RETURN_IF_NOT_OK (addRequirement(specifier));
-            } else {
-                return lyric_build::BuildStatus::forCondition(lyric_build::BuildCondition::kBuildInvariant,
-                    "unhandled module scheme '{}' for import {}", location.getScheme(), location.toString());
-            }
-        }
+        TU_RETURN_IF_NOT_OK (addModuleRequirements(metadata, content));
     } else if (contentType == lyric_common::kPluginContentType) {
         std::pair<std::shared_ptr<const tempo_utils::ImmutableBytes>,PluginInfo> p;
         TU_ASSIGN_OR_RETURN (p, rewritePlugin(fullModulePath, content->getSpan()));
@@ -371,6 +560,30 @@ zuri_build::TargetWriter::writePackageConfig()
     return {};
 }
 
+/**
+ * Record the inputs digest and the identity of the written package alongside the package.
+ *
+ * @param packagePath The path to the written package.
+ * @return Status
+ */
+tempo_utils::Status
+zuri_build::TargetWriter::writeTargetInputs(const std::filesystem::path &packagePath)
+{
+    std::string packageIdentity;
+    TU_ASSIGN_OR_RETURN (packageIdentity, format_package_identity(packagePath));
+
+    auto inputsMap = tempo_config::startMap()
+        .put("inputsDigest", tempo_config::valueNode(m_inputsDigest))
+        .put("packageIdentity", tempo_config::valueNode(packageIdentity))
+        .buildMap();
+    std::string inputsData;
+    TU_RETURN_IF_NOT_OK (tempo_config::write_config_string(inputsMap, inputsData));
+
+    tempo_utils::FileWriter inputsWriter(target_inputs_path(packagePath),
+        tempo_utils::MemoryBytes::copy(inputsData), tempo_utils::FileWriterMode::CREATE_OR_OVERWRITE);
+    return inputsWriter.getStatus();
+}
+
 tempo_utils::Result<std::filesystem::path>
 zuri_build::TargetWriter::writeTarget()
 {
@@ -385,11 +598,19 @@ zuri_build::TargetWriter::writeTarget()
 
     TU_RETURN_IF_NOT_OK (writePackageConfig());
 
+    // remove the recorded inputs first, so a failed write can never be mistaken for an unchanged package
+    std::error_code ec;
+    std::filesystem::remove(target_inputs_path(m_specifier.toPackagePath(m_installRoot)), ec);
+
     std::filesystem::path packagePath;
     TU_ASSIGN_OR_RETURN (packagePath, m_priv->packageWriter->writePackage());
 
     TU_LOG_V << "writing package to " << packagePath;
 
+    if (!m_inputsDigest.empty()) {
+        TU_RETURN_IF_NOT_OK (writeTargetInputs(packagePath));
+    }
+
     m_priv.reset();
 
     return packagePath;
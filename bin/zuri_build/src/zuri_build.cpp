@@ -33,6 +33,7 @@ zuri_build::zuri_build(int argc, const char *argv[])
     tempo_config::IntegerParser verboseParser(0);
     tempo_config::IntegerParser quietParser(0);
     tempo_config::BooleanParser silentParser(false);
+    tempo_config::IntegerParser targetParallelismParser(1);
 
     // std::vector<tempo_command::Default> defaults = {
     //     {"projectRoot", "Specify an alternative project root directory", "DIR"},
@@ -96,6 +97,8 @@ zuri_build::zuri_build(int argc, const char *argv[])
         "Specify an alternative install root directory", "DIR");
     command.addOption("jobParallelism", {"-J", "--job-parallelism"}, tempo_command::MappingType::ZERO_OR_ONE_INSTANCE,
         "Number of build worker threads", "COUNT");
+    command.addOption("targetParallelism", {"-T", "--target-parallelism"}, tempo_command::MappingType::ZERO_OR_ONE_INSTANCE,
+        "Number of targets to build concurrently", "COUNT");
     command.addFlag("colorizeOutput", {"-c", "--colorize"}, tempo_command::MappingType::TRUE_IF_INSTANCE,
         "Display colorized output");
     command.addFlag("verbose", {"-v"}, tempo_command::MappingType::COUNT_INSTANCES,
@@ -258,6 +261,14 @@ zuri_build::zuri_build(int argc, const char *argv[])
     tempo_config::IntegerParser jobParallelismParser(buildToolConfig->getJobParallelism());
     TU_RETURN_IF_NOT_OK (command.convert(builderOptions.numThreads, jobParallelismParser, "jobParallelism"));
 
+    // determine the target parallelism. this is separate from the job parallelism, as the builder
+    // runs the tasks for each target on its own pool of numThreads worker threads.
+    int targetParallelism;
+    TU_RETURN_IF_NOT_OK (command.convert(targetParallelism, targetParallelismParser, "targetParallelism"));
+    if (targetParallelism <= 0)
+        return tempo_command::CommandStatus::forCondition(tempo_command::CommandCondition::kCommandError,
+            "target parallelism must be greater than zero");
+
     // create the shortcut resolver
     auto importShortcuts = std::make_shared<lyric_importer::ShortcutResolver>();
     builderOptions.shortcutResolver = importShortcuts;
@@ -294,11 +305,10 @@ zuri_build::zuri_build(int argc, const char *argv[])
     lyric_build::LyricBuilder builder(projectRoot, taskSettings, builderOptions);
     TU_RETURN_IF_NOT_OK (builder.configure());
 
-    // build each target (and its dependencies) in the order specified on the command line
-    TargetBuilder targetBuilder(runtime, buildGraph, &builder, std::move(targetBases), installRoot);
-    for (const auto &target : targets) {
-        TU_RETURN_IF_STATUS (targetBuilder.buildTarget(target));
-    }
+    // build the targets and the union of their dependencies in a single pass
+    TargetBuilder targetBuilder(runtime, buildGraph, &builder, std::move(targetBases), installRoot,
+        targetParallelism);
+    TU_RETURN_IF_STATUS (targetBuilder.buildTargets(targets));
 
     return {};
 }
@@ -69,4 +69,10 @@ TEST_F(TargetBuilderTests, BuildLibrary)
 
     auto buildTargetResult = targetBuilder.buildTarget("lib1");
     ASSERT_THAT (buildTargetResult, tempo_test::IsResult());
+
+    // rebuilding the unchanged target reuses the existing package
+    auto packagePath = buildTargetResult.getResult();
+    auto lastWriteTime = std::filesystem::last_write_time(packagePath);
+    ASSERT_THAT (targetBuilder.buildTarget("lib1"), tempo_test::ContainsResult(packagePath));
+    ASSERT_EQ (lastWriteTime, std::filesystem::last_write_time(packagePath));
 }
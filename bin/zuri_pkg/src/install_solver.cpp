@@ -21,6 +21,7 @@ zuri_pkg::InstallSolver::configure()
             "install solver is already configured");
 
     zuri_distributor::HttpPackageResolverOptions resolverOptions;
+    resolverOptions.metadataCache = m_runtime->getPackageDatabase();
     std::shared_ptr<zuri_distributor::AbstractPackageResolver> resolver;
     TU_ASSIGN_OR_RETURN (resolver, zuri_distributor::HttpPackageResolver::create(resolverOptions));
 
@@ -96,7 +97,8 @@ zuri_pkg::InstallSolver::installPackages()
     int numPackagesToInstall = 0;
     for (const auto &selection : dependencyOrder) {
         if (!m_runtime->containsPackage(selection.specifier)) {
-            TU_RETURN_IF_NOT_OK (m_fetcher->requestFile(selection.url, selection.specifier.toString()));
+            TU_RETURN_IF_NOT_OK (m_fetcher->requestFile(
+                selection.url, selection.specifier.toString(), selection.sha256));
             numPackagesToInstall++;
         } else {
             TU_CONSOLE_OUT << "ignoring " << selection.specifier.toString() << ": already installed";
@@ -114,20 +116,29 @@ zuri_pkg::InstallSolver::installPackages()
     TU_RETURN_IF_NOT_OK (m_fetcher->fetchFiles());
 
     // install fetched dependencies into install cache
+    std::vector<zuri_distributor::RuntimeInstallable> installables;
     for (const auto &selection : dependencyOrder) {
         auto id = selection.specifier.toString();
         if (m_fetcher->hasResult(id)) {
             auto result = m_fetcher->getResult(id);
             TU_RETURN_IF_NOT_OK (result.status);
             if (!m_dryRun) {
-                std::filesystem::path installPath;
-                TU_ASSIGN_OR_RETURN (installPath, m_runtime->installPackage(result.path));
-                TU_LOG_V << "installed " << selection.specifier.toString() << " in " << installPath;
+                zuri_distributor::RuntimeInstallable installable;
+                TU_ASSIGN_OR_RETURN (installable.reader, zuri_packager::PackageReader::open(result.path));
+                installable.sha256 = result.digest;
+                installables.push_back(std::move(installable));
             } else {
                 TU_CONSOLE_OUT << "DRY RUN: install package " << result.path;
             }
         }
     }
 
+    // install all fetched packages in a single transaction
+    std::vector<std::filesystem::path> installPaths;
+    TU_ASSIGN_OR_RETURN (installPaths, m_runtime->installPackages(installables));
+    for (const auto &installPath : installPaths) {
+        TU_LOG_V << "installed " << installPath;
+    }
+
     return {};
 }
\ No newline at end of file
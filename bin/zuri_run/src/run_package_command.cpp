@@ -23,9 +23,9 @@ zuri_run::run_package_command(
 
     // determine the entry point
     zuri_packager::PackageSpecifier mainSpecifier;
-    TU_ASSIGN_OR_RETURN (mainSpecifier, reader->readPackageSpecifier());
+    TU_ASSIGN_OR_RETURN (mainSpecifier, reader->getPackageSpecifier());
     lyric_common::ModuleLocation programMain;
-    TU_ASSIGN_OR_RETURN (programMain, reader->readProgramMain());
+    TU_ASSIGN_OR_RETURN (programMain, reader->getProgramMain());
     auto mainLocation = lyric_common::ModuleLocation::fromUrl(
         mainSpecifier.toUrl()
             .resolve(programMain.getPath()));
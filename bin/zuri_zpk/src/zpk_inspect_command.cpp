@@ -84,13 +84,13 @@ zuri_zpk::zpk_inspect_command(
     // the package metadata
 
     zuri_packager::PackageSpecifier packageSpecifier;
-    TU_ASSIGN_OR_RETURN (packageSpecifier, reader->readPackageSpecifier());
+    TU_ASSIGN_OR_RETURN (packageSpecifier, reader->getPackageSpecifier());
 
     lyric_common::ModuleLocation programMain;
-    TU_ASSIGN_OR_RETURN (programMain, reader->readProgramMain());
+    TU_ASSIGN_OR_RETURN (programMain, reader->getProgramMain());
 
     zuri_packager::RequirementsMap requirementsMap;
-    TU_ASSIGN_OR_RETURN (requirementsMap, reader->readRequirementsMap());
+    TU_ASSIGN_OR_RETURN (requirementsMap, reader->getRequirementsMap());
     std::vector<std::pair<zuri_packager::PackageId,zuri_packager::PackageVersion>> requirements;
     for (auto it = requirementsMap.requirementsBegin(); it != requirementsMap.requirementsEnd(); it++) {
         requirements.emplace_back(it->first, it->second);
@@ -116,7 +116,7 @@ zuri_zpk::zpk_inspect_command(
     // the package.config
 
     tempo_config::ConfigMap packageConfig;
-    TU_ASSIGN_OR_RETURN (packageConfig, reader->readPackageConfig());
+    TU_ASSIGN_OR_RETURN (packageConfig, reader->getPackageConfig());
 
     TU_CONSOLE_OUT << "package.config:";
     std::string configJson;
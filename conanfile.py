@@ -63,6 +63,7 @@ class Zuri(ConanFile):
         'rocksdb/10.4.2@timbre',
         'sqlite/3.49.2@timbre',
         'uv/1.51.0@timbre',
+        'zstd/1.5.7@timbre',
         )
 
     def export_sources(self):
@@ -139,6 +140,7 @@ class Zuri(ConanFile):
         cmake = CMake(self)
         cmake.configure()
         cmake.build()
+        cmake.test()
 
     def package(self):
         cmake = CMake(self)
@@ -32,6 +32,21 @@ namespace zuri_distributor {
          */
         virtual tempo_utils::Result<Option<std::filesystem::path>> resolvePackage(
             const zuri_packager::PackageSpecifier &specifier) const = 0;
+
+        /**
+         * Returns a counter which changes whenever a package is installed into or removed from
+         * the cache. Callers may memoize resolution results until the generation changes.
+         *
+         * @return
+         */
+        virtual tu_uint64 getGeneration() const = 0;
+
+        /**
+         * Discard any state memoized by the cache which may be stale because packages were
+         * installed or removed outside of the cache, for example by another process. If the
+         * cache observes such a change then its generation changes.
+         */
+        virtual void invalidate() {};
     };
 }
 
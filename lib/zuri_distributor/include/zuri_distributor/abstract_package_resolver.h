@@ -28,6 +28,7 @@ namespace zuri_distributor {
         zuri_packager::PackageVersion version;
         absl::flat_hash_set<zuri_packager::PackageSpecifier> dependencies;
         tempo_utils::Url url;
+        std::string sha256;
         tu_int64 uploadDateEpochMillis = 0;
         bool pruned = false;
     };
@@ -62,6 +63,17 @@ namespace zuri_distributor {
         virtual tempo_utils::Result<PackageDescriptor> getPackage(
             const zuri_packager::PackageId &packageId,
             const zuri_packager::PackageVersion &packageVersion) = 0;
+
+        /**
+         * Get the packages for each of the specified package specifiers. Resolvers which can have
+         * multiple lookups in flight should override this method; the default implementation calls
+         * getPackage for each specifier in sequence.
+         *
+         * @param packageSpecifiers
+         * @return
+         */
+        virtual tempo_utils::Result<absl::flat_hash_map<zuri_packager::PackageSpecifier,PackageDescriptor>>
+        getPackages(const std::vector<zuri_packager::PackageSpecifier> &packageSpecifiers);
     };
 }
 
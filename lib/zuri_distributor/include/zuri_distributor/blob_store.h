@@ -0,0 +1,47 @@
+#ifndef ZURI_DISTRIBUTOR_BLOB_STORE_H
+#define ZURI_DISTRIBUTOR_BLOB_STORE_H
+
+#include <filesystem>
+#include <span>
+
+#include <tempo_utils/result.h>
+#include <zuri_packager/package_extractor.h>
+
+namespace zuri_distributor {
+
+    /**
+     * Content-addressed store of file contents, keyed by the hex-encoded SHA-256 digest of the
+     * contents. Each blob is stored at `<blobsDirectory>/<first two digest chars>/<digest>`.
+     * Files are materialized from the store by hardlinking the blob into place, falling back to a
+     * reflink (FICLONE) and finally to a plain copy if the filesystem supports neither.
+     */
+    class BlobStore : public zuri_packager::AbstractFileMaterializer {
+    public:
+        static tempo_utils::Result<std::shared_ptr<BlobStore>> openOrCreate(
+            const std::filesystem::path &blobsDirectory);
+
+        std::filesystem::path getBlobsDirectory() const;
+        std::filesystem::path getBlobPath(std::string_view digest) const;
+
+        bool containsBlob(std::string_view digest) const;
+        tempo_utils::Result<std::string> putBlob(const tempo_utils::Slice &contents);
+        tempo_utils::Status linkBlob(std::string_view digest, const std::filesystem::path &filePath) const;
+        tempo_utils::Result<std::string> storeFile(
+            const tempo_utils::Slice &contents,
+            const std::filesystem::path &filePath);
+
+        tempo_utils::Status materializeFile(
+            const tempo_utils::Slice &contents,
+            const std::filesystem::path &filePath) override;
+
+        tempo_utils::Result<int> pruneBlobs(std::span<const std::string> digests);
+        tempo_utils::Result<int> pruneUnreferencedBlobs();
+
+    private:
+        std::filesystem::path m_blobsDirectory;
+
+        explicit BlobStore(const std::filesystem::path &blobsDirectory);
+    };
+}
+
+#endif // ZURI_DISTRIBUTOR_BLOB_STORE_H
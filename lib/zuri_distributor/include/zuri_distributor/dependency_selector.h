@@ -12,6 +12,7 @@ namespace zuri_distributor {
         std::string id;
         zuri_packager::PackageSpecifier specifier;
         tempo_utils::Url url;
+        std::string sha256;
         std::string shortcut;
     };
 
@@ -33,9 +34,7 @@ namespace zuri_distributor {
     private:
         std::shared_ptr<AbstractPackageResolver> m_resolver;
         DependencySet m_dependencies;
-        absl::flat_hash_map<
-            zuri_packager::PackageSpecifier,
-            std::pair<std::string,tempo_utils::Url>> m_packageSelections;
+        absl::flat_hash_map<zuri_packager::PackageSpecifier,Selection> m_packageSelections;
 
         struct PendingSelection {
             enum class Type {
@@ -54,14 +53,21 @@ namespace zuri_distributor {
         };
         std::queue<PendingSelection> m_pending;
 
+        struct PendingExpansion {
+            std::string id;
+            zuri_packager::PackageSpecifier specifier;
+        };
+
         tempo_utils::Status dependOnLatestVersion(
             const std::string &id,
             const zuri_packager::PackageId &packageId,
-            const std::string &shortcut);
+            const std::string &shortcut,
+            std::vector<PendingExpansion> &expansions);
         tempo_utils::Status dependOnSpecifiedVersion(
             const std::string &id,
             const zuri_packager::PackageSpecifier &packageSpecifier,
-            const std::string &shortcut);
+            const std::string &shortcut,
+            std::vector<PendingExpansion> &expansions);
         tempo_utils::Status dependOnSpecifiedPath(
             const std::string &id,
             const std::filesystem::path &packagePath,
@@ -69,7 +75,9 @@ namespace zuri_distributor {
         tempo_utils::Status dependTransitively(
             const std::string &id,
             const zuri_packager::PackageSpecifier &target,
-            const zuri_packager::PackageSpecifier &dependency);
+            const zuri_packager::PackageSpecifier &dependency,
+            std::vector<PendingExpansion> &expansions);
+        tempo_utils::Status expandDependencies(const std::vector<PendingExpansion> &expansions);
     };
 }
 
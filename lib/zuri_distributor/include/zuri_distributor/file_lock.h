@@ -0,0 +1,41 @@
+#ifndef ZURI_DISTRIBUTOR_FILE_LOCK_H
+#define ZURI_DISTRIBUTOR_FILE_LOCK_H
+
+#include <filesystem>
+
+#include <tempo_utils/result.h>
+
+namespace zuri_distributor {
+
+    enum class FileLockMode {
+        Shared,
+        Exclusive,
+    };
+
+    /**
+     * Advisory lock on a lock file, held until the FileLock is destroyed. Locks are taken with
+     * flock(2), so they are shared between processes and also between threads in the same process
+     * which acquire the lock separately. The lock file is created if it does not exist and is never
+     * removed.
+     */
+    class FileLock {
+    public:
+        ~FileLock();
+
+        static tempo_utils::Result<std::shared_ptr<FileLock>> acquire(
+            const std::filesystem::path &lockPath,
+            FileLockMode mode);
+
+        std::filesystem::path getLockPath() const;
+        FileLockMode getMode() const;
+
+    private:
+        std::filesystem::path m_lockPath;
+        FileLockMode m_mode;
+        int m_fd;
+
+        FileLock(const std::filesystem::path &lockPath, FileLockMode mode, int fd);
+    };
+}
+
+#endif // ZURI_DISTRIBUTOR_FILE_LOCK_H
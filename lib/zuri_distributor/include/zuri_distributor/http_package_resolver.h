@@ -1,10 +1,54 @@
 #ifndef ZURI_DISTRIBUTOR_HTTP_PACKAGE_RESOLVER_H
 #define ZURI_DISTRIBUTOR_HTTP_PACKAGE_RESOLVER_H
+
+#include <absl/time/time.h>
+
 #include "abstract_package_resolver.h"
+#include "package_database.h"
 
 namespace zuri_distributor {
 
     struct HttpPackageResolverOptions {
+        /**
+         * the maximum number of connections used when fetching multiple package descriptors
+         * concurrently. if zero, then the number of connections is unlimited.
+         */
+        int maxConcurrentRequests = 16;
+        /**
+         * the maximum time in milliseconds to wait for a connection to be established. if zero,
+         * then the curl default is used.
+         */
+        long connectTimeoutMillis = 30000;
+        /**
+         * the maximum time in milliseconds for a single request to complete. if zero, then requests
+         * never time out.
+         */
+        long requestTimeoutMillis = 0;
+        /**
+         * the maximum number of redirects followed for a single request. if zero, then redirects are
+         * not followed.
+         */
+        long maxRedirects = 5;
+        /**
+         * if not empty, then the User-Agent header sent with each request.
+         */
+        std::string userAgent = {};
+        /**
+         * if specified, then repository metadata is cached persistently in the database. fresh
+         * responses are served from the cache without a request, and stale responses are revalidated
+         * using conditional requests.
+         */
+        std::shared_ptr<PackageDatabase> metadataCache = {};
+        /**
+         * cached responses which were stored longer ago than the max age are evicted when the
+         * resolver is created.
+         */
+        absl::Duration metadataCacheMaxAge = absl::Hours(24 * 30);
+        /**
+         * when the resolver is created the least recently stored responses are evicted until the
+         * total size of the cached response bodies is at most this many bytes.
+         */
+        tu_int64 metadataCacheMaxBytes = 64 * 1024 * 1024;
     };
 
     class HttpPackageResolver : public AbstractPackageResolver {
@@ -21,6 +65,9 @@ namespace zuri_distributor {
             const zuri_packager::PackageId &packageId,
             const zuri_packager::PackageVersion &packageVersion) override;
 
+        tempo_utils::Result<absl::flat_hash_map<zuri_packager::PackageSpecifier,PackageDescriptor>>
+        getPackages(const std::vector<zuri_packager::PackageSpecifier> &packageSpecifiers) override;
+
     private:
         struct Priv;
         std::unique_ptr<Priv> m_priv;
@@ -31,6 +78,9 @@ namespace zuri_distributor {
         tempo_utils::Result<tempo_utils::Url> resolveLocation(
             std::string_view domain,
             const tempo_utils::UrlPath &path);
+        tempo_utils::Result<tempo_utils::Url> resolvePackageLocation(
+            const zuri_packager::PackageId &packageId,
+            const zuri_packager::PackageVersion &packageVersion);
 
         enum class ErrorMode {
             Default,
@@ -3,7 +3,12 @@
 
 #include <filesystem>
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
 #include <lyric_runtime/abstract_loader.h>
+#include <zuri_packager/object_cache.h>
+#include <zuri_packager/plugin_cache.h>
 
 #include "abstract_package_cache.h"
 
@@ -11,10 +16,15 @@ namespace zuri_distributor {
 
     class PackageCacheLoader : public lyric_runtime::AbstractLoader {
     public:
-        explicit PackageCacheLoader(std::shared_ptr<AbstractPackageCache> readonlyPackageCache);
+        explicit PackageCacheLoader(
+            std::shared_ptr<AbstractPackageCache> readonlyPackageCache,
+            std::shared_ptr<zuri_packager::ObjectCache> objectCache = {},
+            std::shared_ptr<zuri_packager::PluginCache> pluginCache = {});
 
         std::shared_ptr<AbstractPackageCache> getPackageCache() const;
 
+        void invalidate();
+
         tempo_utils::Result<bool> hasModule(
             const lyric_common::ModuleLocation &location) const override;
         tempo_utils::Result<Option<lyric_object::LyricObject>> loadModule(
@@ -25,10 +35,22 @@ namespace zuri_distributor {
 
     private:
         std::shared_ptr<AbstractPackageCache> m_readonlyPackageCache;
+        std::shared_ptr<zuri_packager::ObjectCache> m_objectCache;
+        std::shared_ptr<zuri_packager::PluginCache> m_pluginCache;
+
+        // memoized module lookups, keyed by module location and dot suffix. a module which was not
+        // found is memoized as an empty path. the index is dropped when the package cache generation
+        // changes or when invalidate() is called.
+        mutable absl::Mutex m_lock;
+        mutable tu_uint64 m_indexGeneration ABSL_GUARDED_BY(m_lock);
+        mutable absl::flat_hash_map<std::string,std::filesystem::path> m_moduleIndex ABSL_GUARDED_BY(m_lock);
 
         tempo_utils::Result<std::filesystem::path> findModule(
             const lyric_common::ModuleLocation &location,
             std::string_view dotSuffix) const;
+        tempo_utils::Result<std::filesystem::path> searchModule(
+            const lyric_common::ModuleLocation &location,
+            std::string_view dotSuffix) const;
     };
 }
 
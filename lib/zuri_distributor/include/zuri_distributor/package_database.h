@@ -5,10 +5,39 @@
 
 #include <sqlite3.h>
 
+#include <absl/synchronization/mutex.h>
+
+#include <tempo_utils/integer_types.h>
 #include <tempo_utils/result.h>
+#include <zuri_packager/package_specifier.h>
 
 namespace zuri_distributor {
 
+    /**
+     * schema version from which every installed package is recorded in the package database with
+     * its path and config.
+     */
+    constexpr int kIndexedPackagesSchemaVersion = 1;
+
+    /**
+     * A cached HTTP response body along with the validators needed to revalidate it.
+     */
+    struct HttpCacheEntry {
+        std::string etag;
+        std::string lastModified;
+        tu_int64 expiresEpochMillis = 0;
+        std::string body;
+    };
+
+    /**
+     * An installed package as recorded in the package database.
+     */
+    struct InstalledPackage {
+        std::filesystem::path path;
+        std::string config;
+        std::string sha256;
+    };
+
     class PackageDatabase {
     public:
         ~PackageDatabase();
@@ -20,12 +49,59 @@ namespace zuri_distributor {
 
         std::filesystem::path getDatabaseFilePath() const;
 
+        tempo_utils::Status beginTransaction();
+        tempo_utils::Status commitTransaction();
+        tempo_utils::Status rollbackTransaction();
+
+        tu_int64 getDataVersion();
+        int getSchemaVersion();
+        tempo_utils::Status setSchemaVersion(int schemaVersion);
+
+        tempo_utils::Status putPackage(
+            const zuri_packager::PackageSpecifier &specifier,
+            std::string_view sha256,
+            const std::filesystem::path &packagePath = {},
+            std::string_view packageConfig = {});
+        tempo_utils::Result<Option<InstalledPackage>> getInstalledPackage(
+            const zuri_packager::PackageSpecifier &specifier);
+        tempo_utils::Result<Option<std::string>> getPackageDigest(
+            const zuri_packager::PackageSpecifier &specifier);
+        tempo_utils::Status putPackageFile(
+            const zuri_packager::PackageSpecifier &specifier,
+            std::string_view path,
+            std::string_view sha256);
+        tempo_utils::Result<std::vector<std::string>> getPackageFileDigests(
+            const zuri_packager::PackageSpecifier &specifier);
+        tempo_utils::Status removePackage(const zuri_packager::PackageSpecifier &specifier);
+
+        tempo_utils::Result<Option<HttpCacheEntry>> getHttpCacheEntry(std::string_view url);
+        tempo_utils::Status putHttpCacheEntry(std::string_view url, const HttpCacheEntry &entry);
+        tempo_utils::Status pruneHttpCache(tu_int64 storedBeforeEpochMillis, tu_int64 maxTotalBytes);
+
     private:
         std::filesystem::path m_databaseFilePath;
         sqlite3 *m_db;
 
+        // serializes use of the connection and its prepared statements, and counts modifications made
+        // through this connection which are not reflected in the sqlite data_version
+        absl::Mutex m_lock;
+        tu_int64 m_numLocalChanges;
+
         sqlite3_stmt *m_listSpecifiers = nullptr;
         sqlite3_stmt *m_insertSpecifier = nullptr;
+        sqlite3_stmt *m_upsertPackage = nullptr;
+        sqlite3_stmt *m_selectPackageDigest = nullptr;
+        sqlite3_stmt *m_selectInstalledPackage = nullptr;
+        sqlite3_stmt *m_selectDataVersion = nullptr;
+        sqlite3_stmt *m_selectSchemaVersion = nullptr;
+        sqlite3_stmt *m_deletePackage = nullptr;
+        sqlite3_stmt *m_upsertFile = nullptr;
+        sqlite3_stmt *m_selectPackageFileDigests = nullptr;
+        sqlite3_stmt *m_deletePackageFiles = nullptr;
+        sqlite3_stmt *m_selectHttpCacheEntry = nullptr;
+        sqlite3_stmt *m_upsertHttpCacheEntry = nullptr;
+        sqlite3_stmt *m_deleteStaleHttpCacheEntries = nullptr;
+        sqlite3_stmt *m_deleteExcessHttpCacheEntries = nullptr;
 
         static tempo_utils::Result<std::shared_ptr<PackageDatabase>> open(
             const std::filesystem::path &databaseFilePath,
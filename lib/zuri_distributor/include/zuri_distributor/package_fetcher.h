@@ -19,12 +19,46 @@ namespace zuri_distributor {
          *
          */
         int pollTimeoutInMs = 100;
+        /**
+         * the maximum number of transfers which are in progress at the same time. additional requests
+         * are queued until a transfer completes. if zero, then the number of transfers is unlimited.
+         */
+        int maxConcurrentTransfers = 16;
+        /**
+         * the maximum number of connections opened to a single host. if zero, then the number of
+         * connections per host is unlimited.
+         */
+        int maxConnectionsPerHost = 4;
+        /**
+         * the number of times a transfer which failed due to a transient error (a network error or
+         * a 408, 429 or 5xx response) is retried before the fetch fails.
+         */
+        int maxRetries = 3;
+        /**
+         * the delay before the first retry of a failed transfer. the delay doubles after each
+         * subsequent failure, up to maxRetryBackoffInMs.
+         */
+        int retryBackoffInMs = 250;
+        /**
+         * the upper bound on the delay between retries.
+         */
+        int maxRetryBackoffInMs = 8000;
+        /**
+         * if true, then a retried transfer requests only the bytes which were not already fetched
+         * using an HTTP Range request. if the server ignores the range then the file is fetched again
+         * from the beginning.
+         */
+        bool resumePartialTransfers = true;
     };
 
     struct FetchResult {
         tempo_utils::Url url;
         std::string id;
         std::filesystem::path path;
+        /**
+         * hex-encoded SHA-256 digest of the fetched file, computed as the file is downloaded.
+         */
+        std::string digest;
         tempo_utils::Status status;
     };
 
@@ -35,7 +69,10 @@ namespace zuri_distributor {
 
         tempo_utils::Status configure();
 
-        tempo_utils::Status requestFile(const tempo_utils::Url &url, std::string_view id);
+        tempo_utils::Status requestFile(
+            const tempo_utils::Url &url,
+            std::string_view id,
+            std::string_view expectedDigest = {});
         tempo_utils::Result<std::string> requestFile(const tempo_utils::Url &url);
         tempo_utils::Status fetchFiles();
 
@@ -1,36 +1,120 @@
 #ifndef ZURI_DISTRIBUTOR_PACKAGE_STORE_H
 #define ZURI_DISTRIBUTOR_PACKAGE_STORE_H
 
+#include <atomic>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
 #include <tempo_utils/result.h>
 #include <zuri_packager/package_reader.h>
 
 #include "abstract_package_cache.h"
+#include "blob_store.h"
+#include "package_database.h"
 
 namespace zuri_distributor {
 
+    /**
+     * name of the content-addressed blob directory within the packages directory. installed package
+     * files are hardlinked (or reflinked) from blobs in this directory.
+     */
+    constexpr const char * const kBlobsDirectoryName = ".blobs";
+
+    /**
+     * A file written while staging a package, along with the digest of its contents.
+     */
+    struct StagedFile {
+        std::string path;
+        std::string sha256;
+    };
+
+    /**
+     * A package which has been extracted into a staging directory but is not yet visible in the
+     * package store.
+     */
+    struct StagedPackage {
+        zuri_packager::PackageSpecifier specifier;
+        std::filesystem::path stagedPath;
+        std::string config;
+        std::vector<StagedFile> files;
+    };
+
+    /**
+     * A staged package which has been moved into the packages directory. If the package replaced
+     * an existing installation then the previous contents are kept at the retired path until the
+     * publish is finished or reverted. The retired digests are the blobs referenced by the previous
+     * contents, which are pruned from the blob store when the publish is finished.
+     */
+    struct PublishedPackage {
+        zuri_packager::PackageSpecifier specifier;
+        std::filesystem::path packagePath;
+        std::filesystem::path retiredPath;
+        std::vector<std::string> retiredDigests;
+    };
+
     class PackageStore : public AbstractPackageCache {
     public:
         static tempo_utils::Result<std::shared_ptr<PackageStore>> openOrCreate(
-            const std::filesystem::path &packagesDirectory);
+            const std::filesystem::path &packagesDirectory,
+            std::shared_ptr<PackageDatabase> packageIndex = {});
         static tempo_utils::Result<std::shared_ptr<PackageStore>> open(
-            const std::filesystem::path &packagesDirectory);
+            const std::filesystem::path &packagesDirectory,
+            std::shared_ptr<PackageDatabase> packageIndex = {});
 
         std::filesystem::path getPackagesDirectory() const;
+        std::shared_ptr<BlobStore> getBlobStore() const;
+        std::shared_ptr<PackageDatabase> getPackageIndex() const;
 
         bool containsPackage(const zuri_packager::PackageSpecifier &specifier) const override;
         tempo_utils::Result<Option<tempo_config::ConfigMap>> describePackage(
             const zuri_packager::PackageSpecifier &specifier) const override;
         tempo_utils::Result<Option<std::filesystem::path>> resolvePackage(
             const zuri_packager::PackageSpecifier &specifier) const override;
+        tu_uint64 getGeneration() const override;
+        void invalidate() override;
 
+        tempo_utils::Status indexPackages();
         tempo_utils::Result<std::filesystem::path> installPackage(std::shared_ptr<zuri_packager::PackageReader> reader);
+        tempo_utils::Result<StagedPackage> stagePackage(
+            std::shared_ptr<zuri_packager::PackageReader> reader,
+            const std::filesystem::path &stagingDirectory,
+            int numWorkers = 1);
+        tempo_utils::Result<PublishedPackage> publishPackage(
+            const StagedPackage &stagedPackage,
+            bool replaceExisting = false);
+        tempo_utils::Status finishPublish(const PublishedPackage &publishedPackage);
+        tempo_utils::Status revertPublish(const PublishedPackage &publishedPackage);
         tempo_utils::Status removePackage(const zuri_packager::PackageSpecifier &specifier);
 
-
     private:
         std::filesystem::path m_packagesDirectory;
+        std::shared_ptr<BlobStore> m_blobStore;
+        std::shared_ptr<PackageDatabase> m_packageIndex;
+        std::atomic<tu_uint64> m_generation;
+
+        struct IndexedPackage {
+            std::filesystem::path path;
+            tempo_config::ConfigMap config;
+        };
+
+        // packages looked up in the package index, keyed by specifier. a package which is not
+        // installed is cached as an empty option. the cache is dropped whenever the generation
+        // changes, which happens on every local change and when invalidate() observes a change to
+        // the index made by another connection.
+        mutable absl::Mutex m_lock;
+        tu_int64 m_indexVersion ABSL_GUARDED_BY(m_lock);
+        mutable tu_uint64 m_indexedGeneration ABSL_GUARDED_BY(m_lock);
+        mutable absl::flat_hash_map<zuri_packager::PackageSpecifier,Option<IndexedPackage>> m_indexedPackages
+            ABSL_GUARDED_BY(m_lock);
+
+        PackageStore(
+            const std::filesystem::path &packagesDirectory,
+            std::shared_ptr<BlobStore> blobStore,
+            std::shared_ptr<PackageDatabase> packageIndex);
 
-        explicit PackageStore(const std::filesystem::path &packagesDirectory);
+        tempo_utils::Result<Option<IndexedPackage>> lookupPackage(
+            const zuri_packager::PackageSpecifier &specifier) const;
     };
 }
 
@@ -2,9 +2,14 @@
 #define ZURI_DISTRIBUTOR_RUNTIME_H
 
 #include <filesystem>
+#include <span>
+
+#include <absl/container/flat_hash_set.h>
+#include <absl/synchronization/mutex.h>
 
 #include <lyric_runtime/abstract_loader.h>
 
+#include "file_lock.h"
 #include "package_database.h"
 #include "package_store.h"
 #include "package_cache_loader.h"
@@ -17,6 +22,17 @@ namespace zuri_distributor {
      */
     constexpr const char * const kPackagesDatabaseName = "packages.db";
 
+    /**
+     * name of the lock file in the runtime root. installs and removes hold a shared lock, and
+     * operations which must exclude every install hold an exclusive lock.
+     */
+    constexpr const char * const kRuntimeLockName = "packages.lock";
+
+    /**
+     * name of the directory within the packages directory containing the per-package lock files.
+     */
+    constexpr const char * const kPackageLocksDirectoryName = ".locks";
+
     struct RuntimeOpenOrCreateOptions {
         bool exclusive = false;
         std::filesystem::path distributionLibDir = {};
@@ -24,6 +40,27 @@ namespace zuri_distributor {
         std::filesystem::path buildRoot = {};
     };
 
+    /**
+     * A package to install, along with the digest of the package file it was read from if known.
+     */
+    struct RuntimeInstallable {
+        std::shared_ptr<zuri_packager::PackageReader> reader;
+        std::string sha256;
+    };
+
+    struct RuntimeInstallOptions {
+        /**
+         * if true, then a package which is already installed is replaced. readers observe either the
+         * previous or the new contents of the package, never a partially installed package.
+         */
+        bool replaceExisting = false;
+        /**
+         * if true, then an installable with a digest is skipped if the package is already installed
+         * and the recorded digest of the installed package matches.
+         */
+        bool skipUnchanged = false;
+    };
+
     /**
      *
      */
@@ -37,6 +74,7 @@ namespace zuri_distributor {
         static tempo_utils::Result<std::shared_ptr<Runtime>> open(const std::filesystem::path &runtimeRoot);
 
         std::filesystem::path getPackagesDatabaseFile() const;
+        std::shared_ptr<PackageDatabase> getPackageDatabase() const;
         std::filesystem::path getBinDirectory() const;
         std::filesystem::path getLibDirectory() const;
         std::filesystem::path getPackagesDirectory() const;
@@ -52,9 +90,20 @@ namespace zuri_distributor {
         tempo_utils::Result<Option<std::filesystem::path>> resolvePackage(
             const zuri_packager::PackageSpecifier &specifier) const;
 
-        tempo_utils::Result<std::filesystem::path> installPackage(const std::filesystem::path &packagePath);
-        tempo_utils::Result<std::filesystem::path> installPackage(std::shared_ptr<zuri_packager::PackageReader> reader);
+        tempo_utils::Result<std::filesystem::path> installPackage(
+            const std::filesystem::path &packagePath,
+            std::string_view sha256 = {});
+        tempo_utils::Result<std::filesystem::path> installPackage(
+            std::shared_ptr<zuri_packager::PackageReader> reader,
+            std::string_view sha256 = {},
+            const RuntimeInstallOptions &options = {});
+        tempo_utils::Result<std::vector<std::filesystem::path>> installPackages(
+            std::span<const std::shared_ptr<zuri_packager::PackageReader>> readers);
+        tempo_utils::Result<std::vector<std::filesystem::path>> installPackages(
+            std::span<const RuntimeInstallable> installables,
+            const RuntimeInstallOptions &options = {});
         tempo_utils::Status removePackage(const zuri_packager::PackageSpecifier &specifier);
+        tempo_utils::Result<int> pruneUnreferencedBlobs();
 
     private:
         std::shared_ptr<PackageDatabase> m_packageDatabase;
@@ -64,6 +113,10 @@ namespace zuri_distributor {
 
         std::shared_ptr<PackageCacheLoader> m_loader;
 
+        // threads in the process share a single database connection, so transactions which modify
+        // the installed packages must not interleave
+        absl::Mutex m_transactionLock;
+
         Runtime(
             std::shared_ptr<PackageDatabase> packageDatabase,
             const std::filesystem::path &binDirectory,
@@ -71,6 +124,12 @@ namespace zuri_distributor {
             std::shared_ptr<PackageStore> packageStore);
 
         tempo_utils::Status configure();
+        tempo_utils::Result<std::vector<std::filesystem::path>> installStagedPackages(
+            std::span<const RuntimeInstallable> installables,
+            const std::filesystem::path &stagingDirectory,
+            const RuntimeInstallOptions &options);
+        tempo_utils::Result<std::vector<std::shared_ptr<FileLock>>> lockPackages(
+            const absl::flat_hash_set<zuri_packager::PackageSpecifier> &specifiers) const;
     };
 
 }
@@ -1,6 +1,9 @@
 #ifndef ZURI_DISTRIBUTOR_TIERED_PACKAGE_CACHE_H
 #define ZURI_DISTRIBUTOR_TIERED_PACKAGE_CACHE_H
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
 #include <tempo_utils/result.h>
 #include <zuri_packager/package_reader.h>
 
@@ -11,7 +14,8 @@ namespace zuri_distributor {
     /**
      * TieredPackageCache is an implementation of AbstractPackageCache which acts as
      * a facade for a list of package caches. When resolving a package the TieredPackageCache
-     * consults each package cache in order, returning the first package found.
+     * consults each package cache in order, returning the first package found. Resolved
+     * packages are memoized until the generation of any underlying package cache changes.
      */
     class TieredPackageCache : public AbstractPackageCache {
     public:
@@ -29,8 +33,17 @@ namespace zuri_distributor {
         tempo_utils::Result<Option<std::filesystem::path>> resolvePackage(
             const zuri_packager::PackageSpecifier &specifier) const override;
 
+        tu_uint64 getGeneration() const override;
+        void invalidate() override;
+
     private:
         std::vector<std::shared_ptr<AbstractPackageCache>> m_packageCaches;
+
+        mutable absl::Mutex m_lock;
+        mutable tu_uint64 m_resolvedGeneration ABSL_GUARDED_BY(m_lock);
+        mutable absl::flat_hash_map<
+            zuri_packager::PackageSpecifier,
+            Option<std::filesystem::path>> m_resolved ABSL_GUARDED_BY(m_lock);
     };
 }
 
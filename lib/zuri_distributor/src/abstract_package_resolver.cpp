@@ -0,0 +1,16 @@
+
+#include <zuri_distributor/abstract_package_resolver.h>
+
+tempo_utils::Result<absl::flat_hash_map<zuri_packager::PackageSpecifier,zuri_distributor::PackageDescriptor>>
+zuri_distributor::AbstractPackageResolver::getPackages(
+    const std::vector<zuri_packager::PackageSpecifier> &packageSpecifiers)
+{
+    absl::flat_hash_map<zuri_packager::PackageSpecifier,PackageDescriptor> packageDescriptors;
+    for (const auto &specifier : packageSpecifiers) {
+        PackageDescriptor packageDescriptor;
+        TU_ASSIGN_OR_RETURN (packageDescriptor, getPackage(
+            specifier.getPackageId(), specifier.getPackageVersion()));
+        packageDescriptors[specifier] = std::move(packageDescriptor);
+    }
+    return packageDescriptors;
+}
@@ -0,0 +1,244 @@
+
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+#include <absl/strings/str_cat.h>
+
+#include <tempo_security/sha256_hash.h>
+#include <tempo_utils/file_utilities.h>
+#include <tempo_utils/file_writer.h>
+#include <zuri_distributor/blob_store.h>
+#include <zuri_distributor/distributor_result.h>
+
+zuri_distributor::BlobStore::BlobStore(const std::filesystem::path &blobsDirectory)
+    : m_blobsDirectory(blobsDirectory)
+{
+    TU_ASSERT (!m_blobsDirectory.empty());
+}
+
+std::filesystem::path
+zuri_distributor::BlobStore::getBlobsDirectory() const
+{
+    return m_blobsDirectory;
+}
+
+std::filesystem::path
+zuri_distributor::BlobStore::getBlobPath(std::string_view digest) const
+{
+    TU_ASSERT (digest.size() > 2);
+    return m_blobsDirectory / digest.substr(0, 2) / digest;
+}
+
+bool
+zuri_distributor::BlobStore::containsBlob(std::string_view digest) const
+{
+    return std::filesystem::is_regular_file(getBlobPath(digest));
+}
+
+tempo_utils::Result<std::string>
+zuri_distributor::BlobStore::putBlob(const tempo_utils::Slice &contents)
+{
+    std::string_view data((const char *) contents.getData(), contents.getSize());
+    auto digest = tempo_security::Sha256Hash::hash(data);
+    auto blobPath = getBlobPath(digest);
+    if (std::filesystem::is_regular_file(blobPath))
+        return digest;
+
+    std::error_code ec;
+    auto shardPath = blobPath.parent_path();
+    std::filesystem::create_directories(shardPath, ec);
+    if (ec)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to create blob directory {}: {}", shardPath.string(), ec.message());
+
+    // write the blob to a temporary file and then rename it into place, so a concurrent writer
+    // of the same contents never observes a partially written blob
+    auto tmpPath = shardPath / tempo_utils::generate_name(absl::StrCat(digest, ".XXXXXXXX"));
+    tempo_utils::FileWriter fileWriter(tmpPath, contents.toImmutableBytes(), tempo_utils::FileWriterMode::CREATE_ONLY);
+    TU_RETURN_IF_NOT_OK (fileWriter.getStatus());
+
+    std::filesystem::rename(tmpPath, blobPath, ec);
+    if (ec) {
+        std::filesystem::remove(tmpPath);
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to store blob {}: {}", blobPath.string(), ec.message());
+    }
+
+    return digest;
+}
+
+#ifdef __linux__
+static bool
+clone_file(const std::filesystem::path &srcPath, const std::filesystem::path &dstPath)
+{
+    int srcFd = open(srcPath.c_str(), O_RDONLY);
+    if (srcFd < 0)
+        return false;
+    int dstFd = open(dstPath.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if (dstFd < 0) {
+        close(srcFd);
+        return false;
+    }
+    auto ret = ioctl(dstFd, FICLONE, srcFd);
+    close(dstFd);
+    close(srcFd);
+    if (ret < 0) {
+        unlink(dstPath.c_str());
+        return false;
+    }
+    return true;
+}
+#endif
+
+tempo_utils::Status
+zuri_distributor::BlobStore::linkBlob(std::string_view digest, const std::filesystem::path &filePath) const
+{
+    auto blobPath = getBlobPath(digest);
+
+    // prefer a hardlink, which shares the blob inode and lets us count references to the blob
+    std::error_code ec;
+    std::filesystem::create_hard_link(blobPath, filePath, ec);
+    if (!ec)
+        return {};
+
+#ifdef __linux__
+    // fall back to a reflink, which shares extents with the blob on copy-on-write filesystems
+    if (clone_file(blobPath, filePath))
+        return {};
+#endif
+
+    // otherwise copy the blob contents
+    ec.clear();
+    std::filesystem::copy_file(blobPath, filePath, ec);
+    if (ec)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to link blob {} to {}: {}", blobPath.string(), filePath.string(), ec.message());
+
+    return {};
+}
+
+/**
+ * Store the contents as a blob and link the blob to the specified file path.
+ *
+ * @param contents The file contents.
+ * @param filePath The path of the file to materialize.
+ * @return The hex-encoded SHA-256 digest of the contents.
+ */
+tempo_utils::Result<std::string>
+zuri_distributor::BlobStore::storeFile(
+    const tempo_utils::Slice &contents,
+    const std::filesystem::path &filePath)
+{
+    std::string digest;
+    TU_ASSIGN_OR_RETURN (digest, putBlob(contents));
+    auto status = linkBlob(digest, filePath);
+    if (status.isOk())
+        return digest;
+
+    // the blob may have been pruned between storing and linking, so store it again and retry once
+    if (containsBlob(digest))
+        return status;
+    TU_ASSIGN_OR_RETURN (digest, putBlob(contents));
+    TU_RETURN_IF_NOT_OK (linkBlob(digest, filePath));
+    return digest;
+}
+
+tempo_utils::Status
+zuri_distributor::BlobStore::materializeFile(
+    const tempo_utils::Slice &contents,
+    const std::filesystem::path &filePath)
+{
+    auto storeFileResult = storeFile(contents, filePath);
+    if (storeFileResult.isStatus())
+        return storeFileResult.getStatus();
+    return {};
+}
+
+/**
+ * Remove each of the specified blobs which is no longer linked from any installed file. Blobs which
+ * are missing from the store are ignored.
+ *
+ * @param digests The digests of the blobs to check.
+ * @return The number of blobs removed.
+ */
+tempo_utils::Result<int>
+zuri_distributor::BlobStore::pruneBlobs(std::span<const std::string> digests)
+{
+    int numPruned = 0;
+
+    for (const auto &digest : digests) {
+        if (digest.size() <= 2)
+            continue;
+        auto blobPath = getBlobPath(digest);
+        std::error_code ec;
+        auto linkCount = std::filesystem::hard_link_count(blobPath, ec);
+        if (ec)
+            continue;
+        // a blob with a single link is not referenced by any installed file
+        if (linkCount > 1)
+            continue;
+        if (std::filesystem::remove(blobPath, ec)) {
+            numPruned++;
+        }
+        if (ec)
+            return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                "failed to prune blob {}: {}", blobPath.string(), ec.message());
+    }
+
+    return numPruned;
+}
+
+/**
+ * Remove every blob in the store which is no longer linked from any installed file. This scans the
+ * entire store, and a blob which has been stored but not yet linked is indistinguishable from an
+ * unreferenced blob, so the caller must ensure that no install is in progress (see
+ * Runtime::pruneUnreferencedBlobs).
+ *
+ * @return The number of blobs removed.
+ */
+tempo_utils::Result<int>
+zuri_distributor::BlobStore::pruneUnreferencedBlobs()
+{
+    int numPruned = 0;
+    std::error_code ec;
+
+    for (const auto &shard : std::filesystem::directory_iterator(m_blobsDirectory, ec)) {
+        if (!shard.is_directory())
+            continue;
+        for (const auto &blob : std::filesystem::directory_iterator(shard.path(), ec)) {
+            if (!blob.is_regular_file())
+                continue;
+            // skip temporary files which are still being written
+            if (blob.path().has_extension())
+                continue;
+            // a blob with a single link is not referenced by any installed file
+            if (blob.hard_link_count() > 1)
+                continue;
+            if (std::filesystem::remove(blob.path(), ec)) {
+                numPruned++;
+            }
+        }
+    }
+
+    if (ec)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to prune blobs in {}: {}", m_blobsDirectory.string(), ec.message());
+
+    return numPruned;
+}
+
+tempo_utils::Result<std::shared_ptr<zuri_distributor::BlobStore>>
+zuri_distributor::BlobStore::openOrCreate(const std::filesystem::path &blobsDirectory)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(blobsDirectory, ec);
+    if (ec)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to create blobs directory {}: {}", blobsDirectory.string(), ec.message());
+
+    return std::shared_ptr<BlobStore>(new BlobStore(blobsDirectory));
+}
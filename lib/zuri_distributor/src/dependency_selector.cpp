@@ -1,4 +1,6 @@
 
+#include <absl/container/flat_hash_set.h>
+
 #include <tempo_utils/uuid.h>
 #include <zuri_distributor/dependency_selector.h>
 #include <zuri_distributor/distributor_result.h>
@@ -59,7 +61,8 @@ tempo_utils::Status
 zuri_distributor::DependencySelector::dependOnLatestVersion(
     const std::string &id,
     const zuri_packager::PackageId &packageId,
-    const std::string &shortcut)
+    const std::string &shortcut,
+    std::vector<PendingExpansion> &expansions)
 {
     CollectionDescriptor collectionDescriptor;
     TU_ASSIGN_OR_RETURN (collectionDescriptor, m_resolver->getCollection(packageId));
@@ -78,30 +81,23 @@ zuri_distributor::DependencySelector::dependOnLatestVersion(
             "no usable version found for '{}'", packageId.toString());
     zuri_packager::PackageSpecifier specifier(packageId, latestVersion);
 
-    return dependOnSpecifiedVersion(id, specifier, shortcut);
+    return dependOnSpecifiedVersion(id, specifier, shortcut, expansions);
 }
 
 tempo_utils::Status
 zuri_distributor::DependencySelector::dependOnSpecifiedVersion(
     const std::string &id,
     const zuri_packager::PackageSpecifier &specifier,
-    const std::string &shortcut)
+    const std::string &shortcut,
+    std::vector<PendingExpansion> &expansions)
 {
-    PackageDescriptor packageDescriptor;
-    TU_ASSIGN_OR_RETURN (packageDescriptor, m_resolver->getPackage(
-        specifier.getPackageId(), specifier.getPackageVersion()));
-
     TU_RETURN_IF_NOT_OK (m_dependencies.addDirectDependency(specifier, shortcut));
 
-    for (const auto &requested : packageDescriptor.dependencies) {
-        PendingSelection pendingSelection;
-        pendingSelection.type = PendingSelection::Type::Transitive;
-        pendingSelection.id = tempo_utils::UUID::randomUUID().toString();
-        pendingSelection.requestedSpecifier = requested;
-        pendingSelection.target = specifier;
-        m_pending.push(std::move(pendingSelection));
-    }
-    m_packageSelections[specifier] = std::pair(id, packageDescriptor.url);
+    // the package descriptor is fetched along with the rest of the frontier
+    PendingExpansion expansion;
+    expansion.id = id;
+    expansion.specifier = specifier;
+    expansions.push_back(std::move(expansion));
 
     return {};
 }
@@ -116,10 +112,10 @@ zuri_distributor::DependencySelector::dependOnSpecifiedPath(
     TU_ASSIGN_OR_RETURN (reader, zuri_packager::PackageReader::open(path));
 
     zuri_packager::PackageSpecifier specifier;
-    TU_ASSIGN_OR_RETURN (specifier, reader->readPackageSpecifier());
+    TU_ASSIGN_OR_RETURN (specifier, reader->getPackageSpecifier());
 
     zuri_packager::RequirementsMap requirements;
-    TU_ASSIGN_OR_RETURN (requirements, reader->readRequirementsMap());
+    TU_ASSIGN_OR_RETURN (requirements, reader->getRequirementsMap());
 
     TU_RETURN_IF_NOT_OK (m_dependencies.addDirectDependency(specifier, shortcut));
 
@@ -132,7 +128,9 @@ zuri_distributor::DependencySelector::dependOnSpecifiedPath(
         pendingSelection.target = specifier;
         m_pending.push(std::move(pendingSelection));
     }
-    m_packageSelections[specifier] = std::pair(id, tempo_utils::Url::fromFilesystemPath(path));
+    auto &selection = m_packageSelections[specifier];
+    selection.id = id;
+    selection.url = tempo_utils::Url::fromFilesystemPath(path);
 
     return {};
 }
@@ -140,27 +138,62 @@ tempo_utils::Status
 zuri_distributor::DependencySelector::dependTransitively(
     const std::string &id,
     const zuri_packager::PackageSpecifier &target,
-    const zuri_packager::PackageSpecifier &dependency)
+    const zuri_packager::PackageSpecifier &dependency,
+    std::vector<PendingExpansion> &expansions)
 {
     bool newSelection;
     TU_ASSIGN_OR_RETURN (newSelection, m_dependencies.addTransitiveDependency(target, dependency));
     if (!newSelection)
         return {};
 
-    PackageDescriptor packageDescriptor;
-    TU_ASSIGN_OR_RETURN (packageDescriptor, m_resolver->getPackage(
-        dependency.getPackageId(), dependency.getPackageVersion()));
+    // the package descriptor is fetched along with the rest of the frontier
+    PendingExpansion expansion;
+    expansion.id = id;
+    expansion.specifier = dependency;
+    expansions.push_back(std::move(expansion));
 
-    for (const auto &requested : packageDescriptor.dependencies) {
-        PendingSelection pendingSelection;
-        pendingSelection.type = PendingSelection::Type::Transitive;
-        pendingSelection.id = tempo_utils::UUID::randomUUID().toString();
-        pendingSelection.requestedSpecifier = requested;
-        pendingSelection.target = dependency;
-        m_pending.push(std::move(pendingSelection));
+    return {};
+}
+
+tempo_utils::Status
+zuri_distributor::DependencySelector::expandDependencies(const std::vector<PendingExpansion> &expansions)
+{
+    if (expansions.empty())
+        return {};
+
+    // fetch the descriptors for every package in the frontier at once
+    std::vector<zuri_packager::PackageSpecifier> specifiers;
+    absl::flat_hash_set<zuri_packager::PackageSpecifier> uniqueSpecifiers;
+    for (const auto &expansion : expansions) {
+        if (uniqueSpecifiers.insert(expansion.specifier).second) {
+            specifiers.push_back(expansion.specifier);
+        }
     }
+    absl::flat_hash_map<zuri_packager::PackageSpecifier,PackageDescriptor> packageDescriptors;
+    TU_ASSIGN_OR_RETURN (packageDescriptors, m_resolver->getPackages(specifiers));
 
-    m_packageSelections[dependency] = std::pair(id, packageDescriptor.url);
+    // enqueue the dependencies of each package, which form the next frontier
+    for (const auto &expansion : expansions) {
+        auto entry = packageDescriptors.find(expansion.specifier);
+        if (entry == packageDescriptors.cend())
+            return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                "missing package descriptor for {}", expansion.specifier.toString());
+        const auto &packageDescriptor = entry->second;
+
+        for (const auto &requested : packageDescriptor.dependencies) {
+            PendingSelection pendingSelection;
+            pendingSelection.type = PendingSelection::Type::Transitive;
+            pendingSelection.id = tempo_utils::UUID::randomUUID().toString();
+            pendingSelection.requestedSpecifier = requested;
+            pendingSelection.target = expansion.specifier;
+            m_pending.push(std::move(pendingSelection));
+        }
+
+        auto &selection = m_packageSelections[expansion.specifier];
+        selection.id = expansion.id;
+        selection.url = packageDescriptor.url;
+        selection.sha256 = packageDescriptor.sha256;
+    }
 
     return {};
 }
@@ -168,27 +201,38 @@ zuri_distributor::DependencySelector::dependTransitively(
 tempo_utils::Status
 zuri_distributor::DependencySelector::selectDependencies()
 {
+    // process the pending selections one level at a time, so the package descriptors for the entire
+    // frontier can be fetched concurrently by the resolver
     while (!m_pending.empty()) {
-        PendingSelection curr = m_pending.front();
-        m_pending.pop();
-
-        switch (curr.type) {
-            case PendingSelection::Type::Id:
-                TU_RETURN_IF_NOT_OK (dependOnLatestVersion(curr.id, curr.requestedId, curr.shortcut));
-                break;
-            case PendingSelection::Type::Specifier:
-                TU_RETURN_IF_NOT_OK (dependOnSpecifiedVersion(curr.id, curr.requestedSpecifier, curr.shortcut));
-                break;
-            case PendingSelection::Type::Path:
-                TU_RETURN_IF_NOT_OK (dependOnSpecifiedPath(curr.id, curr.requestedPath, curr.shortcut));
-                break;
-            case PendingSelection::Type::Transitive:
-                TU_RETURN_IF_NOT_OK (dependTransitively(curr.id, curr.target, curr.requestedSpecifier));
-                break;
-            default:
-                return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
-                    "invalid pending selection");
+        std::vector<PendingExpansion> expansions;
+
+        for (auto numPending = m_pending.size(); numPending > 0; numPending--) {
+            PendingSelection curr = m_pending.front();
+            m_pending.pop();
+
+            switch (curr.type) {
+                case PendingSelection::Type::Id:
+                    TU_RETURN_IF_NOT_OK (dependOnLatestVersion(
+                        curr.id, curr.requestedId, curr.shortcut, expansions));
+                    break;
+                case PendingSelection::Type::Specifier:
+                    TU_RETURN_IF_NOT_OK (dependOnSpecifiedVersion(
+                        curr.id, curr.requestedSpecifier, curr.shortcut, expansions));
+                    break;
+                case PendingSelection::Type::Path:
+                    TU_RETURN_IF_NOT_OK (dependOnSpecifiedPath(curr.id, curr.requestedPath, curr.shortcut));
+                    break;
+                case PendingSelection::Type::Transitive:
+                    TU_RETURN_IF_NOT_OK (dependTransitively(
+                        curr.id, curr.target, curr.requestedSpecifier, expansions));
+                    break;
+                default:
+                    return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                        "invalid pending selection");
+            }
         }
+
+        TU_RETURN_IF_NOT_OK (expandDependencies(expansions));
     }
     return {};
 }
@@ -207,12 +251,8 @@ zuri_distributor::DependencySelector::calculateDependencyOrder()
         if (entry == m_packageSelections.cend())
             return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
                 "missing package url for {}", dependency.specifier.toString());
-        const auto &packageSelection = entry->second;
-
-        Selection selection;
-        selection.id = packageSelection.first;
+        Selection selection = entry->second;
         selection.specifier = dependency.specifier;
-        selection.url = packageSelection.second;
         selection.shortcut = dependency.shortcut;
         dependencyOrder.push_back(std::move(selection));
     }
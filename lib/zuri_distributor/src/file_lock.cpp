@@ -0,0 +1,68 @@
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <tempo_utils/log_stream.h>
+#include <zuri_distributor/distributor_result.h>
+#include <zuri_distributor/file_lock.h>
+
+zuri_distributor::FileLock::FileLock(const std::filesystem::path &lockPath, FileLockMode mode, int fd)
+    : m_lockPath(lockPath),
+      m_mode(mode),
+      m_fd(fd)
+{
+    TU_ASSERT (!m_lockPath.empty());
+    TU_ASSERT (m_fd >= 0);
+}
+
+zuri_distributor::FileLock::~FileLock()
+{
+    // closing the descriptor releases the lock
+    auto ret = ::close(m_fd);
+    TU_LOG_WARN_IF (ret != 0) << "failed to close lock file " << m_lockPath << ": " << std::strerror(errno);
+}
+
+/**
+ * Acquire a lock on the specified lock file, blocking until the lock is available.
+ *
+ * @param lockPath The path to the lock file.
+ * @param mode Whether to acquire a shared or an exclusive lock.
+ * @return The held lock.
+ */
+tempo_utils::Result<std::shared_ptr<zuri_distributor::FileLock>>
+zuri_distributor::FileLock::acquire(const std::filesystem::path &lockPath, FileLockMode mode)
+{
+    auto fd = ::open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to open lock file {}: {}", lockPath.string(), std::strerror(errno));
+
+    int operation = mode == FileLockMode::Exclusive? LOCK_EX : LOCK_SH;
+    int ret;
+    do {
+        ret = ::flock(fd, operation);
+    } while (ret != 0 && errno == EINTR);
+    if (ret != 0) {
+        auto err = errno;
+        ::close(fd);
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to lock {}: {}", lockPath.string(), std::strerror(err));
+    }
+
+    return std::shared_ptr<FileLock>(new FileLock(lockPath, mode, fd));
+}
+
+std::filesystem::path
+zuri_distributor::FileLock::getLockPath() const
+{
+    return m_lockPath;
+}
+
+zuri_distributor::FileLockMode
+zuri_distributor::FileLock::getMode() const
+{
+    return m_mode;
+}
@@ -1,4 +1,10 @@
 
+#include <absl/strings/ascii.h>
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_cat.h>
+#include <absl/strings/str_split.h>
+#include <absl/strings/strip.h>
+#include <absl/time/clock.h>
 #include <curl/curl.h>
 #include <tempo_config/base_conversions.h>
 #include <tempo_config/config_utils.h>
@@ -47,9 +53,52 @@ struct Context {
 };
 
 struct zuri_distributor::HttpPackageResolver::Priv {
+    zuri_distributor::HttpPackageResolverOptions options;
     Context ctx;
+    CURLM *multi = nullptr;
+    std::shared_ptr<zuri_distributor::PackageDatabase> metadataCache;
+
+    ~Priv() {
+        if (multi != nullptr) {
+            auto ret = curl_multi_cleanup(multi);
+            TU_LOG_WARN_IF (ret != CURLM_OK) << "curl_multi_cleanup failed: " << curl_multi_strerror(ret);
+        }
+    }
 };
 
+/**
+ * State for a single request which is performed concurrently with other requests on the multi handle.
+ */
+struct MultiRequest {
+    zuri_packager::PackageSpecifier specifier;
+    tempo_utils::Url url;
+    Option<zuri_distributor::HttpCacheEntry> cached;
+    CURLM *multi = nullptr;
+    CURL *handle = nullptr;
+    curl_slist *headers = nullptr;
+    std::string body;
+
+    ~MultiRequest() {
+        if (headers != nullptr) {
+            curl_slist_free_all(headers);
+        }
+        if (handle != nullptr) {
+            if (multi != nullptr) {
+                curl_multi_remove_handle(multi, handle);
+            }
+            curl_easy_cleanup(handle);
+        }
+    }
+};
+
+static size_t
+multi_write_callback(char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+    auto *request = (MultiRequest *) userdata;
+    request->body.insert(request->body.end(), ptr, ptr + nmemb);
+    return nmemb;
+}
+
 static size_t
 write_callback(char *ptr, size_t size, size_t nmemb, void *userdata)
 {
@@ -58,6 +107,122 @@ write_callback(char *ptr, size_t size, size_t nmemb, void *userdata)
     return nmemb;
 }
 
+/**
+ * Apply the options shared by every request to the easy handle, and direct the response body to
+ * the specified write callback.
+ */
+static void
+configure_handle(
+    CURL *handle,
+    const zuri_distributor::HttpPackageResolverOptions &options,
+    curl_write_callback writeFunction,
+    void *writeData)
+{
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, writeFunction);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, writeData);
+    curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, options.connectTimeoutMillis);
+    curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, options.requestTimeoutMillis);
+    if (options.maxRedirects > 0) {
+        curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(handle, CURLOPT_MAXREDIRS, options.maxRedirects);
+    }
+    if (!options.userAgent.empty()) {
+        curl_easy_setopt(handle, CURLOPT_USERAGENT, options.userAgent.c_str());
+    }
+}
+
+/**
+ * Look up the cached response for the specified url. cache errors are not fatal, they are logged and
+ * treated as a cache miss.
+ */
+static Option<zuri_distributor::HttpCacheEntry>
+lookup_cache_entry(zuri_distributor::PackageDatabase *metadataCache, const tempo_utils::Url &url)
+{
+    if (metadataCache == nullptr)
+        return {};
+    auto getEntryResult = metadataCache->getHttpCacheEntry(url.toString());
+    if (getEntryResult.isStatus()) {
+        TU_LOG_WARN << "failed to read metadata cache: " << getEntryResult.getStatus();
+        return {};
+    }
+    return getEntryResult.getResult();
+}
+
+static bool
+is_fresh(const Option<zuri_distributor::HttpCacheEntry> &cached)
+{
+    if (cached.isEmpty())
+        return false;
+    return absl::ToUnixMillis(absl::Now()) < cached.getValue().expiresEpochMillis;
+}
+
+/**
+ * Build the conditional request headers used to revalidate a stale cached response.
+ */
+static curl_slist *
+make_conditional_headers(const Option<zuri_distributor::HttpCacheEntry> &cached)
+{
+    if (cached.isEmpty())
+        return nullptr;
+    const auto &entry = cached.getValue();
+    curl_slist *headers = nullptr;
+    if (!entry.etag.empty()) {
+        auto header = absl::StrCat("If-None-Match: ", entry.etag);
+        headers = curl_slist_append(headers, header.c_str());
+    }
+    if (!entry.lastModified.empty()) {
+        auto header = absl::StrCat("If-Modified-Since: ", entry.lastModified);
+        headers = curl_slist_append(headers, header.c_str());
+    }
+    return headers;
+}
+
+/**
+ * Store the response body along with its validators and expiry. the expiry is derived from the
+ * max-age directive of the Cache-Control header if present, otherwise from the Expires header.
+ */
+static void
+store_cache_entry(
+    zuri_distributor::PackageDatabase *metadataCache,
+    const tempo_utils::Url &url,
+    CURL *handle,
+    const std::string &body)
+{
+    if (metadataCache == nullptr)
+        return;
+
+    zuri_distributor::HttpCacheEntry entry;
+    entry.body = body;
+
+    curl_header *header;
+    if (CURLHE_OK == curl_easy_header(handle, "ETag", 0, CURLH_HEADER, -1, &header)) {
+        entry.etag = header->value;
+    }
+    if (CURLHE_OK == curl_easy_header(handle, "Last-Modified", 0, CURLH_HEADER, -1, &header)) {
+        entry.lastModified = header->value;
+    }
+
+    auto now = absl::Now();
+    entry.expiresEpochMillis = absl::ToUnixMillis(now);
+    if (CURLHE_OK == curl_easy_header(handle, "Cache-Control", 0, CURLH_HEADER, -1, &header)) {
+        for (auto directive : absl::StrSplit(header->value, ',', absl::SkipWhitespace())) {
+            directive = absl::StripAsciiWhitespace(directive);
+            int maxAge;
+            if (absl::ConsumePrefix(&directive, "max-age=") && absl::SimpleAtoi(directive, &maxAge)) {
+                entry.expiresEpochMillis = absl::ToUnixMillis(now + absl::Seconds(maxAge));
+            }
+        }
+    } else if (CURLHE_OK == curl_easy_header(handle, "Expires", 0, CURLH_HEADER, -1, &header)) {
+        absl::Time expires;
+        if (absl::ParseTime(absl::RFC1123_full, header->value, &expires, nullptr)) {
+            entry.expiresEpochMillis = absl::ToUnixMillis(expires);
+        }
+    }
+
+    auto status = metadataCache->putHttpCacheEntry(url.toString(), entry);
+    TU_LOG_WARN_IF (status.notOk()) << "failed to write metadata cache: " << status;
+}
+
 tempo_utils::Status
 zuri_distributor::HttpPackageResolver::performGet(
     const tempo_utils::Url &url,
@@ -66,14 +231,38 @@ zuri_distributor::HttpPackageResolver::performGet(
     auto &ctx = m_priv->ctx;
     ctx.reset();
 
+    // serve fresh responses directly from the metadata cache
+    auto *metadataCache = m_priv->metadataCache.get();
+    auto cached = lookup_cache_entry(metadataCache, url);
+    if (is_fresh(cached)) {
+        ctx.responseCode = 200;
+        ctx.body = cached.getValue().body;
+        return {};
+    }
+
     curl_easy_setopt(ctx.handle, CURLOPT_URL, url.uriView());
+    auto *headers = make_conditional_headers(cached);
+    curl_easy_setopt(ctx.handle, CURLOPT_HTTPHEADER, headers);
 
     auto ret = curl_easy_perform(ctx.handle);
+    curl_easy_setopt(ctx.handle, CURLOPT_HTTPHEADER, nullptr);
+    curl_slist_free_all(headers);
     if (ret != CURLE_OK)
         return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
             "curl_easy_perform failed: {}", curl_easy_strerror(ret));
 
     curl_easy_getinfo(ctx.handle, CURLINFO_RESPONSE_CODE, &ctx.responseCode);
+
+    // if the cached response is still valid then use the cached body and refresh the expiry
+    if (ctx.responseCode == 304 && !cached.isEmpty()) {
+        ctx.responseCode = 200;
+        ctx.body = cached.getValue().body;
+        store_cache_entry(metadataCache, url, ctx.handle, ctx.body);
+        return {};
+    }
+    if (ctx.responseCode == 200) {
+        store_cache_entry(metadataCache, url, ctx.handle, ctx.body);
+    }
     switch (errorMode) {
         case ErrorMode::Default:
             if (ctx.responseCode >= 400)
@@ -275,30 +464,19 @@ zuri_distributor::HttpPackageResolver::getCollection(
     return collection;
 }
 
-tempo_utils::Result<zuri_distributor::PackageDescriptor>
-zuri_distributor::HttpPackageResolver::getPackage(
+static tempo_utils::Result<zuri_distributor::PackageDescriptor>
+parse_package_descriptor(
+    const std::string &body,
     const zuri_packager::PackageId &packageId,
     const zuri_packager::PackageVersion &packageVersion)
 {
-    const auto &ctx = m_priv->ctx;
-
-    tempo_utils::Url packageUrl;
-    TU_ASSIGN_OR_RETURN (packageUrl, resolveLocation(
-        packageId.getDomain(), tempo_utils::UrlPath::fromString("collections")
-            .traverse(tempo_utils::UrlPathPart(packageId.toString()))
-            .traverse(tempo_utils::UrlPathPart("versions"))
-            .traverse(tempo_utils::UrlPathPart(packageVersion.toString()))
-            .traverse(tempo_utils::UrlPathPart("package.json"))));
-
-    TU_RETURN_IF_NOT_OK (performGet(packageUrl));
-
     tempo_config::ConfigNode rootNode;
-    TU_ASSIGN_OR_RETURN (rootNode, tempo_config::read_config_string(ctx.body));
+    TU_ASSIGN_OR_RETURN (rootNode, tempo_config::read_config_string(body));
 
     auto rootMap = rootNode.toMap();
     auto packageMap = rootMap.mapAt("package").toMap();
 
-    PackageDescriptor package;
+    zuri_distributor::PackageDescriptor package;
     package.id = packageId;
     package.version = packageVersion;
 
@@ -317,6 +495,10 @@ zuri_distributor::HttpPackageResolver::getPackage(
     TU_RETURN_IF_NOT_OK (tempo_config::parse_config(package.url, urlParser,
         packageMap, "url"));
 
+    tempo_config::StringParser sha256Parser(std::string{});
+    TU_RETURN_IF_NOT_OK (tempo_config::parse_config(package.sha256, sha256Parser,
+        packageMap, "sha256"));
+
     tempo_config::TimeParser uploadedAtParser(absl::RFC3339_full);
     absl::Time uploadedAt;
     TU_RETURN_IF_NOT_OK (tempo_config::parse_config(uploadedAt, uploadedAtParser,
@@ -330,13 +512,147 @@ zuri_distributor::HttpPackageResolver::getPackage(
     return package;
 }
 
+tempo_utils::Result<tempo_utils::Url>
+zuri_distributor::HttpPackageResolver::resolvePackageLocation(
+    const zuri_packager::PackageId &packageId,
+    const zuri_packager::PackageVersion &packageVersion)
+{
+    return resolveLocation(
+        packageId.getDomain(), tempo_utils::UrlPath::fromString("collections")
+            .traverse(tempo_utils::UrlPathPart(packageId.toString()))
+            .traverse(tempo_utils::UrlPathPart("versions"))
+            .traverse(tempo_utils::UrlPathPart(packageVersion.toString()))
+            .traverse(tempo_utils::UrlPathPart("package.json")));
+}
+
+tempo_utils::Result<zuri_distributor::PackageDescriptor>
+zuri_distributor::HttpPackageResolver::getPackage(
+    const zuri_packager::PackageId &packageId,
+    const zuri_packager::PackageVersion &packageVersion)
+{
+    const auto &ctx = m_priv->ctx;
+
+    tempo_utils::Url packageUrl;
+    TU_ASSIGN_OR_RETURN (packageUrl, resolvePackageLocation(packageId, packageVersion));
+
+    TU_RETURN_IF_NOT_OK (performGet(packageUrl));
+
+    return parse_package_descriptor(ctx.body, packageId, packageVersion);
+}
+
+tempo_utils::Result<absl::flat_hash_map<zuri_packager::PackageSpecifier,zuri_distributor::PackageDescriptor>>
+zuri_distributor::HttpPackageResolver::getPackages(
+    const std::vector<zuri_packager::PackageSpecifier> &packageSpecifiers)
+{
+    // a single lookup doesn't benefit from the multi handle
+    if (packageSpecifiers.size() <= 1)
+        return AbstractPackageResolver::getPackages(packageSpecifiers);
+
+    auto *multi = m_priv->multi;
+    auto *metadataCache = m_priv->metadataCache.get();
+    absl::flat_hash_map<zuri_packager::PackageSpecifier,PackageDescriptor> packageDescriptors;
+
+    // add a transfer for each package descriptor which is not fresh in the metadata cache. the request
+    // destructors remove the transfers from the multi handle, so any early return leaves it empty.
+    std::vector<std::unique_ptr<MultiRequest>> requests;
+    for (const auto &specifier : packageSpecifiers) {
+        auto request = std::make_unique<MultiRequest>();
+        request->specifier = specifier;
+        TU_ASSIGN_OR_RETURN (request->url, resolvePackageLocation(
+            specifier.getPackageId(), specifier.getPackageVersion()));
+
+        request->cached = lookup_cache_entry(metadataCache, request->url);
+        if (is_fresh(request->cached)) {
+            PackageDescriptor packageDescriptor;
+            TU_ASSIGN_OR_RETURN (packageDescriptor, parse_package_descriptor(
+                request->cached.getValue().body, specifier.getPackageId(), specifier.getPackageVersion()));
+            packageDescriptors[specifier] = std::move(packageDescriptor);
+            continue;
+        }
+
+        request->handle = curl_easy_init();
+        configure_handle(request->handle, m_priv->options, multi_write_callback, request.get());
+        curl_easy_setopt(request->handle, CURLOPT_URL, request->url.uriView());
+        request->headers = make_conditional_headers(request->cached);
+        curl_easy_setopt(request->handle, CURLOPT_HTTPHEADER, request->headers);
+
+        auto ret = curl_multi_add_handle(multi, request->handle);
+        if (ret != CURLM_OK)
+            return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                "curl_multi_add_handle failed: {}", curl_multi_strerror(ret));
+        request->multi = multi;
+        requests.push_back(std::move(request));
+    }
+
+    // perform all transfers
+    int stillRunning = 0;
+    if (requests.empty())
+        return packageDescriptors;
+    do {
+        auto ret = curl_multi_perform(multi, &stillRunning);
+        if (ret != CURLM_OK)
+            return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                "curl_multi_perform failed: {}", curl_multi_strerror(ret));
+        if (stillRunning) {
+            ret = curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+            if (ret != CURLM_OK)
+                return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                    "curl_multi_poll failed: {}", curl_multi_strerror(ret));
+        }
+    } while (stillRunning);
+
+    // drain the completion messages, failing if any transfer failed
+    CURLMsg *msg;
+    int msgsLeft;
+    while ((msg = curl_multi_info_read(multi, &msgsLeft)) != nullptr) {
+        if (msg->msg == CURLMSG_DONE && msg->data.result != CURLE_OK)
+            return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                "curl_multi_perform failed: {}", curl_easy_strerror(msg->data.result));
+    }
+
+    for (auto &request : requests) {
+        long responseCode = 0;
+        curl_easy_getinfo(request->handle, CURLINFO_RESPONSE_CODE, &responseCode);
+        if (responseCode >= 400)
+            return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                "unexpected {} response code for {}", responseCode, request->url.toString());
+        // only complete responses are cached. if the cached response is still valid then use the
+        // cached body and refresh the expiry
+        if (responseCode == 304 && !request->cached.isEmpty()) {
+            request->body = request->cached.getValue().body;
+            store_cache_entry(metadataCache, request->url, request->handle, request->body);
+        } else if (responseCode == 200) {
+            store_cache_entry(metadataCache, request->url, request->handle, request->body);
+        }
+        PackageDescriptor packageDescriptor;
+        TU_ASSIGN_OR_RETURN (packageDescriptor, parse_package_descriptor(
+            request->body, request->specifier.getPackageId(), request->specifier.getPackageVersion()));
+        packageDescriptors[request->specifier] = std::move(packageDescriptor);
+    }
+
+    return packageDescriptors;
+}
+
 tempo_utils::Result<std::shared_ptr<zuri_distributor::HttpPackageResolver>>
 zuri_distributor::HttpPackageResolver::create(const HttpPackageResolverOptions &options)
 {
     auto priv = std::make_unique<Priv>();
+    priv->options = options;
     priv->ctx.handle = curl_easy_init();
-    curl_easy_setopt(priv->ctx.handle, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(priv->ctx.handle, CURLOPT_WRITEDATA, &priv->ctx);
+    configure_handle(priv->ctx.handle, priv->options, write_callback, &priv->ctx);
+
+    priv->multi = curl_multi_init();
+    priv->metadataCache = options.metadataCache;
+
+    // evict stale and excess responses from the metadata cache. eviction errors are not fatal.
+    if (priv->metadataCache != nullptr) {
+        auto storedBeforeEpochMillis = absl::ToUnixMillis(absl::Now() - options.metadataCacheMaxAge);
+        auto status = priv->metadataCache->pruneHttpCache(storedBeforeEpochMillis, options.metadataCacheMaxBytes);
+        TU_LOG_WARN_IF (status.notOk()) << "failed to prune metadata cache: " << status;
+    }
+    if (options.maxConcurrentRequests > 0) {
+        curl_multi_setopt(priv->multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, (long) options.maxConcurrentRequests);
+    }
 
     return std::shared_ptr<HttpPackageResolver>(new HttpPackageResolver(std::move(priv)));
 }
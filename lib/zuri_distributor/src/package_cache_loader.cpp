@@ -1,22 +1,33 @@
 
+#include <absl/strings/str_cat.h>
 #include <absl/strings/str_join.h>
 #include <absl/strings/str_split.h>
 
 #include <lyric_common/common_types.h>
 #include <lyric_common/plugin.h>
-#include <lyric_runtime/library_plugin.h>
-#include <tempo_utils/file_reader.h>
-#include <tempo_utils/library_loader.h>
 #include <tempo_utils/log_stream.h>
 #include <tempo_utils/platform.h>
 #include <zuri_distributor/distributor_result.h>
 #include <zuri_distributor/package_cache_loader.h>
 
 zuri_distributor::PackageCacheLoader::PackageCacheLoader(
-    std::shared_ptr<AbstractPackageCache> readonlyPackageCache)
-    : m_readonlyPackageCache(std::move(readonlyPackageCache))
+    std::shared_ptr<AbstractPackageCache> readonlyPackageCache,
+    std::shared_ptr<zuri_packager::ObjectCache> objectCache,
+    std::shared_ptr<zuri_packager::PluginCache> pluginCache)
+    : m_readonlyPackageCache(std::move(readonlyPackageCache)),
+      m_objectCache(std::move(objectCache)),
+      m_pluginCache(std::move(pluginCache)),
+      m_indexGeneration(0)
 {
     TU_ASSERT (m_readonlyPackageCache != nullptr);
+    // by default objects and plugins are shared with every other loader in the process
+    if (m_objectCache == nullptr) {
+        m_objectCache = zuri_packager::ObjectCache::processCache();
+    }
+    if (m_pluginCache == nullptr) {
+        m_pluginCache = zuri_packager::PluginCache::processCache();
+    }
+    m_indexGeneration = m_readonlyPackageCache->getGeneration();
 }
 
 std::shared_ptr<zuri_distributor::AbstractPackageCache>
@@ -25,6 +36,14 @@ zuri_distributor::PackageCacheLoader::getPackageCache() const
     return m_readonlyPackageCache;
 }
 
+void
+zuri_distributor::PackageCacheLoader::invalidate()
+{
+    m_readonlyPackageCache->invalidate();
+    absl::MutexLock locker(&m_lock);
+    m_moduleIndex.clear();
+}
+
 tempo_utils::Result<std::filesystem::path>
 zuri_distributor::PackageCacheLoader::findModule(
     const lyric_common::ModuleLocation &location,
@@ -32,6 +51,36 @@ zuri_distributor::PackageCacheLoader::findModule(
 {
     if (!location.isValid() || location.getScheme() != "dev.zuri.pkg")
         return std::filesystem::path{};
+
+    auto generation = m_readonlyPackageCache->getGeneration();
+    auto key = absl::StrCat(location.toString(), dotSuffix);
+
+    {
+        absl::MutexLock locker(&m_lock);
+        if (generation != m_indexGeneration) {
+            m_moduleIndex.clear();
+            m_indexGeneration = generation;
+        }
+        auto entry = m_moduleIndex.find(key);
+        if (entry != m_moduleIndex.cend())
+            return entry->second;
+    }
+
+    std::filesystem::path modulePath;
+    TU_ASSIGN_OR_RETURN (modulePath, searchModule(location, dotSuffix));
+
+    absl::MutexLock locker(&m_lock);
+    if (generation == m_indexGeneration) {
+        m_moduleIndex[key] = modulePath;
+    }
+    return modulePath;
+}
+
+tempo_utils::Result<std::filesystem::path>
+zuri_distributor::PackageCacheLoader::searchModule(
+    const lyric_common::ModuleLocation &location,
+    std::string_view dotSuffix) const
+{
     auto specifier = zuri_packager::PackageSpecifier::fromAuthority(location.getAuthority());
     if (!specifier.isValid())
         return std::filesystem::path{};
@@ -68,19 +117,14 @@ zuri_distributor::PackageCacheLoader::loadModule(const lyric_common::ModuleLocat
     if (absolutePath.empty())
         return Option<lyric_object::LyricObject>();
 
-    tempo_utils::FileReader reader(absolutePath.string());
-    if (!reader.isValid())
-        return reader.getStatus();
-    auto bytes = reader.getBytes();
-
-    // verify that file contents is a valid object
-    if (!lyric_object::LyricObject::verify(std::span<const tu_uint8>(bytes->getData(), bytes->getSize())))
-        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
-            "failed to verify object");
+    // map the object file, verifying the contents unless the file has been verified before
+    auto loadObjectResult = m_objectCache->loadObject(absolutePath);
+    if (loadObjectResult.isStatus())
+        return loadObjectResult.getStatus();
 
     // return platform-specific LyricObject
     TU_LOG_V << "loaded module at " << absolutePath;
-    return Option(lyric_object::LyricObject(bytes));
+    return Option(loadObjectResult.getResult());
 }
 
 tempo_utils::Result<Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>>>
@@ -94,29 +138,6 @@ zuri_distributor::PackageCacheLoader::loadPlugin(
     if (absolutePath.empty())
         return Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>>();
 
-    // attempt to load the plugin
-    auto loader = std::make_shared<tempo_utils::LibraryLoader>(absolutePath, "native_init");
-    if (!loader->isValid()) {
-        auto status = loader->getStatus();
-        // if plugin is not found then return empty option instead of status
-        if (status.getStatusCode() == tempo_utils::StatusCode::kNotFound)
-            return Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>>();
-        return status;
-    }
-
-    // cast raw pointer to native_init function pointer
-    auto native_init = (lyric_runtime::NativeInitFunc) loader->symbolPointer();
-    if (native_init == nullptr)
-        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
-            "failed to retrieve native_init symbol from plugin {}", absolutePath.string());
-
-    // retrieve the plugin interface
-    auto *iface = native_init();
-    if (iface == nullptr)
-        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
-            "failed to retrieve interface for plugin {}", absolutePath.string());
-
-    TU_LOG_V << "loaded plugin " << absolutePath;
-    auto plugin = std::make_shared<const lyric_runtime::LibraryPlugin>(loader, iface);
-    return Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>>(plugin);
+    // load the plugin, or return the existing plugin if it has already been loaded
+    return m_pluginCache->loadPlugin(absolutePath);
 }
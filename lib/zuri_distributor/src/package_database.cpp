@@ -1,14 +1,22 @@
 
 #include <sqlite3.h>
 
+#include <absl/strings/str_cat.h>
+
 #include <zuri_distributor/package_database.h>
 #include <zuri_distributor/distributor_result.h>
 
+/**
+ * How long to wait for a lock held by another connection before failing with SQLITE_BUSY.
+ */
+constexpr int kBusyTimeoutMillis = 30000;
+
 zuri_distributor::PackageDatabase::PackageDatabase(
     const std::filesystem::path &databaseFilePath,
     sqlite3 *db)
     : m_databaseFilePath(databaseFilePath),
-      m_db(db)
+      m_db(db),
+      m_numLocalChanges(0)
 {
     TU_ASSERT (!m_databaseFilePath.empty());
     TU_ASSERT (m_db != nullptr);
@@ -18,6 +26,19 @@ zuri_distributor::PackageDatabase::~PackageDatabase()
 {
     sqlite3_finalize(m_listSpecifiers);
     sqlite3_finalize(m_insertSpecifier);
+    sqlite3_finalize(m_upsertPackage);
+    sqlite3_finalize(m_selectPackageDigest);
+    sqlite3_finalize(m_selectInstalledPackage);
+    sqlite3_finalize(m_selectDataVersion);
+    sqlite3_finalize(m_selectSchemaVersion);
+    sqlite3_finalize(m_deletePackage);
+    sqlite3_finalize(m_upsertFile);
+    sqlite3_finalize(m_selectPackageFileDigests);
+    sqlite3_finalize(m_deletePackageFiles);
+    sqlite3_finalize(m_selectHttpCacheEntry);
+    sqlite3_finalize(m_upsertHttpCacheEntry);
+    sqlite3_finalize(m_deleteStaleHttpCacheEntries);
+    sqlite3_finalize(m_deleteExcessHttpCacheEntries);
 
     auto ret = sqlite3_close_v2(m_db);
     TU_LOG_WARN_IF (ret != SQLITE_OK) << "sqlite close failed unexpectedly: " << sqlite3_errstr(ret);
@@ -33,6 +54,9 @@ zuri_distributor::PackageDatabase::open(const std::filesystem::path &databaseFil
             "failed to open environment database {}: {}",
             databaseFilePath.string(), sqlite3_errstr(ret));
 
+    // wait for other processes to finish writing instead of failing immediately with SQLITE_BUSY
+    sqlite3_busy_timeout(db, kBusyTimeoutMillis);
+
     auto packageDatabase = std::shared_ptr<PackageDatabase>(new PackageDatabase(databaseFilePath, db));
     TU_RETURN_IF_NOT_OK (packageDatabase->prepare());
     return packageDatabase;
@@ -64,6 +88,45 @@ sqlite3_err_to_status(char *err)
     return status;
 }
 
+/**
+ * Add the specified column to the table unless the table already has a column with that name.
+ */
+static tempo_utils::Status
+add_column_if_missing(sqlite3 *db, std::string_view table, std::string_view column, std::string_view type)
+{
+    auto sqlTableInfo = absl::StrCat("PRAGMA table_info(", table, ");");
+    sqlite3_stmt *stmt = nullptr;
+    auto ret = sqlite3_prepare_v2(db, sqlTableInfo.c_str(), sqlTableInfo.size(), &stmt, nullptr);
+    if (ret != SQLITE_OK)
+        return zuri_distributor::DistributorStatus::forCondition(
+            zuri_distributor::DistributorCondition::kDistributorInvariant,
+            "failed to read schema for '{}' table: {}", table, sqlite3_errstr(ret));
+
+    bool found = false;
+    while ((ret = sqlite3_step(stmt)) == SQLITE_ROW) {
+        auto *name = (const char *) sqlite3_column_text(stmt, 1);
+        if (name != nullptr && column == name) {
+            found = true;
+        }
+    }
+    sqlite3_finalize(stmt);
+    if (ret != SQLITE_DONE)
+        return zuri_distributor::DistributorStatus::forCondition(
+            zuri_distributor::DistributorCondition::kDistributorInvariant,
+            "failed to read schema for '{}' table: {}", table, sqlite3_errmsg(db));
+    if (found)
+        return {};
+
+    auto sqlAddColumn = absl::StrCat("ALTER TABLE ", table, " ADD COLUMN ", column, " ", type, ";");
+    char *err = nullptr;
+    ret = sqlite3_exec(db, sqlAddColumn.c_str(), nullptr, nullptr, &err);
+    if (ret != SQLITE_OK && err == nullptr)
+        return zuri_distributor::DistributorStatus::forCondition(
+            zuri_distributor::DistributorCondition::kDistributorInvariant,
+            "failed to add column '{}' to '{}' table: {}", column, table, sqlite3_errstr(ret));
+    return sqlite3_err_to_status(err);
+}
+
 tempo_utils::Status
 zuri_distributor::PackageDatabase::prepare()
 {
@@ -71,6 +134,15 @@ zuri_distributor::PackageDatabase::prepare()
     const char *tail = nullptr;
     int ret;
 
+    // use write-ahead logging, so that readers are not blocked by an install and each committed
+    // transaction costs a single sync of the log rather than a sync of the database and journal
+
+    ret = sqlite3_exec(m_db, "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;", nullptr, nullptr, &err);
+    if (ret != SQLITE_OK)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to enable write-ahead logging: {}", sqlite3_errstr(ret));
+    TU_RETURN_IF_NOT_OK (sqlite3_err_to_status(err));
+
     // exec createSpecifiersTable statement
 
     std::string sqlCreateSpecifiersTable = R"(
@@ -97,6 +169,8 @@ CREATE TABLE IF NOT EXISTS Packages (
 	status TINYINT,
 	installedAt TEXT,
     sha256 VARCHAR(64),
+    path TEXT,
+    config TEXT,
 	FOREIGN KEY (specifier) REFERENCES Specifiers(specifier)
     );)";
 
@@ -106,6 +180,11 @@ CREATE TABLE IF NOT EXISTS Packages (
             "failed to create 'Packages' table: {}", sqlite3_errstr(ret));
     TU_RETURN_IF_NOT_OK (sqlite3_err_to_status(err));
 
+    // add columns which are missing from databases created by earlier versions
+    TU_RETURN_IF_NOT_OK (add_column_if_missing(m_db, "Packages", "sha256", "VARCHAR(64)"));
+    TU_RETURN_IF_NOT_OK (add_column_if_missing(m_db, "Packages", "path", "TEXT"));
+    TU_RETURN_IF_NOT_OK (add_column_if_missing(m_db, "Packages", "config", "TEXT"));
+
     // exec createFilesTable statement
 
     std::string sqlCreateFilesTable = R"(
@@ -123,6 +202,25 @@ CREATE TABLE IF NOT EXISTS Files (
             "failed to create 'Files' table: {}", sqlite3_errstr(ret));
     TU_RETURN_IF_NOT_OK (sqlite3_err_to_status(err));
 
+    // exec createHttpCacheTable statement
+
+    std::string sqlCreateHttpCacheTable = R"(
+CREATE TABLE IF NOT EXISTS HttpCache (
+    url VARCHAR(2048) PRIMARY KEY,
+    etag TEXT,
+    lastModified TEXT,
+    expiresEpochMillis BIGINT,
+    body BLOB
+    );)";
+
+    ret = sqlite3_exec(m_db, sqlCreateHttpCacheTable.c_str(), nullptr, nullptr, &err);
+    if (ret != SQLITE_OK)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to create 'HttpCache' table: {}", sqlite3_errstr(ret));
+    TU_RETURN_IF_NOT_OK (sqlite3_err_to_status(err));
+
+    TU_RETURN_IF_NOT_OK (add_column_if_missing(m_db, "HttpCache", "storedEpochMillis", "BIGINT"));
+
     // prepare listSpecifiers statement
 
     std::string sqlListSpecifiers = R"(
@@ -140,7 +238,7 @@ SELECT specifier FROM Specifiers;)";
     // prepare insertSpecifier statement
 
     std::string sqlInsertSpecifier = R"(
-INSERT INTO Specifiers
+INSERT OR IGNORE INTO Specifiers
     (specifier, packageName, packageDomain, majorVersion, minorVersion, patchVersion)
     VALUES (?, ?, ?, ?, ?, ?);)";
 
@@ -153,6 +251,212 @@ INSERT INTO Specifiers
         return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
             "encountered unexpected trailing data preparing insertSpecifier statement: '{}'", tail);
 
+    // prepare upsertPackage statement
+
+    std::string sqlUpsertPackage = R"(
+INSERT INTO Packages
+    (specifier, status, installedAt, sha256, path, config)
+    VALUES (?, 1, strftime('%Y-%m-%dT%H:%M:%fZ', 'now'), ?, ?, ?)
+    ON CONFLICT (specifier) DO UPDATE SET
+        status = excluded.status,
+        installedAt = excluded.installedAt,
+        sha256 = excluded.sha256,
+        path = excluded.path,
+        config = excluded.config;)";
+
+    ret = sqlite3_prepare_v3(m_db, sqlUpsertPackage.c_str(), sqlUpsertPackage.size(),
+        0, &m_upsertPackage, &tail);
+    if (ret != SQLITE_OK)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to prepare upsertPackage statement: {}", sqlite3_errstr(ret));
+    if (tail != nullptr && std::strlen(tail) > 0)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "encountered unexpected trailing data preparing upsertPackage statement: '{}'", tail);
+
+    // prepare selectPackageDigest statement
+
+    std::string sqlSelectPackageDigest = R"(
+SELECT sha256 FROM Packages WHERE specifier = ?;)";
+
+    ret = sqlite3_prepare_v3(m_db, sqlSelectPackageDigest.c_str(), sqlSelectPackageDigest.size(),
+        0, &m_selectPackageDigest, &tail);
+    if (ret != SQLITE_OK)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to prepare selectPackageDigest statement: {}", sqlite3_errstr(ret));
+    if (tail != nullptr && std::strlen(tail) > 0)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "encountered unexpected trailing data preparing selectPackageDigest statement: '{}'", tail);
+
+    // prepare selectInstalledPackage statement
+
+    std::string sqlSelectInstalledPackage = R"(
+SELECT path, config, sha256 FROM Packages WHERE specifier = ? AND status = 1;)";
+
+    ret = sqlite3_prepare_v3(m_db, sqlSelectInstalledPackage.c_str(), sqlSelectInstalledPackage.size(),
+        0, &m_selectInstalledPackage, &tail);
+    if (ret != SQLITE_OK)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to prepare selectInstalledPackage statement: {}", sqlite3_errstr(ret));
+    if (tail != nullptr && std::strlen(tail) > 0)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "encountered unexpected trailing data preparing selectInstalledPackage statement: '{}'", tail);
+
+    // prepare selectDataVersion statement
+
+    std::string sqlSelectDataVersion = R"(
+PRAGMA data_version;)";
+
+    ret = sqlite3_prepare_v3(m_db, sqlSelectDataVersion.c_str(), sqlSelectDataVersion.size(),
+        0, &m_selectDataVersion, &tail);
+    if (ret != SQLITE_OK)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to prepare selectDataVersion statement: {}", sqlite3_errstr(ret));
+    if (tail != nullptr && std::strlen(tail) > 0)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "encountered unexpected trailing data preparing selectDataVersion statement: '{}'", tail);
+
+    // prepare selectSchemaVersion statement
+
+    std::string sqlSelectSchemaVersion = R"(
+PRAGMA user_version;)";
+
+    ret = sqlite3_prepare_v3(m_db, sqlSelectSchemaVersion.c_str(), sqlSelectSchemaVersion.size(),
+        0, &m_selectSchemaVersion, &tail);
+    if (ret != SQLITE_OK)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to prepare selectSchemaVersion statement: {}", sqlite3_errstr(ret));
+    if (tail != nullptr && std::strlen(tail) > 0)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "encountered unexpected trailing data preparing selectSchemaVersion statement: '{}'", tail);
+
+    // prepare deletePackage statement
+
+    std::string sqlDeletePackage = R"(
+DELETE FROM Packages WHERE specifier = ?;)";
+
+    ret = sqlite3_prepare_v3(m_db, sqlDeletePackage.c_str(), sqlDeletePackage.size(),
+        0, &m_deletePackage, &tail);
+    if (ret != SQLITE_OK)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to prepare deletePackage statement: {}", sqlite3_errstr(ret));
+    if (tail != nullptr && std::strlen(tail) > 0)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "encountered unexpected trailing data preparing deletePackage statement: '{}'", tail);
+
+    // prepare upsertFile statement
+
+    std::string sqlUpsertFile = R"(
+INSERT INTO Files
+    (specifier, path, sha256)
+    VALUES (?, ?, ?)
+    ON CONFLICT (specifier, path) DO UPDATE SET
+        sha256 = excluded.sha256;)";
+
+    ret = sqlite3_prepare_v3(m_db, sqlUpsertFile.c_str(), sqlUpsertFile.size(),
+        0, &m_upsertFile, &tail);
+    if (ret != SQLITE_OK)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to prepare upsertFile statement: {}", sqlite3_errstr(ret));
+    if (tail != nullptr && std::strlen(tail) > 0)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "encountered unexpected trailing data preparing upsertFile statement: '{}'", tail);
+
+    // prepare selectPackageFileDigests statement
+
+    std::string sqlSelectPackageFileDigests = R"(
+SELECT DISTINCT sha256 FROM Files WHERE specifier = ?;)";
+
+    ret = sqlite3_prepare_v3(m_db, sqlSelectPackageFileDigests.c_str(), sqlSelectPackageFileDigests.size(),
+        0, &m_selectPackageFileDigests, &tail);
+    if (ret != SQLITE_OK)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to prepare selectPackageFileDigests statement: {}", sqlite3_errstr(ret));
+    if (tail != nullptr && std::strlen(tail) > 0)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "encountered unexpected trailing data preparing selectPackageFileDigests statement: '{}'", tail);
+
+    // prepare deletePackageFiles statement
+
+    std::string sqlDeletePackageFiles = R"(
+DELETE FROM Files WHERE specifier = ?;)";
+
+    ret = sqlite3_prepare_v3(m_db, sqlDeletePackageFiles.c_str(), sqlDeletePackageFiles.size(),
+        0, &m_deletePackageFiles, &tail);
+    if (ret != SQLITE_OK)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to prepare deletePackageFiles statement: {}", sqlite3_errstr(ret));
+    if (tail != nullptr && std::strlen(tail) > 0)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "encountered unexpected trailing data preparing deletePackageFiles statement: '{}'", tail);
+
+    // prepare selectHttpCacheEntry statement
+
+    std::string sqlSelectHttpCacheEntry = R"(
+SELECT etag, lastModified, expiresEpochMillis, body FROM HttpCache WHERE url = ?;)";
+
+    ret = sqlite3_prepare_v3(m_db, sqlSelectHttpCacheEntry.c_str(), sqlSelectHttpCacheEntry.size(),
+        0, &m_selectHttpCacheEntry, &tail);
+    if (ret != SQLITE_OK)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to prepare selectHttpCacheEntry statement: {}", sqlite3_errstr(ret));
+    if (tail != nullptr && std::strlen(tail) > 0)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "encountered unexpected trailing data preparing selectHttpCacheEntry statement: '{}'", tail);
+
+    // prepare upsertHttpCacheEntry statement
+
+    std::string sqlUpsertHttpCacheEntry = R"(
+INSERT INTO HttpCache
+    (url, etag, lastModified, expiresEpochMillis, body, storedEpochMillis)
+    VALUES (?, ?, ?, ?, ?, CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER))
+    ON CONFLICT (url) DO UPDATE SET
+        etag = excluded.etag,
+        lastModified = excluded.lastModified,
+        expiresEpochMillis = excluded.expiresEpochMillis,
+        body = excluded.body,
+        storedEpochMillis = excluded.storedEpochMillis;)";
+
+    ret = sqlite3_prepare_v3(m_db, sqlUpsertHttpCacheEntry.c_str(), sqlUpsertHttpCacheEntry.size(),
+        0, &m_upsertHttpCacheEntry, &tail);
+    if (ret != SQLITE_OK)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to prepare upsertHttpCacheEntry statement: {}", sqlite3_errstr(ret));
+    if (tail != nullptr && std::strlen(tail) > 0)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "encountered unexpected trailing data preparing upsertHttpCacheEntry statement: '{}'", tail);
+
+    // prepare deleteStaleHttpCacheEntries statement
+
+    std::string sqlDeleteStaleHttpCacheEntries = R"(
+DELETE FROM HttpCache WHERE storedEpochMillis IS NULL OR storedEpochMillis < ?;)";
+
+    ret = sqlite3_prepare_v3(m_db, sqlDeleteStaleHttpCacheEntries.c_str(), sqlDeleteStaleHttpCacheEntries.size(),
+        0, &m_deleteStaleHttpCacheEntries, &tail);
+    if (ret != SQLITE_OK)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to prepare deleteStaleHttpCacheEntries statement: {}", sqlite3_errstr(ret));
+    if (tail != nullptr && std::strlen(tail) > 0)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "encountered unexpected trailing data preparing deleteStaleHttpCacheEntries statement: '{}'", tail);
+
+    // prepare deleteExcessHttpCacheEntries statement
+
+    std::string sqlDeleteExcessHttpCacheEntries = R"(
+DELETE FROM HttpCache WHERE rowid IN (
+    SELECT rowid FROM (
+        SELECT rowid, SUM(length(body)) OVER (ORDER BY storedEpochMillis DESC, rowid DESC) AS totalBytes
+        FROM HttpCache)
+    WHERE totalBytes > ?);)";
+
+    ret = sqlite3_prepare_v3(m_db, sqlDeleteExcessHttpCacheEntries.c_str(), sqlDeleteExcessHttpCacheEntries.size(),
+        0, &m_deleteExcessHttpCacheEntries, &tail);
+    if (ret != SQLITE_OK)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to prepare deleteExcessHttpCacheEntries statement: {}", sqlite3_errstr(ret));
+    if (tail != nullptr && std::strlen(tail) > 0)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "encountered unexpected trailing data preparing deleteExcessHttpCacheEntries statement: '{}'", tail);
+
     return {};
 }
 
@@ -161,3 +465,351 @@ zuri_distributor::PackageDatabase::getDatabaseFilePath() const
 {
     return m_databaseFilePath;
 }
+
+static tempo_utils::Status
+execute_sql(sqlite3 *db, const char *sql)
+{
+    char *err = nullptr;
+    auto ret = sqlite3_exec(db, sql, nullptr, nullptr, &err);
+    if (ret != SQLITE_OK && err == nullptr)
+        return zuri_distributor::DistributorStatus::forCondition(
+            zuri_distributor::DistributorCondition::kDistributorInvariant,
+            "failed to execute '{}': {}", sql, sqlite3_errstr(ret));
+    return sqlite3_err_to_status(err);
+}
+
+/**
+ * Begin a transaction. Statements executed until the transaction is committed or rolled back are
+ * applied atomically. The write lock is acquired immediately, so the transaction cannot fail later
+ * because another connection started writing first.
+ */
+tempo_utils::Status
+zuri_distributor::PackageDatabase::beginTransaction()
+{
+    absl::MutexLock locker(&m_lock);
+    return execute_sql(m_db, "BEGIN IMMEDIATE;");
+}
+
+tempo_utils::Status
+zuri_distributor::PackageDatabase::commitTransaction()
+{
+    absl::MutexLock locker(&m_lock);
+    return execute_sql(m_db, "COMMIT;");
+}
+
+tempo_utils::Status
+zuri_distributor::PackageDatabase::rollbackTransaction()
+{
+    absl::MutexLock locker(&m_lock);
+    m_numLocalChanges++;
+    return execute_sql(m_db, "ROLLBACK;");
+}
+
+/**
+ * Step the prepared statement until it is done, discarding any result rows, and then reset it so it
+ * can be reused.
+ */
+static tempo_utils::Status
+execute_statement(sqlite3 *db, sqlite3_stmt *stmt, std::string_view name)
+{
+    int ret;
+    do {
+        ret = sqlite3_step(stmt);
+    } while (ret == SQLITE_ROW);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    if (ret != SQLITE_DONE)
+        return zuri_distributor::DistributorStatus::forCondition(
+            zuri_distributor::DistributorCondition::kDistributorInvariant,
+            "failed to execute {} statement: {}", name, sqlite3_errmsg(db));
+    return {};
+}
+
+static tempo_utils::Status
+insert_specifier(sqlite3 *db, sqlite3_stmt *stmt, const zuri_packager::PackageSpecifier &specifier)
+{
+    auto specifierString = specifier.toString();
+    auto packageName = specifier.getPackageName();
+    auto packageDomain = specifier.getPackageDomain();
+    sqlite3_bind_text(stmt, 1, specifierString.c_str(), specifierString.size(), SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, packageName.c_str(), packageName.size(), SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 3, packageDomain.c_str(), packageDomain.size(), SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 4, specifier.getMajorVersion());
+    sqlite3_bind_int(stmt, 5, specifier.getMinorVersion());
+    sqlite3_bind_int(stmt, 6, specifier.getPatchVersion());
+    return execute_statement(db, stmt, "insertSpecifier");
+}
+
+static std::string
+column_string(sqlite3_stmt *stmt, int index)
+{
+    auto *data = (const char *) sqlite3_column_blob(stmt, index);
+    if (data == nullptr)
+        return {};
+    return std::string(data, sqlite3_column_bytes(stmt, index));
+}
+
+/**
+ * Returns a value which changes whenever the contents of the database change, either through this
+ * connection or through any other connection to the same database.
+ */
+tu_int64
+zuri_distributor::PackageDatabase::getDataVersion()
+{
+    absl::MutexLock locker(&m_lock);
+    tu_int64 dataVersion = 0;
+    if (sqlite3_step(m_selectDataVersion) == SQLITE_ROW) {
+        dataVersion = sqlite3_column_int64(m_selectDataVersion, 0);
+    }
+    sqlite3_reset(m_selectDataVersion);
+    // data_version only reflects commits from other connections, so add the local changes
+    return dataVersion + m_numLocalChanges;
+}
+
+/**
+ * Returns the schema version recorded in the database, which is zero for a database which has not
+ * been migrated.
+ */
+int
+zuri_distributor::PackageDatabase::getSchemaVersion()
+{
+    absl::MutexLock locker(&m_lock);
+    int schemaVersion = 0;
+    if (sqlite3_step(m_selectSchemaVersion) == SQLITE_ROW) {
+        schemaVersion = sqlite3_column_int(m_selectSchemaVersion, 0);
+    }
+    sqlite3_reset(m_selectSchemaVersion);
+    return schemaVersion;
+}
+
+/**
+ * Record the schema version in the database. If called within a transaction then the version is
+ * only recorded if the transaction is committed.
+ *
+ * @param schemaVersion The schema version.
+ * @return Status
+ */
+tempo_utils::Status
+zuri_distributor::PackageDatabase::setSchemaVersion(int schemaVersion)
+{
+    absl::MutexLock locker(&m_lock);
+    char *err = nullptr;
+    auto sqlSetSchemaVersion = absl::StrCat("PRAGMA user_version = ", schemaVersion, ";");
+    auto ret = sqlite3_exec(m_db, sqlSetSchemaVersion.c_str(), nullptr, nullptr, &err);
+    if (ret != SQLITE_OK)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to set schema version: {}", sqlite3_errstr(ret));
+    TU_RETURN_IF_NOT_OK (sqlite3_err_to_status(err));
+    m_numLocalChanges++;
+    return {};
+}
+
+tempo_utils::Status
+zuri_distributor::PackageDatabase::putPackage(
+    const zuri_packager::PackageSpecifier &specifier,
+    std::string_view sha256,
+    const std::filesystem::path &packagePath,
+    std::string_view packageConfig)
+{
+    if (!specifier.isValid())
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "invalid package specifier");
+
+    absl::MutexLock locker(&m_lock);
+    m_numLocalChanges++;
+
+    TU_RETURN_IF_NOT_OK (insert_specifier(m_db, m_insertSpecifier, specifier));
+
+    auto specifierString = specifier.toString();
+    sqlite3_bind_text(m_upsertPackage, 1, specifierString.c_str(), specifierString.size(), SQLITE_TRANSIENT);
+    if (!sha256.empty()) {
+        sqlite3_bind_text(m_upsertPackage, 2, sha256.data(), sha256.size(), SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_null(m_upsertPackage, 2);
+    }
+    if (!packagePath.empty()) {
+        auto packagePathString = packagePath.string();
+        sqlite3_bind_text(m_upsertPackage, 3, packagePathString.c_str(), packagePathString.size(), SQLITE_TRANSIENT);
+        sqlite3_bind_text(m_upsertPackage, 4, packageConfig.data(), packageConfig.size(), SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_null(m_upsertPackage, 3);
+        sqlite3_bind_null(m_upsertPackage, 4);
+    }
+    return execute_statement(m_db, m_upsertPackage, "upsertPackage");
+}
+
+/**
+ * Returns the installed package with the specified specifier, or an empty option if the package is
+ * not installed. If the package was recorded without its path then the path of the returned package
+ * is empty.
+ */
+tempo_utils::Result<Option<zuri_distributor::InstalledPackage>>
+zuri_distributor::PackageDatabase::getInstalledPackage(const zuri_packager::PackageSpecifier &specifier)
+{
+    absl::MutexLock locker(&m_lock);
+
+    auto specifierString = specifier.toString();
+    sqlite3_bind_text(m_selectInstalledPackage, 1, specifierString.c_str(), specifierString.size(), SQLITE_TRANSIENT);
+
+    Option<InstalledPackage> installedOption;
+    auto ret = sqlite3_step(m_selectInstalledPackage);
+    if (ret == SQLITE_ROW) {
+        InstalledPackage installed;
+        installed.path = column_string(m_selectInstalledPackage, 0);
+        installed.config = column_string(m_selectInstalledPackage, 1);
+        installed.sha256 = column_string(m_selectInstalledPackage, 2);
+        installedOption = Option(std::move(installed));
+        ret = SQLITE_DONE;
+    }
+    sqlite3_reset(m_selectInstalledPackage);
+    sqlite3_clear_bindings(m_selectInstalledPackage);
+
+    if (ret != SQLITE_DONE)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to execute selectInstalledPackage statement: {}", sqlite3_errmsg(m_db));
+    return installedOption;
+}
+
+tempo_utils::Result<Option<std::string>>
+zuri_distributor::PackageDatabase::getPackageDigest(const zuri_packager::PackageSpecifier &specifier)
+{
+    absl::MutexLock locker(&m_lock);
+
+    auto specifierString = specifier.toString();
+    sqlite3_bind_text(m_selectPackageDigest, 1, specifierString.c_str(), specifierString.size(), SQLITE_TRANSIENT);
+
+    Option<std::string> digestOption;
+    auto ret = sqlite3_step(m_selectPackageDigest);
+    if (ret == SQLITE_ROW) {
+        auto *text = (const char *) sqlite3_column_text(m_selectPackageDigest, 0);
+        if (text != nullptr) {
+            digestOption = Option(std::string(text, sqlite3_column_bytes(m_selectPackageDigest, 0)));
+        }
+        ret = SQLITE_DONE;
+    }
+    sqlite3_reset(m_selectPackageDigest);
+    sqlite3_clear_bindings(m_selectPackageDigest);
+
+    if (ret != SQLITE_DONE)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to execute selectPackageDigest statement: {}", sqlite3_errmsg(m_db));
+    return digestOption;
+}
+
+tempo_utils::Status
+zuri_distributor::PackageDatabase::putPackageFile(
+    const zuri_packager::PackageSpecifier &specifier,
+    std::string_view path,
+    std::string_view sha256)
+{
+    absl::MutexLock locker(&m_lock);
+    m_numLocalChanges++;
+
+    auto specifierString = specifier.toString();
+    sqlite3_bind_text(m_upsertFile, 1, specifierString.c_str(), specifierString.size(), SQLITE_TRANSIENT);
+    sqlite3_bind_text(m_upsertFile, 2, path.data(), path.size(), SQLITE_TRANSIENT);
+    sqlite3_bind_text(m_upsertFile, 3, sha256.data(), sha256.size(), SQLITE_TRANSIENT);
+    return execute_statement(m_db, m_upsertFile, "upsertFile");
+}
+
+/**
+ * Returns the distinct digests of the files recorded for the specified package. A package which was
+ * installed without recording its files has no digests.
+ */
+tempo_utils::Result<std::vector<std::string>>
+zuri_distributor::PackageDatabase::getPackageFileDigests(const zuri_packager::PackageSpecifier &specifier)
+{
+    absl::MutexLock locker(&m_lock);
+
+    auto specifierString = specifier.toString();
+    sqlite3_bind_text(m_selectPackageFileDigests, 1, specifierString.c_str(), specifierString.size(), SQLITE_TRANSIENT);
+
+    std::vector<std::string> digests;
+    int ret;
+    while ((ret = sqlite3_step(m_selectPackageFileDigests)) == SQLITE_ROW) {
+        auto digest = column_string(m_selectPackageFileDigests, 0);
+        if (!digest.empty()) {
+            digests.push_back(std::move(digest));
+        }
+    }
+    sqlite3_reset(m_selectPackageFileDigests);
+    sqlite3_clear_bindings(m_selectPackageFileDigests);
+
+    if (ret != SQLITE_DONE)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to execute selectPackageFileDigests statement: {}", sqlite3_errmsg(m_db));
+    return digests;
+}
+
+tempo_utils::Status
+zuri_distributor::PackageDatabase::removePackage(const zuri_packager::PackageSpecifier &specifier)
+{
+    absl::MutexLock locker(&m_lock);
+    m_numLocalChanges++;
+
+    auto specifierString = specifier.toString();
+    sqlite3_bind_text(m_deletePackageFiles, 1, specifierString.c_str(), specifierString.size(), SQLITE_TRANSIENT);
+    TU_RETURN_IF_NOT_OK (execute_statement(m_db, m_deletePackageFiles, "deletePackageFiles"));
+    sqlite3_bind_text(m_deletePackage, 1, specifierString.c_str(), specifierString.size(), SQLITE_TRANSIENT);
+    return execute_statement(m_db, m_deletePackage, "deletePackage");
+}
+
+tempo_utils::Result<Option<zuri_distributor::HttpCacheEntry>>
+zuri_distributor::PackageDatabase::getHttpCacheEntry(std::string_view url)
+{
+    absl::MutexLock locker(&m_lock);
+
+    sqlite3_bind_text(m_selectHttpCacheEntry, 1, url.data(), url.size(), SQLITE_TRANSIENT);
+
+    Option<HttpCacheEntry> entryOption;
+    auto ret = sqlite3_step(m_selectHttpCacheEntry);
+    if (ret == SQLITE_ROW) {
+        HttpCacheEntry entry;
+        entry.etag = column_string(m_selectHttpCacheEntry, 0);
+        entry.lastModified = column_string(m_selectHttpCacheEntry, 1);
+        entry.expiresEpochMillis = sqlite3_column_int64(m_selectHttpCacheEntry, 2);
+        entry.body = column_string(m_selectHttpCacheEntry, 3);
+        entryOption = Option(std::move(entry));
+        ret = SQLITE_DONE;
+    }
+    sqlite3_reset(m_selectHttpCacheEntry);
+    sqlite3_clear_bindings(m_selectHttpCacheEntry);
+
+    if (ret != SQLITE_DONE)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to execute selectHttpCacheEntry statement: {}", sqlite3_errmsg(m_db));
+    return entryOption;
+}
+
+tempo_utils::Status
+zuri_distributor::PackageDatabase::putHttpCacheEntry(std::string_view url, const HttpCacheEntry &entry)
+{
+    absl::MutexLock locker(&m_lock);
+
+    sqlite3_bind_text(m_upsertHttpCacheEntry, 1, url.data(), url.size(), SQLITE_TRANSIENT);
+    sqlite3_bind_text(m_upsertHttpCacheEntry, 2, entry.etag.c_str(), entry.etag.size(), SQLITE_TRANSIENT);
+    sqlite3_bind_text(m_upsertHttpCacheEntry, 3, entry.lastModified.c_str(), entry.lastModified.size(), SQLITE_TRANSIENT);
+    sqlite3_bind_int64(m_upsertHttpCacheEntry, 4, entry.expiresEpochMillis);
+    sqlite3_bind_blob(m_upsertHttpCacheEntry, 5, entry.body.data(), entry.body.size(), SQLITE_TRANSIENT);
+    return execute_statement(m_db, m_upsertHttpCacheEntry, "upsertHttpCacheEntry");
+}
+
+/**
+ * Evict cached HTTP responses which were stored before the specified time, and then evict the
+ * least recently stored responses until the total size of the remaining response bodies is at
+ * most maxTotalBytes.
+ *
+ * @param storedBeforeEpochMillis Responses stored before this time are evicted.
+ * @param maxTotalBytes The maximum total size of the cached response bodies.
+ * @return Status
+ */
+tempo_utils::Status
+zuri_distributor::PackageDatabase::pruneHttpCache(tu_int64 storedBeforeEpochMillis, tu_int64 maxTotalBytes)
+{
+    absl::MutexLock locker(&m_lock);
+
+    sqlite3_bind_int64(m_deleteStaleHttpCacheEntries, 1, storedBeforeEpochMillis);
+    TU_RETURN_IF_NOT_OK (execute_statement(m_db, m_deleteStaleHttpCacheEntries, "deleteStaleHttpCacheEntries"));
+    sqlite3_bind_int64(m_deleteExcessHttpCacheEntries, 1, maxTotalBytes);
+    return execute_statement(m_db, m_deleteExcessHttpCacheEntries, "deleteExcessHttpCacheEntries");
+}
@@ -1,7 +1,15 @@
 
+#include <chrono>
+#include <deque>
+#include <thread>
+
+#include <absl/strings/ascii.h>
+#include <absl/strings/escaping.h>
 #include <curl/curl.h>
+#include <openssl/evp.h>
 
 #include <tempo_utils/file_appender.h>
+#include <tempo_utils/integer_types.h>
 #include <tempo_utils/tempfile_maker.h>
 #include <tempo_utils/uuid.h>
 #include <zuri_distributor/distributor_result.h>
@@ -17,19 +25,31 @@ struct Fetch {
     // config
     tempo_utils::Url url;
     std::string id;
+    std::string expectedDigest;
     Manager *manager = nullptr;
 
     // state
     CURL *handle = nullptr;
     curl_off_t bytesExpected = 0;
     curl_off_t bytesFetched = 0;
+    std::filesystem::path fetchPath;
     std::unique_ptr<tempo_utils::FileAppender> appender;
+    EVP_MD_CTX *digestCtx = nullptr;
+    curl_off_t bytesWritten = 0;
+    curl_off_t resumeOffset = 0;
+    bool responseChecked = false;
+    bool retryable = false;
+    int numAttempts = 0;
+    std::chrono::steady_clock::time_point retryAt;
     tempo_utils::Status status;
 
     ~Fetch() {
         if (handle != nullptr) {
             curl_easy_cleanup(handle);
         }
+        if (digestCtx != nullptr) {
+            EVP_MD_CTX_free(digestCtx);
+        }
     }
 };
 
@@ -40,10 +60,18 @@ struct Manager {
     // config
     std::filesystem::path downloadRoot;
     int pollTimeoutInMs = 100;
+    int maxConcurrentTransfers = 0;
+    int maxRetries = 0;
+    int retryBackoffInMs = 0;
+    int maxRetryBackoffInMs = 0;
+    bool resumePartialTransfers = false;
 
     // state
     CURLM *multi = nullptr;
     absl::flat_hash_map<std::string,std::unique_ptr<Fetch>> fetches;
+    std::deque<Fetch *> queued;
+    std::vector<Fetch *> retrying;
+    int numActive = 0;
     curl_off_t totalBytesExpected = 0;
     curl_off_t totalBytesFetched = 0;
 
@@ -79,9 +107,26 @@ header_callback(char *buffer, size_t size, size_t nitems, void *userdata)
         fetch->status = zuri_distributor::DistributorStatus::forCondition(
             zuri_distributor::DistributorCondition::kDistributorInvariant,
             "encountered {} status code during fetch", response_code);
+        fetch->retryable = response_code == 408 || response_code == 429 || response_code >= 500;
         return CURL_WRITEFUNC_ERROR;
     }
 
+    // if we requested a range but the server sent the entire file, then discard the partial file
+    if (!fetch->responseChecked) {
+        fetch->responseChecked = true;
+        if (fetch->resumeOffset > 0 && response_code == 200) {
+            fetch->appender = std::make_unique<tempo_utils::FileAppender>(
+                fetch->fetchPath, tempo_utils::FileAppenderMode::CREATE_OR_OVERWRITE);
+            fetch->bytesWritten = 0;
+            EVP_DigestInit_ex(fetch->digestCtx, EVP_sha256(), nullptr);
+            if (!fetch->appender->isValid()) {
+                fetch->status = fetch->appender->getStatus();
+                fetch->appender.reset();
+                return CURL_WRITEFUNC_ERROR;
+            }
+        }
+    }
+
     return nitems;
 }
 
@@ -102,8 +147,9 @@ write_callback(char *ptr, size_t size, size_t nmemb, void *userdata)
             fetch->status = fetchFile.getStatus();
             return CURL_WRITEFUNC_ERROR;
         }
+        fetch->fetchPath = fetchFile.getTempfile();
         fetch->appender = std::make_unique<tempo_utils::FileAppender>(
-            fetchFile.getTempfile(), tempo_utils::FileAppenderMode::CREATE_OR_OVERWRITE);
+            fetch->fetchPath, tempo_utils::FileAppenderMode::CREATE_OR_OVERWRITE);
         if (!fetch->appender->isValid()) {
             fetch->status = fetch->appender->getStatus();
             fetch->appender.reset();
@@ -119,6 +165,15 @@ write_callback(char *ptr, size_t size, size_t nmemb, void *userdata)
         fetch->appender.reset();
         return CURL_WRITEFUNC_ERROR;
     }
+    fetch->bytesWritten += nmemb;
+
+    // hash the bytes as they arrive so the digest is available as soon as the transfer completes
+    if (EVP_DigestUpdate(fetch->digestCtx, ptr, nmemb) != 1) {
+        fetch->status = zuri_distributor::DistributorStatus::forCondition(
+            zuri_distributor::DistributorCondition::kDistributorInvariant,
+            "failed to update digest for {}", fetch->url.toString());
+        return CURL_WRITEFUNC_ERROR;
+    }
 
     return nmemb;
 }
@@ -163,6 +218,11 @@ zuri_distributor::PackageFetcher::configure()
 
     auto priv = std::make_unique<Priv>();
     priv->manager.pollTimeoutInMs = m_options.pollTimeoutInMs;
+    priv->manager.maxConcurrentTransfers = m_options.maxConcurrentTransfers;
+    priv->manager.maxRetries = std::max(0, m_options.maxRetries);
+    priv->manager.retryBackoffInMs = std::max(0, m_options.retryBackoffInMs);
+    priv->manager.maxRetryBackoffInMs = std::max(0, m_options.maxRetryBackoffInMs);
+    priv->manager.resumePartialTransfers = m_options.resumePartialTransfers;
 
     // set the download root if given, otherwise default to the current directory
     if (!m_options.downloadRoot.empty()) {
@@ -176,6 +236,9 @@ zuri_distributor::PackageFetcher::configure()
 
     // allocate the multi handle
     priv->manager.multi = curl_multi_init();
+    if (m_options.maxConnectionsPerHost > 0) {
+        curl_multi_setopt(priv->manager.multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long) m_options.maxConnectionsPerHost);
+    }
 
     // configuration succeeded
     m_priv = std::move(priv);
@@ -185,7 +248,8 @@ zuri_distributor::PackageFetcher::configure()
 tempo_utils::Status
 zuri_distributor::PackageFetcher::requestFile(
     const tempo_utils::Url &url,
-    std::string_view id)
+    std::string_view id,
+    std::string_view expectedDigest)
 {
     if (m_priv == nullptr)
         return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
@@ -214,8 +278,14 @@ zuri_distributor::PackageFetcher::requestFile(
     auto fetch = std::make_unique<Fetch>();
     fetch->url = url;
     fetch->id = id;
+    fetch->expectedDigest = absl::AsciiStrToLower(expectedDigest);
     fetch->manager = &m_priv->manager;
 
+    fetch->digestCtx = EVP_MD_CTX_new();
+    if (fetch->digestCtx == nullptr || EVP_DigestInit_ex(fetch->digestCtx, EVP_sha256(), nullptr) != 1)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to initialize digest for {}", url.toString());
+
     fetch->handle = curl_easy_init();
     curl_easy_setopt(fetch->handle, CURLOPT_PRIVATE, fetch.get());
     auto urlString = url.toString();
@@ -230,11 +300,8 @@ zuri_distributor::PackageFetcher::requestFile(
     curl_easy_setopt(fetch->handle, CURLOPT_XFERINFOFUNCTION, progress_callback);
     curl_easy_setopt(fetch->handle, CURLOPT_XFERINFODATA, fetch.get());
 
-    auto ret = curl_multi_add_handle(m_priv->manager.multi, fetch->handle);
-    if (ret != CURLM_OK)
-        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
-            "curl_multi_add_handle failed: {}", curl_multi_strerror(ret));
-
+    // the transfer is started by fetchFiles once there is capacity
+    m_priv->manager.queued.push_back(fetch.get());
     m_priv->manager.fetches[id] = std::move(fetch);
 
     return {};
@@ -249,24 +316,82 @@ zuri_distributor::PackageFetcher::requestFile(const tempo_utils::Url &url)
     return id;
 }
 
-inline tempo_utils::Status
-poll_until_complete(Manager &manager)
+static tempo_utils::Status
+start_transfer(Manager &manager, Fetch *fetch)
 {
-    int stillRunning;
-    do {
-        CURLMcode ret = curl_multi_perform(manager.multi, &stillRunning);
-        if (ret != CURLM_OK)
-            return zuri_distributor::DistributorStatus::forCondition(
-                zuri_distributor::DistributorCondition::kDistributorInvariant,
-                "curl_multi_perform failed: {}", curl_multi_strerror(ret));
-        if (stillRunning) {
-            ret = curl_multi_poll(manager.multi, nullptr, 0, manager.pollTimeoutInMs, nullptr);
-            if (ret != CURLM_OK)
-                return zuri_distributor::DistributorStatus::forCondition(
-                    zuri_distributor::DistributorCondition::kDistributorInvariant,
-                    "curl_multi_poll failed: {}", curl_multi_strerror(ret));
-        }
-    } while (stillRunning);
+    fetch->numAttempts++;
+    fetch->status = {};
+    fetch->retryable = false;
+    fetch->responseChecked = false;
+
+    // if part of the file was already fetched then only request the remaining bytes
+    fetch->resumeOffset = 0;
+    if (manager.resumePartialTransfers && fetch->appender != nullptr) {
+        fetch->resumeOffset = fetch->bytesWritten;
+    } else if (fetch->appender != nullptr) {
+        fetch->appender = std::make_unique<tempo_utils::FileAppender>(
+            fetch->fetchPath, tempo_utils::FileAppenderMode::CREATE_OR_OVERWRITE);
+        fetch->bytesWritten = 0;
+        EVP_DigestInit_ex(fetch->digestCtx, EVP_sha256(), nullptr);
+        TU_RETURN_IF_NOT_OK (fetch->appender->getStatus());
+    }
+    curl_easy_setopt(fetch->handle, CURLOPT_RESUME_FROM_LARGE, fetch->resumeOffset);
+
+    auto ret = curl_multi_add_handle(manager.multi, fetch->handle);
+    if (ret != CURLM_OK)
+        return zuri_distributor::DistributorStatus::forCondition(
+            zuri_distributor::DistributorCondition::kDistributorInvariant,
+            "curl_multi_add_handle failed: {}", curl_multi_strerror(ret));
+    manager.numActive++;
+    return {};
+}
+
+static bool
+is_retryable(CURLcode code)
+{
+    switch (code) {
+        case CURLE_COULDNT_RESOLVE_HOST:
+        case CURLE_COULDNT_CONNECT:
+        case CURLE_PARTIAL_FILE:
+        case CURLE_OPERATION_TIMEDOUT:
+        case CURLE_GOT_NOTHING:
+        case CURLE_SEND_ERROR:
+        case CURLE_RECV_ERROR:
+        case CURLE_HTTP2:
+        case CURLE_HTTP2_STREAM:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void
+discard_file(Fetch *fetch)
+{
+    if (fetch->appender == nullptr)
+        return;
+    fetch->appender.reset();
+    std::error_code ec;
+    std::filesystem::remove(fetch->fetchPath, ec);
+}
+
+static tempo_utils::Status
+verify_digest(Fetch *fetchPtr, zuri_distributor::FetchResult &result)
+{
+    unsigned char md[EVP_MAX_MD_SIZE];
+    unsigned int mdSize = 0;
+    if (EVP_DigestFinal_ex(fetchPtr->digestCtx, md, &mdSize) != 1)
+        return zuri_distributor::DistributorStatus::forCondition(
+            zuri_distributor::DistributorCondition::kDistributorInvariant,
+            "failed to finalize digest for {}", fetchPtr->url.toString());
+    result.digest = absl::BytesToHexString(std::string_view((const char *) md, mdSize));
+
+    if (!fetchPtr->expectedDigest.empty() && fetchPtr->expectedDigest != result.digest)
+        return zuri_distributor::DistributorStatus::forCondition(
+            zuri_distributor::DistributorCondition::kDistributorInvariant,
+            "digest mismatch for {}: expected {} but fetched {}",
+            fetchPtr->url.toString(), fetchPtr->expectedDigest, result.digest);
+
     return {};
 }
 
@@ -276,11 +401,15 @@ rename_file(
     Fetch *fetchPtr,
     zuri_distributor::FetchResult &result)
 {
+    if (fetchPtr->appender == nullptr)
+        return zuri_distributor::DistributorStatus::forCondition(
+            zuri_distributor::DistributorCondition::kDistributorInvariant,
+            "no content was fetched from {}", fetchPtr->url.toString());
     auto fetchPath = fetchPtr->appender->getAbsolutePath();
     std::shared_ptr<zuri_packager::PackageReader> reader;
     TU_ASSIGN_OR_RETURN (reader, zuri_packager::PackageReader::open(fetchPath));
     zuri_packager::PackageSpecifier specifier;
-    TU_ASSIGN_OR_RETURN (specifier, reader->readPackageSpecifier());
+    TU_ASSIGN_OR_RETURN (specifier, reader->getPackageSpecifier());
     auto packagePath = specifier.toPackagePath(downloadRoot);
     std::filesystem::rename(fetchPath, packagePath);
     result.path = packagePath;
@@ -294,32 +423,120 @@ zuri_distributor::PackageFetcher::fetchFiles()
         return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
             "package fetcher is not configured");
 
-    auto pollStatus = poll_until_complete(m_priv->manager);
-
-    CURLMsg *msg;
-    int msgsLeft;
-
-    /* See how the transfers went */
-    while((msg = curl_multi_info_read(m_priv->manager.multi, &msgsLeft)) != nullptr) {
-        if(msg->msg != CURLMSG_DONE)
-            continue;
-
-        char *userdata;
-        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &userdata);
-        auto *fetchPtr = (Fetch *) userdata;
-        if (fetchPtr == nullptr)
-            continue;
+    auto &manager = m_priv->manager;
 
+    auto completeFetch = [&](Fetch *fetchPtr) {
         FetchResult result;
         result.url = fetchPtr->url;
         result.id = fetchPtr->id;
         if (fetchPtr->status.isOk()) {
-            result.status = rename_file(m_priv->manager.downloadRoot, fetchPtr, result);
+            // reject the file before opening it if the contents do not match the expected digest
+            result.status = verify_digest(fetchPtr, result);
+            if (result.status.isOk()) {
+                result.status = rename_file(manager.downloadRoot, fetchPtr, result);
+            }
         } else {
             result.status = fetchPtr->status;
         }
-
+        if (result.status.notOk()) {
+            discard_file(fetchPtr);
+        }
         m_results[fetchPtr->id] = std::move(result);
+    };
+
+    auto startFetch = [&](Fetch *fetchPtr) {
+        auto status = start_transfer(manager, fetchPtr);
+        if (status.notOk()) {
+            fetchPtr->status = status;
+            completeFetch(fetchPtr);
+        }
+    };
+
+    for (;;) {
+        auto now = std::chrono::steady_clock::now();
+
+        // requeue each retrying transfer whose backoff has elapsed
+        for (auto it = manager.retrying.begin(); it != manager.retrying.end();) {
+            if ((*it)->retryAt <= now) {
+                manager.queued.push_back(*it);
+                it = manager.retrying.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        // start queued transfers until the concurrency limit is reached
+        while (!manager.queued.empty()
+            && (manager.maxConcurrentTransfers <= 0 || manager.numActive < manager.maxConcurrentTransfers)) {
+            auto *fetchPtr = manager.queued.front();
+            manager.queued.pop_front();
+            startFetch(fetchPtr);
+        }
+
+        if (manager.numActive == 0 && manager.queued.empty() && manager.retrying.empty())
+            break;
+
+        int stillRunning;
+        CURLMcode ret = curl_multi_perform(manager.multi, &stillRunning);
+        if (ret != CURLM_OK)
+            return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                "curl_multi_perform failed: {}", curl_multi_strerror(ret));
+
+        // process completed transfers
+        CURLMsg *msg;
+        int msgsLeft;
+        while ((msg = curl_multi_info_read(manager.multi, &msgsLeft)) != nullptr) {
+            if (msg->msg != CURLMSG_DONE)
+                continue;
+
+            auto *handle = msg->easy_handle;
+            auto code = msg->data.result;
+            char *userdata;
+            curl_easy_getinfo(handle, CURLINFO_PRIVATE, &userdata);
+            curl_multi_remove_handle(manager.multi, handle);
+            manager.numActive--;
+
+            auto *fetchPtr = (Fetch *) userdata;
+            if (fetchPtr == nullptr)
+                continue;
+
+            if (code != CURLE_OK && fetchPtr->status.isOk()) {
+                fetchPtr->status = DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                    "failed to fetch {}: {}", fetchPtr->url.toString(), curl_easy_strerror(code));
+                fetchPtr->retryable = is_retryable(code);
+            }
+
+            // if the transfer failed with a transient error then schedule a retry with exponential backoff
+            if (fetchPtr->status.notOk() && fetchPtr->retryable && fetchPtr->numAttempts <= manager.maxRetries) {
+                auto backoffInMs = std::min<tu_int64>(
+                    (tu_int64) manager.retryBackoffInMs << std::min(fetchPtr->numAttempts - 1, 20),
+                    manager.maxRetryBackoffInMs);
+                fetchPtr->retryAt = std::chrono::steady_clock::now() + std::chrono::milliseconds(backoffInMs);
+                manager.retrying.push_back(fetchPtr);
+                continue;
+            }
+
+            completeFetch(fetchPtr);
+        }
+
+        // wait for activity, but no longer than the time until the next retry is due
+        int timeoutInMs = manager.pollTimeoutInMs;
+        if (!manager.queued.empty()) {
+            timeoutInMs = 0;
+        }
+        now = std::chrono::steady_clock::now();
+        for (const auto *fetchPtr : manager.retrying) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(fetchPtr->retryAt - now);
+            timeoutInMs = std::clamp<int>(remaining.count(), 0, timeoutInMs);
+        }
+        if (manager.numActive > 0) {
+            ret = curl_multi_poll(manager.multi, nullptr, 0, timeoutInMs, nullptr);
+            if (ret != CURLM_OK)
+                return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                    "curl_multi_poll failed: {}", curl_multi_strerror(ret));
+        } else if (timeoutInMs > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeoutInMs));
+        }
     }
 
     return {};
@@ -1,16 +1,39 @@
 
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/syscall.h>
+#endif
+
 #include <absl/strings/str_split.h>
+#include <absl/synchronization/mutex.h>
 
 #include <tempo_config/config_utils.h>
+#include <tempo_utils/file_reader.h>
 #include <tempo_utils/tempdir_maker.h>
 #include <zuri_distributor/distributor_result.h>
 #include <zuri_distributor/package_store.h>
 #include <zuri_packager/package_extractor.h>
 
-zuri_distributor::PackageStore::PackageStore(const std::filesystem::path &packagesDirectory)
-    : m_packagesDirectory(packagesDirectory)
+zuri_distributor::PackageStore::PackageStore(
+    const std::filesystem::path &packagesDirectory,
+    std::shared_ptr<BlobStore> blobStore,
+    std::shared_ptr<PackageDatabase> packageIndex)
+    : m_packagesDirectory(packagesDirectory),
+      m_blobStore(std::move(blobStore)),
+      m_packageIndex(std::move(packageIndex)),
+      m_generation(0),
+      m_indexVersion(-1),
+      m_indexedGeneration(0)
 {
     TU_ASSERT (!m_packagesDirectory.empty());
+    TU_ASSERT (m_blobStore != nullptr);
+    if (m_packageIndex != nullptr) {
+        m_indexVersion = m_packageIndex->getDataVersion();
+    }
 }
 
 std::filesystem::path
@@ -19,11 +42,91 @@ zuri_distributor::PackageStore::getPackagesDirectory() const
     return m_packagesDirectory;
 }
 
+std::shared_ptr<zuri_distributor::BlobStore>
+zuri_distributor::PackageStore::getBlobStore() const
+{
+    return m_blobStore;
+}
+
+std::shared_ptr<zuri_distributor::PackageDatabase>
+zuri_distributor::PackageStore::getPackageIndex() const
+{
+    return m_packageIndex;
+}
+
+static tempo_utils::Result<std::string>
+read_package_config(const std::filesystem::path &packagePath)
+{
+    tempo_utils::FileReader reader(packagePath / "package.config");
+    if (!reader.isValid())
+        return reader.getStatus();
+    auto bytes = reader.getBytes();
+    return std::string((const char *) bytes->getData(), bytes->getSize());
+}
+
+/**
+ * Look up the specified package in the package index. The result is cached until the generation
+ * changes, so a steady-state lookup does not touch the index.
+ *
+ * @param specifier The package specifier.
+ * @return The indexed package, or an empty option if the package is not installed.
+ */
+tempo_utils::Result<Option<zuri_distributor::PackageStore::IndexedPackage>>
+zuri_distributor::PackageStore::lookupPackage(const zuri_packager::PackageSpecifier &specifier) const
+{
+    TU_ASSERT (m_packageIndex != nullptr);
+    auto generation = m_generation.load();
+
+    // an indexed package whose directory no longer exists, for example because another process
+    // removed it and has not yet committed the removal to the index, is not visible
+    auto verifyIndexed = [](const Option<IndexedPackage> &indexedOption) -> Option<IndexedPackage> {
+        if (indexedOption.isEmpty() || !std::filesystem::is_directory(indexedOption.getValue().path))
+            return {};
+        return indexedOption;
+    };
+
+    {
+        absl::MutexLock locker(&m_lock);
+        if (generation != m_indexedGeneration) {
+            m_indexedPackages.clear();
+            m_indexedGeneration = generation;
+        }
+        auto entry = m_indexedPackages.find(specifier);
+        if (entry != m_indexedPackages.cend())
+            return verifyIndexed(entry->second);
+    }
+
+    Option<InstalledPackage> installedOption;
+    TU_ASSIGN_OR_RETURN (installedOption, m_packageIndex->getInstalledPackage(specifier));
+
+    // a package recorded without its path is not visible until indexPackages() records the path
+    Option<IndexedPackage> indexedOption;
+    if (installedOption.hasValue() && !installedOption.getValue().path.empty()) {
+        const auto &installed = installedOption.getValue();
+        tempo_config::ConfigNode rootNode;
+        TU_ASSIGN_OR_RETURN (rootNode, tempo_config::read_config_string(installed.config));
+        IndexedPackage indexed;
+        indexed.path = installed.path;
+        indexed.config = rootNode.toMap();
+        indexedOption = Option(std::move(indexed));
+    }
+
+    absl::MutexLock locker(&m_lock);
+    if (generation == m_indexedGeneration) {
+        m_indexedPackages[specifier] = indexedOption;
+    }
+    return verifyIndexed(indexedOption);
+}
+
 bool
 zuri_distributor::PackageStore::containsPackage(const zuri_packager::PackageSpecifier &specifier) const
 {
     if (!specifier.isValid())
         return false;
+    if (m_packageIndex != nullptr) {
+        auto lookupPackageResult = lookupPackage(specifier);
+        return lookupPackageResult.isResult() && lookupPackageResult.getResult().hasValue();
+    }
     auto packagePath = specifier.toDirectoryPath(m_packagesDirectory);
     return std::filesystem::is_directory(packagePath);
 }
@@ -31,6 +134,17 @@ zuri_distributor::PackageStore::containsPackage(const zuri_packager::PackageSpec
 tempo_utils::Result<Option<tempo_config::ConfigMap>>
 zuri_distributor::PackageStore::describePackage(const zuri_packager::PackageSpecifier &specifier) const
 {
+    if (m_packageIndex != nullptr) {
+        if (!specifier.isValid())
+            return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                "invalid package specifier");
+        Option<IndexedPackage> indexedOption;
+        TU_ASSIGN_OR_RETURN (indexedOption, lookupPackage(specifier));
+        if (indexedOption.isEmpty())
+            return Option<tempo_config::ConfigMap>{};
+        return Option(indexedOption.getValue().config);
+    }
+
     Option<std::filesystem::path> pathOption;
     TU_ASSIGN_OR_RETURN (pathOption, resolvePackage(specifier));
     if (pathOption.isEmpty())
@@ -48,6 +162,14 @@ zuri_distributor::PackageStore::resolvePackage(const zuri_packager::PackageSpeci
         return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
             "invalid package specifier");
 
+    if (m_packageIndex != nullptr) {
+        Option<IndexedPackage> indexedOption;
+        TU_ASSIGN_OR_RETURN (indexedOption, lookupPackage(specifier));
+        if (indexedOption.isEmpty())
+            return Option<std::filesystem::path>();
+        return Option(indexedOption.getValue().path);
+    }
+
     auto packagePath = specifier.toDirectoryPath(m_packagesDirectory);
     if (!std::filesystem::is_directory(packagePath))
         return Option<std::filesystem::path>();
@@ -55,17 +177,333 @@ zuri_distributor::PackageStore::resolvePackage(const zuri_packager::PackageSpeci
     return Option(packagePath);
 }
 
+tu_uint64
+zuri_distributor::PackageStore::getGeneration() const
+{
+    return m_generation.load();
+}
+
+/**
+ * Check whether packages were installed or removed by another process. If the package store has a
+ * package index then the generation changes only if the index was modified since the last check,
+ * otherwise there is no way to detect a change and the generation always changes.
+ */
+void
+zuri_distributor::PackageStore::invalidate()
+{
+    if (m_packageIndex == nullptr) {
+        m_generation++;
+        return;
+    }
+
+    auto indexVersion = m_packageIndex->getDataVersion();
+    absl::MutexLock locker(&m_lock);
+    if (indexVersion != m_indexVersion) {
+        m_indexVersion = indexVersion;
+        m_generation++;
+    }
+}
+
+/**
+ * Record the path and config of each package in the packages directory which is missing from the
+ * package index, such as packages installed before the index recorded install paths. This is a
+ * one-time migration: once it completes the index is marked with kIndexedPackagesSchemaVersion and
+ * subsequent calls return without scanning the packages directory. The caller must ensure that no
+ * package is installed or removed while the migration runs.
+ *
+ * @return Status
+ */
+tempo_utils::Status
+zuri_distributor::PackageStore::indexPackages()
+{
+    if (m_packageIndex == nullptr)
+        return {};
+    if (m_packageIndex->getSchemaVersion() >= kIndexedPackagesSchemaVersion)
+        return {};
+
+    int numIndexed = 0;
+    TU_RETURN_IF_NOT_OK (m_packageIndex->beginTransaction());
+    auto recordPackages = [&]() -> tempo_utils::Status {
+        // another process may have completed the migration before the transaction began
+        if (m_packageIndex->getSchemaVersion() >= kIndexedPackagesSchemaVersion)
+            return {};
+        std::error_code ec;
+        for (const auto &entry : std::filesystem::directory_iterator(m_packagesDirectory, ec)) {
+            // skip the blobs, locks, and staging directories
+            auto filename = entry.path().filename();
+            if (!entry.is_directory() || filename.string().starts_with("."))
+                continue;
+            auto specifier = zuri_packager::PackageSpecifier::fromFilesystemName(filename);
+            if (!specifier.isValid())
+                continue;
+            Option<InstalledPackage> installedOption;
+            TU_ASSIGN_OR_RETURN (installedOption, m_packageIndex->getInstalledPackage(specifier));
+            if (installedOption.hasValue() && !installedOption.getValue().path.empty())
+                continue;
+            std::string sha256;
+            if (installedOption.hasValue()) {
+                sha256 = installedOption.getValue().sha256;
+            }
+            // a package which cannot be read is left unindexed rather than failing the migration
+            auto readPackageConfigResult = read_package_config(entry.path());
+            if (readPackageConfigResult.isStatus()) {
+                TU_LOG_WARN << "failed to index package " << entry.path() << ": "
+                    << readPackageConfigResult.getStatus();
+                continue;
+            }
+            TU_RETURN_IF_NOT_OK (m_packageIndex->putPackage(
+                specifier, sha256, entry.path(), readPackageConfigResult.getResult()));
+            numIndexed++;
+        }
+        if (ec)
+            return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                "failed to index packages in {}: {}", m_packagesDirectory.string(), ec.message());
+        return m_packageIndex->setSchemaVersion(kIndexedPackagesSchemaVersion);
+    };
+    auto status = recordPackages();
+    if (status.notOk()) {
+        TU_LOG_WARN_IF (m_packageIndex->rollbackTransaction().notOk()) << "failed to roll back package index";
+        return status;
+    }
+    TU_RETURN_IF_NOT_OK (m_packageIndex->commitTransaction());
+    if (numIndexed > 0) {
+        m_generation++;
+    }
+    return {};
+}
+
 tempo_utils::Result<std::filesystem::path>
 zuri_distributor::PackageStore::installPackage(std::shared_ptr<zuri_packager::PackageReader> reader)
 {
     zuri_packager::PackageExtractorOptions options;
     options.workingRoot = m_packagesDirectory;
     options.destinationRoot = m_packagesDirectory;
+    options.numWorkers = 0;
+    options.materializer = m_blobStore;
+    zuri_packager::PackageExtractor extractor(reader, options);
+    TU_RETURN_IF_NOT_OK (extractor.configure());
+    std::filesystem::path packagePath;
+    TU_ASSIGN_OR_RETURN (packagePath, extractor.extractPackage());
+
+    if (m_packageIndex != nullptr) {
+        zuri_packager::PackageSpecifier specifier;
+        TU_ASSIGN_OR_RETURN (specifier, reader->getPackageSpecifier());
+        std::string packageConfig;
+        TU_ASSIGN_OR_RETURN (packageConfig, read_package_config(packagePath));
+        TU_RETURN_IF_NOT_OK (m_packageIndex->putPackage(specifier, {}, packagePath, packageConfig));
+    }
+
+    // change the generation only once the package is indexed, so a concurrent lookup cannot
+    // cache the package as missing under the new generation
+    m_generation++;
+    return packagePath;
+}
+
+/**
+ * Materializes files from the blob store and records the path and digest of each file written.
+ */
+class StagingMaterializer : public zuri_packager::AbstractFileMaterializer {
+public:
+    explicit StagingMaterializer(std::shared_ptr<zuri_distributor::BlobStore> blobStore)
+        : m_blobStore(std::move(blobStore))
+    {
+    }
+
+    tempo_utils::Status materializeFile(
+        const tempo_utils::Slice &contents,
+        const std::filesystem::path &filePath) override
+    {
+        std::string digest;
+        TU_ASSIGN_OR_RETURN (digest, m_blobStore->storeFile(contents, filePath));
+        absl::MutexLock locker(&m_lock);
+        m_files.emplace_back(filePath, std::move(digest));
+        return {};
+    }
+
+    std::vector<std::pair<std::filesystem::path,std::string>> takeFiles()
+    {
+        absl::MutexLock locker(&m_lock);
+        return std::move(m_files);
+    }
+
+private:
+    std::shared_ptr<zuri_distributor::BlobStore> m_blobStore;
+    absl::Mutex m_lock;
+    std::vector<std::pair<std::filesystem::path,std::string>> m_files ABSL_GUARDED_BY(m_lock);
+};
+
+/**
+ * Extract the package into the staging directory. The package is not visible in the package store
+ * until it is published with publishPackage().
+ *
+ * @param reader The package to stage.
+ * @param stagingDirectory The directory to extract the package into. The directory must be on the
+ *     same filesystem as the packages directory so the package can be published with a rename.
+ * @param numWorkers The number of threads used to write file contents, as for PackageExtractorOptions.
+ * @return The staged package.
+ */
+tempo_utils::Result<zuri_distributor::StagedPackage>
+zuri_distributor::PackageStore::stagePackage(
+    std::shared_ptr<zuri_packager::PackageReader> reader,
+    const std::filesystem::path &stagingDirectory,
+    int numWorkers)
+{
+    auto materializer = std::make_shared<StagingMaterializer>(m_blobStore);
+
+    zuri_packager::PackageExtractorOptions options;
+    options.workingRoot = stagingDirectory;
+    options.destinationRoot = stagingDirectory;
+    options.numWorkers = numWorkers;
+    options.materializer = materializer;
     zuri_packager::PackageExtractor extractor(reader, options);
     TU_RETURN_IF_NOT_OK (extractor.configure());
-    return extractor.extractPackage();
+
+    StagedPackage stagedPackage;
+    TU_ASSIGN_OR_RETURN (stagedPackage.specifier, reader->getPackageSpecifier());
+    TU_ASSIGN_OR_RETURN (stagedPackage.stagedPath, extractor.extractPackage());
+    TU_ASSIGN_OR_RETURN (stagedPackage.config, read_package_config(stagedPackage.stagedPath));
+
+    // files are written into the extractor working directory before it is renamed to the staged
+    // path, so strip the working directory name from each recorded path
+    for (auto &file : materializer->takeFiles()) {
+        auto relativePath = file.first.lexically_relative(stagingDirectory);
+        std::filesystem::path packagePath("/");
+        for (auto it = std::next(relativePath.begin()); it != relativePath.end(); ++it) {
+            packagePath /= *it;
+        }
+        stagedPackage.files.push_back({packagePath.generic_string(), std::move(file.second)});
+    }
+
+    return stagedPackage;
+}
+
+/**
+ * Atomically exchange the two directories, so that a reader resolving either path observes either
+ * the old or the new contents and never a missing directory. If the platform does not support an
+ * atomic exchange then the directories are swapped with three renames, which leaves a short window
+ * in which the destination path does not exist.
+ */
+static tempo_utils::Status
+exchange_directories(const std::filesystem::path &source, const std::filesystem::path &destination)
+{
+#if defined(__linux__) && defined(SYS_renameat2)
+    auto ret = ::syscall(SYS_renameat2, AT_FDCWD, source.c_str(), AT_FDCWD, destination.c_str(), RENAME_EXCHANGE);
+    if (ret == 0)
+        return {};
+    if (errno != EINVAL && errno != ENOSYS)
+        return zuri_distributor::DistributorStatus::forCondition(
+            zuri_distributor::DistributorCondition::kDistributorInvariant,
+            "failed to exchange {} with {}: {}", source.string(), destination.string(), std::strerror(errno));
+#endif
+
+    std::error_code ec;
+    auto intermediate = source;
+    intermediate += ".exchange";
+    std::filesystem::rename(destination, intermediate, ec);
+    if (!ec) {
+        std::filesystem::rename(source, destination, ec);
+        if (ec) {
+            std::error_code ignored;
+            std::filesystem::rename(intermediate, destination, ignored);
+        } else {
+            std::filesystem::rename(intermediate, source, ec);
+        }
+    }
+    if (ec)
+        return zuri_distributor::DistributorStatus::forCondition(
+            zuri_distributor::DistributorCondition::kDistributorInvariant,
+            "failed to exchange {} with {}: {}", source.string(), destination.string(), ec.message());
+    return {};
+}
+
+/**
+ * Move a staged package into the packages directory, making it visible in the package store. If
+ * replaceExisting is true and the package is already installed, then the installed package is
+ * atomically exchanged with the staged package and its previous contents are moved to the staged
+ * path, where they remain until finishPublish() or revertPublish() is called.
+ *
+ * @param stagedPackage The staged package.
+ * @param replaceExisting Whether to replace an existing installation of the package.
+ * @return The published package.
+ */
+tempo_utils::Result<zuri_distributor::PublishedPackage>
+zuri_distributor::PackageStore::publishPackage(const StagedPackage &stagedPackage, bool replaceExisting)
+{
+    PublishedPackage publishedPackage;
+    publishedPackage.specifier = stagedPackage.specifier;
+    publishedPackage.packagePath = stagedPackage.specifier.toDirectoryPath(m_packagesDirectory);
+
+    if (replaceExisting && std::filesystem::is_directory(publishedPackage.packagePath)) {
+        TU_RETURN_IF_NOT_OK (exchange_directories(stagedPackage.stagedPath, publishedPackage.packagePath));
+        publishedPackage.retiredPath = stagedPackage.stagedPath;
+    } else {
+        std::error_code ec;
+        std::filesystem::rename(stagedPackage.stagedPath, publishedPackage.packagePath, ec);
+        if (ec)
+            return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                "failed to publish package {}: {}", publishedPackage.packagePath.string(), ec.message());
+    }
+
+    m_generation++;
+    return publishedPackage;
+}
+
+/**
+ * Discard the previous contents of a package replaced by publishPackage().
+ *
+ * @param publishedPackage The published package.
+ * @return Status
+ */
+tempo_utils::Status
+zuri_distributor::PackageStore::finishPublish(const PublishedPackage &publishedPackage)
+{
+    if (publishedPackage.retiredPath.empty())
+        return {};
+
+    std::error_code ec;
+    std::filesystem::remove_all(publishedPackage.retiredPath, ec);
+    if (ec)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to remove retired package {}: {}",
+            publishedPackage.retiredPath.string(), ec.message());
+
+    // release blobs which were only referenced by the retired package
+    TU_RETURN_IF_STATUS (m_blobStore->pruneBlobs(publishedPackage.retiredDigests));
+    return {};
 }
 
+/**
+ * Undo publishPackage(), restoring the previous contents of a replaced package or removing a newly
+ * published package.
+ *
+ * @param publishedPackage The published package.
+ * @return Status
+ */
+tempo_utils::Status
+zuri_distributor::PackageStore::revertPublish(const PublishedPackage &publishedPackage)
+{
+    std::error_code ec;
+    if (!publishedPackage.retiredPath.empty()) {
+        TU_RETURN_IF_NOT_OK (exchange_directories(publishedPackage.retiredPath, publishedPackage.packagePath));
+        std::filesystem::remove_all(publishedPackage.retiredPath, ec);
+    } else {
+        std::filesystem::remove_all(publishedPackage.packagePath, ec);
+    }
+    m_generation++;
+    if (ec)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to revert package {}: {}", publishedPackage.packagePath.string(), ec.message());
+    return {};
+}
+
+/**
+ * Remove the specified package. The package is first removed from the package index in a single
+ * transaction, so it is no longer resolvable once its files start being removed, and then its
+ * directory is removed and the blobs which were only referenced by the package are pruned.
+ *
+ * @param specifier The package specifier.
+ * @return Status
+ */
 tempo_utils::Status
 zuri_distributor::PackageStore::removePackage(const zuri_packager::PackageSpecifier &specifier)
 {
@@ -74,20 +512,43 @@ zuri_distributor::PackageStore::removePackage(const zuri_packager::PackageSpecif
         return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
             "missing package {}", absolutePath.string());
 
+    // determine the blobs referenced by the package before its file rows are removed
+    std::vector<std::string> digests;
+    if (m_packageIndex != nullptr) {
+        TU_RETURN_IF_NOT_OK (m_packageIndex->beginTransaction());
+        auto removeFromIndex = [&]() -> tempo_utils::Status {
+            TU_ASSIGN_OR_RETURN (digests, m_packageIndex->getPackageFileDigests(specifier));
+            return m_packageIndex->removePackage(specifier);
+        };
+        auto status = removeFromIndex();
+        if (status.notOk()) {
+            TU_LOG_WARN_IF (m_packageIndex->rollbackTransaction().notOk()) << "failed to roll back remove";
+            return status;
+        }
+        TU_RETURN_IF_NOT_OK (m_packageIndex->commitTransaction());
+    }
+
     std::error_code ec;
-    if (!std::filesystem::remove_all(absolutePath, ec))
+    std::filesystem::remove_all(absolutePath, ec);
+    m_generation++;
+    if (ec)
         return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
             "failed to remove package {}: {}",
             absolutePath.string(), ec.message());
 
+    // release blobs which were only referenced by the removed package
+    TU_RETURN_IF_STATUS (m_blobStore->pruneBlobs(digests));
+
     return {};
 }
 
 tempo_utils::Result<std::shared_ptr<zuri_distributor::PackageStore>>
-zuri_distributor::PackageStore::openOrCreate(const std::filesystem::path &packagesDirectory)
+zuri_distributor::PackageStore::openOrCreate(
+    const std::filesystem::path &packagesDirectory,
+    std::shared_ptr<PackageDatabase> packageIndex)
 {
     if (std::filesystem::exists(packagesDirectory))
-        return open(packagesDirectory);
+        return open(packagesDirectory, packageIndex);
 
     std::error_code ec;
     std::filesystem::create_directory(packagesDirectory, ec);
@@ -95,15 +556,20 @@ zuri_distributor::PackageStore::openOrCreate(const std::filesystem::path &packag
         return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
             "failed to create packages directory {}: {}", packagesDirectory.string(), ec.message());
 
-    return std::shared_ptr<PackageStore>(new PackageStore(packagesDirectory));
+    return open(packagesDirectory, packageIndex);
 }
 
 tempo_utils::Result<std::shared_ptr<zuri_distributor::PackageStore>>
-zuri_distributor::PackageStore::open(const std::filesystem::path &packagesDirectory)
+zuri_distributor::PackageStore::open(
+    const std::filesystem::path &packagesDirectory,
+    std::shared_ptr<PackageDatabase> packageIndex)
 {
     if (!std::filesystem::is_directory(packagesDirectory))
         return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
             "packages directory {} does not exist", packagesDirectory.string());
 
-    return std::shared_ptr<PackageStore>(new PackageStore(packagesDirectory));
+    std::shared_ptr<BlobStore> blobStore;
+    TU_ASSIGN_OR_RETURN (blobStore, BlobStore::openOrCreate(packagesDirectory / kBlobsDirectoryName));
+
+    return std::shared_ptr<PackageStore>(new PackageStore(packagesDirectory, blobStore, packageIndex));
 }
\ No newline at end of file
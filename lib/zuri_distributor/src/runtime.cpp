@@ -1,4 +1,10 @@
 
+#include <algorithm>
+#include <thread>
+
+#include <absl/synchronization/mutex.h>
+
+#include <tempo_utils/tempdir_maker.h>
 #include <zuri_distributor/distributor_result.h>
 #include <zuri_distributor/runtime.h>
 
@@ -103,7 +109,7 @@ zuri_distributor::Runtime::openOrCreate(
             "failed to create runtime packages directory {}", packagesDirectory.string());
 
     std::shared_ptr<PackageStore> packageStore;
-    TU_ASSIGN_OR_RETURN (packageStore, PackageStore::openOrCreate(packagesDirectory));
+    TU_ASSIGN_OR_RETURN (packageStore, PackageStore::openOrCreate(packagesDirectory, packageDatabase));
 
     auto runtime = std::shared_ptr<Runtime>(
         new Runtime(packageDatabase, binDirectory, libDirectory, packageStore));
@@ -143,7 +149,7 @@ zuri_distributor::Runtime::open(const std::filesystem::path &runtimeRoot)
     TU_ASSIGN_OR_RETURN (packageDatabase, PackageDatabase::open(packageDatabaseFile));
 
     std::shared_ptr<PackageStore> packageStore;
-    TU_ASSIGN_OR_RETURN (packageStore, PackageStore::open(packagesDirectory));
+    TU_ASSIGN_OR_RETURN (packageStore, PackageStore::open(packagesDirectory, packageDatabase));
 
     auto runtime = std::shared_ptr<Runtime>(
         new Runtime(packageDatabase, binDirectory, libDirectory, packageStore));
@@ -157,7 +163,18 @@ zuri_distributor::Runtime::configure()
 {
     m_loader = std::make_shared<PackageCacheLoader>(m_packageStore);
 
-    return {};
+    // if the index is already migrated then there is nothing else to do
+    if (m_packageDatabase->getSchemaVersion() >= kIndexedPackagesSchemaVersion)
+        return {};
+
+    // otherwise record packages installed before the index recorded install paths, so lookups never
+    // need to fall back to the packages directory. the exclusive runtime lock excludes every install
+    // and remove, as they hold the shared runtime lock while holding their package locks.
+    std::shared_ptr<FileLock> runtimeLock;
+    TU_ASSIGN_OR_RETURN (runtimeLock, FileLock::acquire(
+        getPackagesDatabaseFile().parent_path() / kRuntimeLockName, FileLockMode::Exclusive));
+    absl::MutexLock transactionLocker(&m_transactionLock);
+    return m_packageStore->indexPackages();
 }
 
 std::filesystem::path
@@ -166,6 +183,12 @@ zuri_distributor::Runtime::getPackagesDatabaseFile() const
     return m_packageDatabase->getDatabaseFilePath();
 }
 
+std::shared_ptr<zuri_distributor::PackageDatabase>
+zuri_distributor::Runtime::getPackageDatabase() const
+{
+    return m_packageDatabase;
+}
+
 std::filesystem::path
 zuri_distributor::Runtime::getBinDirectory() const
 {
@@ -204,7 +227,7 @@ zuri_distributor::Runtime::containsPackage(std::shared_ptr<zuri_packager::Packag
 {
     if (reader == nullptr)
         return false;
-    auto result = reader->readPackageSpecifier();
+    auto result = reader->getPackageSpecifier();
     if (result.isStatus())
         return false;
     return containsPackage(result.getResult());
@@ -229,29 +252,327 @@ zuri_distributor::Runtime::resolvePackage(const zuri_packager::PackageSpecifier
 }
 
 tempo_utils::Result<std::filesystem::path>
-zuri_distributor::Runtime::installPackage(const std::filesystem::path &packagePath)
+zuri_distributor::Runtime::installPackage(
+    const std::filesystem::path &packagePath,
+    std::string_view sha256)
 {
     std::shared_ptr<zuri_packager::PackageReader> reader;
     TU_ASSIGN_OR_RETURN (reader, zuri_packager::PackageReader::open(packagePath));
-    return installPackage(reader);
+    return installPackage(reader, sha256);
 }
 
 tempo_utils::Result<std::filesystem::path>
-zuri_distributor::Runtime::installPackage(std::shared_ptr<zuri_packager::PackageReader> reader)
+zuri_distributor::Runtime::installPackage(
+    std::shared_ptr<zuri_packager::PackageReader> reader,
+    std::string_view sha256,
+    const RuntimeInstallOptions &options)
+{
+    RuntimeInstallable installable;
+    installable.reader = std::move(reader);
+    installable.sha256 = std::string(sha256);
+
+    std::vector<std::filesystem::path> packagePaths;
+    TU_ASSIGN_OR_RETURN (packagePaths, installPackages(
+        std::span<const RuntimeInstallable>(&installable, 1), options));
+    return packagePaths.front();
+}
+
+tempo_utils::Result<std::vector<std::filesystem::path>>
+zuri_distributor::Runtime::installPackages(std::span<const std::shared_ptr<zuri_packager::PackageReader>> readers)
+{
+    std::vector<RuntimeInstallable> installables;
+    for (const auto &reader : readers) {
+        RuntimeInstallable installable;
+        installable.reader = reader;
+        installables.push_back(std::move(installable));
+    }
+    return installPackages(installables);
+}
+
+/**
+ * Install the specified packages as a single unit. Packages are extracted in parallel into a
+ * staging directory, every package and file is recorded in the package database in a single
+ * transaction, and then the staged packages are moved into the packages directory. If any step
+ * fails then no package is installed.
+ *
+ * Installs hold a shared lock on the runtime lock file, so installs of different packages may
+ * proceed concurrently (including from other processes), and an exclusive lock on each installed
+ * package, acquired in specifier order. Readers take no locks; a package replaced by the install is
+ * atomically exchanged with its new contents. If skipUnchanged is set then packages whose installed
+ * digest matches the installable digest are not reinstalled.
+ *
+ * @param installables The packages to install.
+ * @param options The install options.
+ * @return The paths of the installed packages, in the same order as the installables.
+ */
+tempo_utils::Result<std::vector<std::filesystem::path>>
+zuri_distributor::Runtime::installPackages(
+    std::span<const RuntimeInstallable> installables,
+    const RuntimeInstallOptions &options)
 {
-    std::filesystem::path packageRoot;
-    TU_ASSIGN_OR_RETURN (packageRoot, m_packageStore->installPackage(reader));
-    auto packageRuntimeLibLink = packageRoot / "runtime-lib";
+    if (installables.empty())
+        return std::vector<std::filesystem::path>{};
+
+    std::vector<zuri_packager::PackageSpecifier> installSpecifiers;
+    absl::flat_hash_set<zuri_packager::PackageSpecifier> specifiers;
+    for (const auto &installable : installables) {
+        if (installable.reader == nullptr)
+            return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                "invalid package reader");
+        zuri_packager::PackageSpecifier specifier;
+        TU_ASSIGN_OR_RETURN (specifier, installable.reader->getPackageSpecifier());
+        if (specifiers.contains(specifier))
+            return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                "package {} is specified more than once", specifier.toString());
+        specifiers.insert(specifier);
+        installSpecifiers.push_back(specifier);
+    }
+
+    std::vector<std::shared_ptr<FileLock>> locks;
+    TU_ASSIGN_OR_RETURN (locks, lockPackages(specifiers));
+
+    // observe any packages installed or removed by other processes before comparing digests
+    m_packageStore->invalidate();
+
+    // determine which packages must be installed. the digest comparison is made while holding the
+    // package locks so the installed package cannot change underneath us.
+    std::vector<std::filesystem::path> packagePaths(installables.size());
+    std::vector<size_t> pendingIndices;
+    std::vector<RuntimeInstallable> pendingInstallables;
+    for (size_t i = 0; i < installables.size(); i++) {
+        const auto &installable = installables[i];
+        const auto &specifier = installSpecifiers[i];
+        if (options.skipUnchanged && !installable.sha256.empty() && m_packageStore->containsPackage(specifier)) {
+            Option<std::string> digestOption;
+            TU_ASSIGN_OR_RETURN (digestOption, m_packageDatabase->getPackageDigest(specifier));
+            if (digestOption.hasValue() && digestOption.getValue() == installable.sha256) {
+                packagePaths[i] = specifier.toDirectoryPath(getPackagesDirectory());
+                TU_LOG_V << "package " << specifier.toString() << " is unchanged, skipping install";
+                continue;
+            }
+        }
+        pendingIndices.push_back(i);
+        pendingInstallables.push_back(installable);
+    }
+    if (pendingInstallables.empty())
+        return packagePaths;
+
+    // the staging directory must be within the packages directory so staged packages can be renamed into place
+    tempo_utils::TempdirMaker stagingMaker(m_packageStore->getPackagesDirectory(), ".staging.XXXXXXXX");
+    TU_RETURN_IF_NOT_OK (stagingMaker.getStatus());
+    auto stagingDirectory = stagingMaker.getTempdir();
+
+    auto installResult = installStagedPackages(pendingInstallables, stagingDirectory, options);
+
     std::error_code ec;
-    std::filesystem::create_directory_symlink(m_libDirectory, packageRuntimeLibLink, ec);
-    if (ec)
-        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
-            "failed to create runtime-lib link in {}; {}", packageRoot.string(), ec.message());
-    return packageRoot;
+    std::filesystem::remove_all(stagingDirectory, ec);
+    TU_LOG_WARN_IF (ec) << "failed to remove staging directory " << stagingDirectory << ": " << ec.message();
+
+    if (installResult.isStatus())
+        return installResult.getStatus();
+    auto installedPaths = installResult.getResult();
+    for (size_t i = 0; i < pendingIndices.size(); i++) {
+        packagePaths[pendingIndices[i]] = installedPaths[i];
+    }
+    return packagePaths;
+}
+
+tempo_utils::Result<std::vector<std::filesystem::path>>
+zuri_distributor::Runtime::installStagedPackages(
+    std::span<const RuntimeInstallable> installables,
+    const std::filesystem::path &stagingDirectory,
+    const RuntimeInstallOptions &options)
+{
+    std::vector<StagedPackage> stagedPackages(installables.size());
+
+    // extract each package into the staging directory. packages are extracted in parallel, unless
+    // there is only one package in which case its files are written in parallel instead.
+    int numWorkers = std::max(1u, std::thread::hardware_concurrency());
+    numWorkers = std::min<int>(numWorkers, installables.size());
+    int numFileWorkers = installables.size() == 1? 0 : 1;
+
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    absl::Mutex lock;
+    tempo_utils::Status firstError;
+
+    auto work = [&]() {
+        while (!failed.load()) {
+            auto index = next.fetch_add(1);
+            if (index >= installables.size())
+                return;
+            auto stagePackageResult = m_packageStore->stagePackage(
+                installables[index].reader, stagingDirectory, numFileWorkers);
+            tempo_utils::Status status;
+            if (stagePackageResult.isResult()) {
+                auto stagedPackage = stagePackageResult.getResult();
+                std::error_code ec;
+                std::filesystem::create_directory_symlink(
+                    m_libDirectory, stagedPackage.stagedPath / "runtime-lib", ec);
+                if (ec) {
+                    status = DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+                        "failed to create runtime-lib link in {}; {}",
+                        stagedPackage.stagedPath.string(), ec.message());
+                } else {
+                    stagedPackages[index] = std::move(stagedPackage);
+                }
+            } else {
+                status = stagePackageResult.getStatus();
+            }
+            if (status.notOk()) {
+                absl::MutexLock locker(&lock);
+                if (!failed.exchange(true)) {
+                    firstError = status;
+                }
+            }
+        }
+    };
+
+    if (numWorkers <= 1) {
+        work();
+    } else {
+        std::vector<std::thread> workers;
+        for (int i = 0; i < numWorkers; i++) {
+            workers.emplace_back(work);
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+    }
+    TU_RETURN_IF_NOT_OK (firstError);
+
+    // record every package and file in a single transaction
+    std::vector<std::vector<std::string>> retiredDigests(installables.size());
+    absl::MutexLock transactionLocker(&m_transactionLock);
+    TU_RETURN_IF_NOT_OK (m_packageDatabase->beginTransaction());
+    auto recordPackages = [&]() -> tempo_utils::Status {
+        for (size_t i = 0; i < installables.size(); i++) {
+            const auto &stagedPackage = stagedPackages[i];
+            // drop the file rows of a replaced package, remembering its blobs so they can be pruned
+            if (options.replaceExisting) {
+                TU_ASSIGN_OR_RETURN (retiredDigests[i],
+                    m_packageDatabase->getPackageFileDigests(stagedPackage.specifier));
+                TU_RETURN_IF_NOT_OK (m_packageDatabase->removePackage(stagedPackage.specifier));
+            }
+            auto packagePath = stagedPackage.specifier.toDirectoryPath(getPackagesDirectory());
+            TU_RETURN_IF_NOT_OK (m_packageDatabase->putPackage(
+                stagedPackage.specifier, installables[i].sha256, packagePath, stagedPackage.config));
+            for (const auto &file : stagedPackage.files) {
+                TU_RETURN_IF_NOT_OK (m_packageDatabase->putPackageFile(
+                    stagedPackage.specifier, file.path, file.sha256));
+            }
+        }
+        return {};
+    };
+    auto status = recordPackages();
+    if (status.notOk()) {
+        TU_LOG_WARN_IF (m_packageDatabase->rollbackTransaction().notOk()) << "failed to roll back install";
+        return status;
+    }
+
+    // move the staged packages into place. if a package cannot be moved then revert the packages
+    // which were already moved and abandon the transaction, so that nothing is installed.
+    std::vector<PublishedPackage> publishedPackages;
+    auto revertPackages = [&]() {
+        for (auto it = publishedPackages.crbegin(); it != publishedPackages.crend(); ++it) {
+            auto revertStatus = m_packageStore->revertPublish(*it);
+            TU_LOG_WARN_IF (revertStatus.notOk()) << "failed to revert install: " << revertStatus;
+        }
+        TU_LOG_WARN_IF (m_packageDatabase->rollbackTransaction().notOk()) << "failed to roll back install";
+    };
+    for (size_t i = 0; i < stagedPackages.size(); i++) {
+        auto publishPackageResult = m_packageStore->publishPackage(stagedPackages[i], options.replaceExisting);
+        if (publishPackageResult.isStatus()) {
+            revertPackages();
+            return publishPackageResult.getStatus();
+        }
+        auto publishedPackage = publishPackageResult.getResult();
+        if (!publishedPackage.retiredPath.empty()) {
+            publishedPackage.retiredDigests = std::move(retiredDigests[i]);
+        }
+        publishedPackages.push_back(std::move(publishedPackage));
+    }
+
+    status = m_packageDatabase->commitTransaction();
+    if (status.notOk()) {
+        revertPackages();
+        return status;
+    }
+
+    // discard the previous contents of any replaced packages
+    std::vector<std::filesystem::path> packagePaths;
+    for (const auto &publishedPackage : publishedPackages) {
+        auto finishStatus = m_packageStore->finishPublish(publishedPackage);
+        TU_LOG_WARN_IF (finishStatus.notOk()) << "failed to clean up install: " << finishStatus;
+        TU_LOG_V << "installed package " << publishedPackage.packagePath;
+        packagePaths.push_back(publishedPackage.packagePath);
+    }
+    return packagePaths;
 }
 
 tempo_utils::Status
 zuri_distributor::Runtime::removePackage(const zuri_packager::PackageSpecifier &specifier)
 {
+    std::vector<std::shared_ptr<FileLock>> locks;
+    TU_ASSIGN_OR_RETURN (locks, lockPackages({specifier}));
+    m_packageStore->invalidate();
+    absl::MutexLock transactionLocker(&m_transactionLock);
     return m_packageStore->removePackage(specifier);
+}
+
+/**
+ * Remove every blob which is not referenced by an installed package. Installs and removes prune the
+ * blobs of the packages they replace or remove, so this is only needed to reclaim blobs which those
+ * could not attribute to a package, such as the blobs of packages installed before their files were
+ * recorded. The exclusive runtime lock is held for the duration, so no install can observe a blob
+ * being pruned between storing and linking it.
+ *
+ * @return The number of blobs removed.
+ */
+tempo_utils::Result<int>
+zuri_distributor::Runtime::pruneUnreferencedBlobs()
+{
+    std::shared_ptr<FileLock> runtimeLock;
+    TU_ASSIGN_OR_RETURN (runtimeLock, FileLock::acquire(
+        getPackagesDatabaseFile().parent_path() / kRuntimeLockName, FileLockMode::Exclusive));
+    return m_packageStore->getBlobStore()->pruneUnreferencedBlobs();
+}
+
+/**
+ * Acquire a shared lock on the runtime and an exclusive lock on each of the specified packages.
+ * Package locks are always acquired in specifier order so that concurrent installs of overlapping
+ * sets of packages cannot deadlock.
+ *
+ * @param specifiers The packages to lock.
+ * @return The held locks, which are released when destroyed.
+ */
+tempo_utils::Result<std::vector<std::shared_ptr<zuri_distributor::FileLock>>>
+zuri_distributor::Runtime::lockPackages(
+    const absl::flat_hash_set<zuri_packager::PackageSpecifier> &specifiers) const
+{
+    std::vector<std::shared_ptr<FileLock>> locks;
+
+    std::shared_ptr<FileLock> runtimeLock;
+    TU_ASSIGN_OR_RETURN (runtimeLock, FileLock::acquire(
+        getPackagesDatabaseFile().parent_path() / kRuntimeLockName, FileLockMode::Shared));
+    locks.push_back(std::move(runtimeLock));
+
+    auto locksDirectory = getPackagesDirectory() / kPackageLocksDirectoryName;
+    std::error_code ec;
+    std::filesystem::create_directories(locksDirectory, ec);
+    if (ec)
+        return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
+            "failed to create package locks directory {}: {}", locksDirectory.string(), ec.message());
+
+    std::vector<zuri_packager::PackageSpecifier> ordered(specifiers.cbegin(), specifiers.cend());
+    std::sort(ordered.begin(), ordered.end());
+    for (const auto &specifier : ordered) {
+        auto lockPath = specifier.toDirectoryPath(locksDirectory);
+        lockPath += ".lock";
+        std::shared_ptr<FileLock> packageLock;
+        TU_ASSIGN_OR_RETURN (packageLock, FileLock::acquire(lockPath, FileLockMode::Exclusive));
+        locks.push_back(std::move(packageLock));
+    }
+
+    return locks;
 }
\ No newline at end of file
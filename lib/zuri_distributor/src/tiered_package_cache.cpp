@@ -9,7 +9,8 @@
 
 zuri_distributor::TieredPackageCache::TieredPackageCache(
     const std::vector<std::shared_ptr<AbstractPackageCache>> &packageCaches)
-    : m_packageCaches(packageCaches)
+    : m_packageCaches(packageCaches),
+      m_resolvedGeneration(0)
 {
     TU_ASSERT (!m_packageCaches.empty());
 }
@@ -19,11 +20,10 @@ zuri_distributor::TieredPackageCache::containsPackage(const zuri_packager::Packa
 {
     if (!specifier.isValid())
         return false;
-    for (const auto &packageCache : m_packageCaches) {
-        if (packageCache->containsPackage(specifier))
-            return true;
-    }
-    return false;
+    auto resolvePackageResult = resolvePackage(specifier);
+    if (resolvePackageResult.isStatus())
+        return false;
+    return resolvePackageResult.getResult().hasValue();
 }
 
 tempo_utils::Result<Option<tempo_config::ConfigMap>>
@@ -46,14 +46,61 @@ zuri_distributor::TieredPackageCache::resolvePackage(const zuri_packager::Packag
         return DistributorStatus::forCondition(DistributorCondition::kDistributorInvariant,
             "invalid package specifier");
 
+    auto generation = getGeneration();
+
+    {
+        absl::MutexLock locker(&m_lock);
+        // if any tier changed then drop all memoized results
+        if (generation != m_resolvedGeneration) {
+            m_resolved.clear();
+            m_resolvedGeneration = generation;
+        }
+        auto entry = m_resolved.find(specifier);
+        if (entry != m_resolved.cend())
+            return entry->second;
+    }
+
+    Option<std::filesystem::path> resolvedOption;
     for (const auto &packageCache : m_packageCaches) {
         Option<std::filesystem::path> packagePathOption;
         TU_ASSIGN_OR_RETURN (packagePathOption, packageCache->resolvePackage(specifier));
-        if (packagePathOption.hasValue())
-            return packagePathOption;
+        if (packagePathOption.hasValue()) {
+            resolvedOption = packagePathOption;
+            break;
+        }
+    }
+
+    absl::MutexLock locker(&m_lock);
+    if (generation == m_resolvedGeneration) {
+        m_resolved[specifier] = resolvedOption;
     }
+    return resolvedOption;
+}
 
-    return {};
+tu_uint64
+zuri_distributor::TieredPackageCache::getGeneration() const
+{
+    tu_uint64 generation = 0;
+    for (const auto &packageCache : m_packageCaches) {
+        generation += packageCache->getGeneration();
+    }
+    return generation;
+}
+
+/**
+ * Invalidate each underlying package cache and drop every memoized resolution, including results
+ * memoized while no tier reported a change.
+ */
+void
+zuri_distributor::TieredPackageCache::invalidate()
+{
+    for (const auto &packageCache : m_packageCaches) {
+        packageCache->invalidate();
+    }
+    auto generation = getGeneration();
+    absl::MutexLock locker(&m_lock);
+    m_resolved.clear();
+    m_resolvedGeneration = generation;
 }
 
 tempo_utils::Result<std::shared_ptr<zuri_distributor::TieredPackageCache>>
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <tempo_test/result_matchers.h>
+#include <tempo_test/status_matchers.h>
+#include <tempo_utils/file_reader.h>
+#include <tempo_utils/memory_bytes.h>
+#include <tempo_utils/tempdir_maker.h>
+#include <zuri_distributor/blob_store.h>
+
+class BlobStore : public ::testing::Test {
+protected:
+    std::filesystem::path testerRoot;
+    void SetUp() override {
+        tempo_utils::TempdirMaker tempdirMaker(std::filesystem::current_path(), "tester.XXXXXXXX");
+        TU_RAISE_IF_NOT_OK (tempdirMaker.getStatus());
+        testerRoot = tempdirMaker.getTempdir();
+    }
+    void TearDown() override {
+        if (std::filesystem::exists(testerRoot)) {
+            TU_ASSERT (std::filesystem::remove_all(testerRoot));
+            testerRoot.clear();
+        }
+    }
+};
+
+TEST_F(BlobStore, PutBlobIsContentAddressed)
+{
+    std::shared_ptr<zuri_distributor::BlobStore> blobStore;
+    TU_ASSIGN_OR_RAISE (blobStore, zuri_distributor::BlobStore::openOrCreate(testerRoot / "blobs"));
+
+    auto helloBytes = tempo_utils::MemoryBytes::copy("hello, world!");
+    tempo_utils::Slice hello(helloBytes, 0, helloBytes->getSize());
+    auto goodbyeBytes = tempo_utils::MemoryBytes::copy("goodbye, world!");
+    tempo_utils::Slice goodbye(goodbyeBytes, 0, goodbyeBytes->getSize());
+
+    std::string digest1, digest2, digest3;
+    TU_ASSIGN_OR_RAISE (digest1, blobStore->putBlob(hello));
+    TU_ASSIGN_OR_RAISE (digest2, blobStore->putBlob(hello));
+    TU_ASSIGN_OR_RAISE (digest3, blobStore->putBlob(goodbye));
+    ASSERT_EQ (digest1, digest2);
+    ASSERT_NE (digest1, digest3);
+    ASSERT_TRUE (blobStore->containsBlob(digest1));
+    ASSERT_TRUE (blobStore->containsBlob(digest3));
+}
+
+TEST_F(BlobStore, MaterializeFileSharesBlobAndPruneReleasesIt)
+{
+    std::shared_ptr<zuri_distributor::BlobStore> blobStore;
+    TU_ASSIGN_OR_RAISE (blobStore, zuri_distributor::BlobStore::openOrCreate(testerRoot / "blobs"));
+
+    auto bytes = tempo_utils::MemoryBytes::copy("hello, world!");
+    tempo_utils::Slice contents(bytes, 0, bytes->getSize());
+    auto file1 = testerRoot / "file1.txt";
+    auto file2 = testerRoot / "file2.txt";
+    ASSERT_THAT (blobStore->materializeFile(contents, file1), tempo_test::IsOk());
+    ASSERT_THAT (blobStore->materializeFile(contents, file2), tempo_test::IsOk());
+
+    tempo_utils::FileReader reader(file2);
+    ASSERT_THAT (reader.getStatus(), tempo_test::IsOk());
+    auto fileBytes = reader.getBytes();
+    ASSERT_EQ ("hello, world!", std::string((const char *) fileBytes->getData(), fileBytes->getSize()));
+
+    std::string digest;
+    TU_ASSIGN_OR_RAISE (digest, blobStore->putBlob(contents));
+    if (std::filesystem::hard_link_count(blobStore->getBlobPath(digest)) <= 1)
+        GTEST_SKIP() << "filesystem does not support hardlinks, so blob references cannot be counted";
+
+    // the blob is still referenced, so it is not pruned
+    std::filesystem::remove(file1);
+    ASSERT_THAT (blobStore->pruneUnreferencedBlobs(), tempo_test::IsResult());
+    ASSERT_TRUE (blobStore->containsBlob(digest));
+
+    // once all references are removed the blob is pruned
+    std::filesystem::remove(file2);
+    ASSERT_THAT (blobStore->pruneUnreferencedBlobs(), tempo_test::IsResult());
+    ASSERT_FALSE (blobStore->containsBlob(digest));
+}
+
+TEST_F(BlobStore, PruneBlobsOnlyRemovesSpecifiedUnreferencedBlobs)
+{
+    std::shared_ptr<zuri_distributor::BlobStore> blobStore;
+    TU_ASSIGN_OR_RAISE (blobStore, zuri_distributor::BlobStore::openOrCreate(testerRoot / "blobs"));
+
+    auto helloBytes = tempo_utils::MemoryBytes::copy("hello, world!");
+    tempo_utils::Slice hello(helloBytes, 0, helloBytes->getSize());
+    auto goodbyeBytes = tempo_utils::MemoryBytes::copy("goodbye, world!");
+    tempo_utils::Slice goodbye(goodbyeBytes, 0, goodbyeBytes->getSize());
+    auto file1 = testerRoot / "file1.txt";
+    std::string helloDigest, goodbyeDigest;
+    TU_ASSIGN_OR_RAISE (helloDigest, blobStore->storeFile(hello, file1));
+    TU_ASSIGN_OR_RAISE (goodbyeDigest, blobStore->putBlob(goodbye));
+    if (std::filesystem::hard_link_count(blobStore->getBlobPath(helloDigest)) <= 1)
+        GTEST_SKIP() << "filesystem does not support hardlinks, so blob references cannot be counted";
+
+    // a referenced blob is kept and a blob which was not specified is ignored
+    std::vector<std::string> digests = {helloDigest, std::string(64, '0')};
+    int numPruned;
+    TU_ASSIGN_OR_RAISE (numPruned, blobStore->pruneBlobs(digests));
+    ASSERT_EQ (0, numPruned);
+    ASSERT_TRUE (blobStore->containsBlob(helloDigest));
+    ASSERT_TRUE (blobStore->containsBlob(goodbyeDigest));
+
+    std::filesystem::remove(file1);
+    TU_ASSIGN_OR_RAISE (numPruned, blobStore->pruneBlobs(digests));
+    ASSERT_EQ (1, numPruned);
+    ASSERT_FALSE (blobStore->containsBlob(helloDigest));
+    ASSERT_TRUE (blobStore->containsBlob(goodbyeDigest));
+}
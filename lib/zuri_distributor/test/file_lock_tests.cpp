@@ -0,0 +1,56 @@
+#include <atomic>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <tempo_test/result_matchers.h>
+#include <tempo_test/status_matchers.h>
+#include <tempo_utils/tempdir_maker.h>
+#include <zuri_distributor/file_lock.h>
+
+class FileLock : public ::testing::Test {
+protected:
+    std::filesystem::path testerRoot;
+    void SetUp() override {
+        tempo_utils::TempdirMaker tempdirMaker(std::filesystem::current_path(), "tester.XXXXXXXX");
+        TU_RAISE_IF_NOT_OK (tempdirMaker.getStatus());
+        testerRoot = tempdirMaker.getTempdir();
+    }
+    void TearDown() override {
+        if (std::filesystem::exists(testerRoot)) {
+            TU_ASSERT (std::filesystem::remove_all(testerRoot));
+            testerRoot.clear();
+        }
+    }
+};
+
+TEST_F(FileLock, SharedLocksDoNotConflict)
+{
+    auto lockPath = testerRoot / "test.lock";
+    std::shared_ptr<zuri_distributor::FileLock> lock1;
+    TU_ASSIGN_OR_RAISE (lock1, zuri_distributor::FileLock::acquire(lockPath, zuri_distributor::FileLockMode::Shared));
+    std::shared_ptr<zuri_distributor::FileLock> lock2;
+    TU_ASSIGN_OR_RAISE (lock2, zuri_distributor::FileLock::acquire(lockPath, zuri_distributor::FileLockMode::Shared));
+    ASSERT_TRUE (std::filesystem::exists(lockPath));
+}
+
+TEST_F(FileLock, ExclusiveLockWaitsForRelease)
+{
+    auto lockPath = testerRoot / "test.lock";
+    std::shared_ptr<zuri_distributor::FileLock> lock1;
+    TU_ASSIGN_OR_RAISE (lock1, zuri_distributor::FileLock::acquire(lockPath, zuri_distributor::FileLockMode::Shared));
+
+    std::atomic<bool> acquired{false};
+    std::thread waiter([&]() {
+        auto result = zuri_distributor::FileLock::acquire(lockPath, zuri_distributor::FileLockMode::Exclusive);
+        acquired = result.isResult();
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE (acquired.load());
+
+    lock1.reset();
+    waiter.join();
+    ASSERT_TRUE (acquired.load());
+}
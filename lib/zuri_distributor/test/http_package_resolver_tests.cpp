@@ -31,3 +31,17 @@ TEST(HttpPackageResolver, GetPackage)
     ASSERT_THAT (getPackageResult, tempo_test::IsResult());
 }
 
+
+TEST(HttpPackageResolver, GetPackages)
+{
+    std::shared_ptr<zuri_distributor::HttpPackageResolver> resolver;
+    TU_ASSIGN_OR_RAISE (resolver, zuri_distributor::HttpPackageResolver::create());
+    zuri_packager::PackageId packageId("test", "msfrank.github.io");
+    std::vector<zuri_packager::PackageSpecifier> packageSpecifiers = {
+        zuri_packager::PackageSpecifier(packageId, zuri_packager::PackageVersion(0, 0, 1)),
+        zuri_packager::PackageSpecifier(packageId, zuri_packager::PackageVersion(0, 0, 1)),
+    };
+    auto getPackagesResult = resolver->getPackages(packageSpecifiers);
+    ASSERT_THAT (getPackagesResult, tempo_test::IsResult());
+    ASSERT_EQ (1, getPackagesResult.getResult().size());
+}
@@ -1,10 +1,267 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <tempo_test/result_matchers.h>
+#include <tempo_test/status_matchers.h>
+#include <tempo_utils/tempdir_maker.h>
+#include <zuri_distributor/package_store.h>
+#include <zuri_distributor/runtime.h>
+#include <zuri_distributor/tiered_package_cache.h>
 #include <zuri_packager/package_reader.h>
 #include <zuri_packager/package_writer.h>
 #include <zuri_test/zuri_tester.h>
 
-TEST(PackageCache, InstallPackage)
+class PackageCache : public ::testing::Test {
+protected:
+    std::filesystem::path testerRoot;
+    void SetUp() override {
+        tempo_utils::TempdirMaker tempdirMaker(std::filesystem::current_path(), "tester.XXXXXXXX");
+        TU_RAISE_IF_NOT_OK (tempdirMaker.getStatus());
+        testerRoot = tempdirMaker.getTempdir();
+    }
+    std::shared_ptr<zuri_packager::PackageReader> writePackage(const zuri_packager::PackageSpecifier &specifier) {
+        zuri_packager::PackageWriterOptions writerOptions;
+        writerOptions.installRoot = testerRoot;
+        zuri_packager::PackageWriter writer(specifier, writerOptions);
+        TU_RAISE_IF_NOT_OK (writer.configure());
+        std::filesystem::path packagePath;
+        TU_ASSIGN_OR_RAISE (packagePath, writer.writePackage());
+        std::shared_ptr<zuri_packager::PackageReader> reader;
+        TU_ASSIGN_OR_RAISE (reader, zuri_packager::PackageReader::open(packagePath));
+        return reader;
+    }
+    void TearDown() override {
+        if (std::filesystem::exists(testerRoot)) {
+            TU_ASSERT (std::filesystem::remove_all(testerRoot));
+            testerRoot.clear();
+        }
+    }
+};
+
+TEST_F(PackageCache, InstallPackage)
+{
+    std::shared_ptr<zuri_distributor::PackageStore> packageStore;
+    TU_ASSIGN_OR_RAISE (packageStore, zuri_distributor::PackageStore::openOrCreate(testerRoot / "packages"));
+
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    auto reader = writePackage(specifier);
+
+    auto generation = packageStore->getGeneration();
+    ASSERT_FALSE (packageStore->containsPackage(specifier));
+    ASSERT_THAT (packageStore->installPackage(reader), tempo_test::IsResult());
+    ASSERT_TRUE (packageStore->containsPackage(specifier));
+    ASSERT_NE (generation, packageStore->getGeneration());
+}
+
+TEST_F(PackageCache, TieredCacheObservesInstallAfterMemoizingMiss)
+{
+    std::shared_ptr<zuri_distributor::PackageStore> packageStore;
+    TU_ASSIGN_OR_RAISE (packageStore, zuri_distributor::PackageStore::openOrCreate(testerRoot / "packages"));
+    zuri_distributor::TieredPackageCache tieredCache({packageStore});
+
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    ASSERT_FALSE (tieredCache.containsPackage(specifier));
+
+    auto reader = writePackage(specifier);
+    ASSERT_THAT (packageStore->installPackage(reader), tempo_test::IsResult());
+
+    // the install bumps the store generation, so the memoized miss is discarded
+    ASSERT_TRUE (tieredCache.containsPackage(specifier));
+    ASSERT_THAT (packageStore->removePackage(specifier), tempo_test::IsOk());
+    ASSERT_FALSE (tieredCache.containsPackage(specifier));
+}
+
+TEST_F(PackageCache, TieredCacheObservesExternalInstallAfterInvalidate)
+{
+    std::shared_ptr<zuri_distributor::PackageStore> packageStore;
+    TU_ASSIGN_OR_RAISE (packageStore, zuri_distributor::PackageStore::openOrCreate(testerRoot / "packages"));
+    zuri_distributor::TieredPackageCache tieredCache({packageStore});
+
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    ASSERT_FALSE (tieredCache.containsPackage(specifier));
+
+    auto reader = writePackage(specifier);
+
+    // install through a different store, so the generation seen by the tiered cache is unchanged
+    std::shared_ptr<zuri_distributor::PackageStore> otherStore;
+    TU_ASSIGN_OR_RAISE (otherStore, zuri_distributor::PackageStore::open(testerRoot / "packages"));
+    ASSERT_THAT (otherStore->installPackage(reader), tempo_test::IsResult());
+    ASSERT_FALSE (tieredCache.containsPackage(specifier));
+
+    tieredCache.invalidate();
+    ASSERT_TRUE (tieredCache.containsPackage(specifier));
+}
+
+TEST_F(PackageCache, StageAndPublishPackage)
+{
+    std::shared_ptr<zuri_distributor::PackageStore> packageStore;
+    TU_ASSIGN_OR_RAISE (packageStore, zuri_distributor::PackageStore::openOrCreate(testerRoot / "packages"));
+
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    auto reader = writePackage(specifier);
+
+    auto stagingDirectory = testerRoot / "packages" / ".staging";
+    std::filesystem::create_directory(stagingDirectory);
+
+    zuri_distributor::StagedPackage stagedPackage;
+    TU_ASSIGN_OR_RAISE (stagedPackage, packageStore->stagePackage(reader, stagingDirectory));
+    ASSERT_EQ (specifier, stagedPackage.specifier);
+    ASSERT_FALSE (packageStore->containsPackage(specifier));
+    for (const auto &file : stagedPackage.files) {
+        ASSERT_TRUE (file.path.starts_with("/"));
+        ASSERT_EQ (64, file.sha256.size());
+    }
+
+    ASSERT_THAT (packageStore->publishPackage(stagedPackage), tempo_test::IsResult());
+    ASSERT_TRUE (packageStore->containsPackage(specifier));
+}
+
+TEST_F(PackageCache, RuntimeInstallPackagesRecordsEveryPackage)
+{
+    std::shared_ptr<zuri_distributor::Runtime> runtime;
+    TU_ASSIGN_OR_RAISE (runtime, zuri_distributor::Runtime::openOrCreate(testerRoot / "runtime"));
+
+    std::vector<zuri_distributor::RuntimeInstallable> installables;
+    std::vector<zuri_packager::PackageSpecifier> specifiers;
+    for (const auto *name : {"foo-1.0.0@foocorp", "bar-1.0.0@foocorp", "baz-1.0.0@foocorp"}) {
+        auto specifier = zuri_packager::PackageSpecifier::fromString(name);
+        zuri_distributor::RuntimeInstallable installable;
+        installable.reader = writePackage(specifier);
+        installable.sha256 = std::string(64, 'a');
+        installables.push_back(std::move(installable));
+        specifiers.push_back(specifier);
+    }
+
+    std::vector<std::filesystem::path> installPaths;
+    TU_ASSIGN_OR_RAISE (installPaths, runtime->installPackages(installables));
+    ASSERT_EQ (3, installPaths.size());
+
+    auto packageDatabase = runtime->getPackageDatabase();
+    for (const auto &specifier : specifiers) {
+        ASSERT_TRUE (runtime->containsPackage(specifier));
+        ASSERT_THAT (packageDatabase->getPackageDigest(specifier),
+            tempo_test::ContainsResult(Option(std::string(64, 'a'))));
+    }
+
+    // installing a package which is already installed fails without installing anything
+    ASSERT_THAT (runtime->installPackages(installables), tempo_test::IsStatus());
+
+    // unless the existing packages are replaced
+    zuri_distributor::RuntimeInstallOptions installOptions;
+    installOptions.replaceExisting = true;
+    ASSERT_THAT (runtime->installPackages(installables, installOptions), tempo_test::IsResult());
+    for (const auto &specifier : specifiers) {
+        ASSERT_TRUE (runtime->containsPackage(specifier));
+    }
+
+    // the staging directory and the replaced packages are cleaned up
+    for (const auto &entry : std::filesystem::directory_iterator(runtime->getPackagesDirectory())) {
+        ASSERT_FALSE (entry.path().filename().string().starts_with(".staging"));
+    }
+
+    // packages with an unchanged digest are not reinstalled
+    auto dataVersion = packageDatabase->getDataVersion();
+    installOptions.skipUnchanged = true;
+    ASSERT_THAT (runtime->installPackages(installables, installOptions),
+        tempo_test::ContainsResult(installPaths));
+    ASSERT_EQ (dataVersion, packageDatabase->getDataVersion());
+}
+
+TEST_F(PackageCache, IndexedStoreDescribesPackageFromIndex)
 {
-}
\ No newline at end of file
+    std::shared_ptr<zuri_distributor::PackageDatabase> packageIndex;
+    TU_ASSIGN_OR_RAISE (packageIndex, zuri_distributor::PackageDatabase::openOrCreate(testerRoot / "packages.db"));
+    std::shared_ptr<zuri_distributor::PackageStore> packageStore;
+    TU_ASSIGN_OR_RAISE (packageStore, zuri_distributor::PackageStore::openOrCreate(
+        testerRoot / "packages", packageIndex));
+
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    ASSERT_FALSE (packageStore->containsPackage(specifier));
+
+    auto reader = writePackage(specifier);
+
+    // the negative lookup is not served from the cache once the package is installed
+    std::filesystem::path installPath;
+    TU_ASSIGN_OR_RAISE (installPath, packageStore->installPackage(reader));
+    ASSERT_TRUE (packageStore->containsPackage(specifier));
+
+    Option<zuri_distributor::InstalledPackage> installedOption;
+    TU_ASSIGN_OR_RAISE (installedOption, packageIndex->getInstalledPackage(specifier));
+    ASSERT_TRUE (installedOption.hasValue());
+    ASSERT_EQ (installPath, installedOption.getValue().path);
+
+    // the package config is served from the index rather than read from disk
+    std::filesystem::remove(installPath / "package.config");
+    Option<tempo_config::ConfigMap> configOption;
+    TU_ASSIGN_OR_RAISE (configOption, packageStore->describePackage(specifier));
+    ASSERT_TRUE (configOption.hasValue());
+
+    ASSERT_THAT (packageStore->removePackage(specifier), tempo_test::IsOk());
+    ASSERT_FALSE (packageStore->containsPackage(specifier));
+}
+
+TEST_F(PackageCache, IndexedStoreObservesOtherConnectionOnlyAfterInvalidate)
+{
+    std::shared_ptr<zuri_distributor::PackageDatabase> writerIndex;
+    TU_ASSIGN_OR_RAISE (writerIndex, zuri_distributor::PackageDatabase::openOrCreate(testerRoot / "packages.db"));
+    std::shared_ptr<zuri_distributor::PackageStore> writerStore;
+    TU_ASSIGN_OR_RAISE (writerStore, zuri_distributor::PackageStore::openOrCreate(
+        testerRoot / "packages", writerIndex));
+    std::shared_ptr<zuri_distributor::PackageDatabase> readerIndex;
+    TU_ASSIGN_OR_RAISE (readerIndex, zuri_distributor::PackageDatabase::open(testerRoot / "packages.db"));
+    std::shared_ptr<zuri_distributor::PackageStore> readerStore;
+    TU_ASSIGN_OR_RAISE (readerStore, zuri_distributor::PackageStore::open(
+        testerRoot / "packages", readerIndex));
+
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    ASSERT_FALSE (readerStore->containsPackage(specifier));
+
+    auto reader = writePackage(specifier);
+    ASSERT_THAT (writerStore->installPackage(reader), tempo_test::IsResult());
+
+    // the memoized miss is served until the reader checks for changes to the index
+    auto generation = readerStore->getGeneration();
+    ASSERT_FALSE (readerStore->containsPackage(specifier));
+    ASSERT_EQ (generation, readerStore->getGeneration());
+    readerStore->invalidate();
+    ASSERT_NE (generation, readerStore->getGeneration());
+    ASSERT_TRUE (readerStore->containsPackage(specifier));
+
+    // invalidating an unchanged index keeps the generation
+    generation = readerStore->getGeneration();
+    readerStore->invalidate();
+    ASSERT_EQ (generation, readerStore->getGeneration());
+}
+
+TEST_F(PackageCache, IndexPackagesRecordsUnindexedPackages)
+{
+    std::shared_ptr<zuri_distributor::PackageStore> unindexedStore;
+    TU_ASSIGN_OR_RAISE (unindexedStore, zuri_distributor::PackageStore::openOrCreate(testerRoot / "packages"));
+
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    auto reader = writePackage(specifier);
+    std::filesystem::path installPath;
+    TU_ASSIGN_OR_RAISE (installPath, unindexedStore->installPackage(reader));
+
+    // a package which is missing from the index is not resolved from the packages directory
+    std::shared_ptr<zuri_distributor::PackageDatabase> packageIndex;
+    TU_ASSIGN_OR_RAISE (packageIndex, zuri_distributor::PackageDatabase::openOrCreate(testerRoot / "packages.db"));
+    std::shared_ptr<zuri_distributor::PackageStore> packageStore;
+    TU_ASSIGN_OR_RAISE (packageStore, zuri_distributor::PackageStore::open(testerRoot / "packages", packageIndex));
+    ASSERT_FALSE (packageStore->containsPackage(specifier));
+
+    ASSERT_EQ (0, packageIndex->getSchemaVersion());
+    ASSERT_THAT (packageStore->indexPackages(), tempo_test::IsOk());
+    ASSERT_THAT (packageStore->resolvePackage(specifier), tempo_test::ContainsResult(Option(installPath)));
+    ASSERT_EQ (zuri_distributor::kIndexedPackagesSchemaVersion, packageIndex->getSchemaVersion());
+
+    // indexing a migrated index does nothing and keeps the generation
+    auto generation = packageStore->getGeneration();
+    ASSERT_THAT (packageStore->indexPackages(), tempo_test::IsOk());
+    ASSERT_EQ (generation, packageStore->getGeneration());
+
+    // an indexed package whose directory was removed is not resolved
+    std::filesystem::remove_all(installPath);
+    packageStore->invalidate();
+    ASSERT_THAT (packageStore->resolvePackage(specifier), tempo_test::ContainsResult(Option<std::filesystem::path>()));
+}
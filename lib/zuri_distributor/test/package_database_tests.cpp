@@ -1,3 +1,5 @@
+#include <limits>
+
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
@@ -37,3 +39,101 @@ TEST_F(PackageDatabase, OpenFailsWhenDatabaseDoesNotExist)
     ASSERT_THAT (createDatabaseResult, tempo_test::ContainsStatus(
         zuri_distributor::DistributorCondition::kDistributorInvariant));
 }
+
+TEST_F(PackageDatabase, PutAndRemovePackage)
+{
+    auto databaseFilePath = tempo_utils::generate_name("environment.db.XXXXXXXX");
+    TU_ASSIGN_OR_RAISE (packageDatabase, zuri_distributor::PackageDatabase::openOrCreate(databaseFilePath));
+
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    ASSERT_THAT (packageDatabase->putPackage(specifier, "abcdef"), tempo_test::IsOk());
+    ASSERT_THAT (packageDatabase->getPackageDigest(specifier),
+        tempo_test::ContainsResult(Option<std::string>("abcdef")));
+
+    ASSERT_THAT (packageDatabase->removePackage(specifier), tempo_test::IsOk());
+    ASSERT_THAT (packageDatabase->getPackageDigest(specifier),
+        tempo_test::ContainsResult(Option<std::string>()));
+}
+
+TEST_F(PackageDatabase, PutAndGetHttpCacheEntry)
+{
+    auto databaseFilePath = tempo_utils::generate_name("environment.db.XXXXXXXX");
+    TU_ASSIGN_OR_RAISE (packageDatabase, zuri_distributor::PackageDatabase::openOrCreate(databaseFilePath));
+
+    auto url = "https://example.com/repository.json";
+    Option<zuri_distributor::HttpCacheEntry> entryOption;
+    TU_ASSIGN_OR_RAISE (entryOption, packageDatabase->getHttpCacheEntry(url));
+    ASSERT_TRUE (entryOption.isEmpty());
+
+    zuri_distributor::HttpCacheEntry entry;
+    entry.etag = "\"abc\"";
+    entry.lastModified = "Wed, 21 Oct 2015 07:28:00 GMT";
+    entry.expiresEpochMillis = 1000;
+    entry.body = "{}";
+    ASSERT_THAT (packageDatabase->putHttpCacheEntry(url, entry), tempo_test::IsOk());
+
+    TU_ASSIGN_OR_RAISE (entryOption, packageDatabase->getHttpCacheEntry(url));
+    ASSERT_FALSE (entryOption.isEmpty());
+    auto cached = entryOption.getValue();
+    ASSERT_EQ (entry.etag, cached.etag);
+    ASSERT_EQ (entry.lastModified, cached.lastModified);
+    ASSERT_EQ (entry.expiresEpochMillis, cached.expiresEpochMillis);
+    ASSERT_EQ (entry.body, cached.body);
+}
+
+TEST_F(PackageDatabase, PruneHttpCacheEvictsStaleAndExcessEntries)
+{
+    auto databaseFilePath = tempo_utils::generate_name("environment.db.XXXXXXXX");
+    TU_ASSIGN_OR_RAISE (packageDatabase, zuri_distributor::PackageDatabase::openOrCreate(databaseFilePath));
+
+    zuri_distributor::HttpCacheEntry entry;
+    entry.body = std::string(100, 'x');
+    ASSERT_THAT (packageDatabase->putHttpCacheEntry("https://example.com/1.json", entry), tempo_test::IsOk());
+    ASSERT_THAT (packageDatabase->putHttpCacheEntry("https://example.com/2.json", entry), tempo_test::IsOk());
+    ASSERT_THAT (packageDatabase->putHttpCacheEntry("https://example.com/3.json", entry), tempo_test::IsOk());
+
+    Option<zuri_distributor::HttpCacheEntry> entryOption;
+
+    // nothing is evicted if the entries are recent and fit within the size limit
+    ASSERT_THAT (packageDatabase->pruneHttpCache(0, 300), tempo_test::IsOk());
+    TU_ASSIGN_OR_RAISE (entryOption, packageDatabase->getHttpCacheEntry("https://example.com/1.json"));
+    ASSERT_FALSE (entryOption.isEmpty());
+
+    // the least recently stored entry is evicted first
+    ASSERT_THAT (packageDatabase->pruneHttpCache(0, 250), tempo_test::IsOk());
+    TU_ASSIGN_OR_RAISE (entryOption, packageDatabase->getHttpCacheEntry("https://example.com/1.json"));
+    ASSERT_TRUE (entryOption.isEmpty());
+    TU_ASSIGN_OR_RAISE (entryOption, packageDatabase->getHttpCacheEntry("https://example.com/3.json"));
+    ASSERT_FALSE (entryOption.isEmpty());
+
+    // entries stored before the cutoff are evicted
+    ASSERT_THAT (packageDatabase->pruneHttpCache(std::numeric_limits<tu_int64>::max(), 300), tempo_test::IsOk());
+    TU_ASSIGN_OR_RAISE (entryOption, packageDatabase->getHttpCacheEntry("https://example.com/3.json"));
+    ASSERT_TRUE (entryOption.isEmpty());
+}
+
+TEST_F(PackageDatabase, PutAndGetInstalledPackage)
+{
+    auto databaseFilePath = tempo_utils::generate_name("environment.db.XXXXXXXX");
+    TU_ASSIGN_OR_RAISE (packageDatabase, zuri_distributor::PackageDatabase::openOrCreate(databaseFilePath));
+
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    Option<zuri_distributor::InstalledPackage> installedOption;
+    TU_ASSIGN_OR_RAISE (installedOption, packageDatabase->getInstalledPackage(specifier));
+    ASSERT_TRUE (installedOption.isEmpty());
+
+    auto dataVersion = packageDatabase->getDataVersion();
+    ASSERT_THAT (packageDatabase->putPackage(specifier, "abcdef", "/packages/foo", "{}"), tempo_test::IsOk());
+    ASSERT_NE (dataVersion, packageDatabase->getDataVersion());
+
+    TU_ASSIGN_OR_RAISE (installedOption, packageDatabase->getInstalledPackage(specifier));
+    ASSERT_TRUE (installedOption.hasValue());
+    auto installed = installedOption.getValue();
+    ASSERT_EQ ("/packages/foo", installed.path.string());
+    ASSERT_EQ ("{}", installed.config);
+    ASSERT_EQ ("abcdef", installed.sha256);
+
+    ASSERT_THAT (packageDatabase->removePackage(specifier), tempo_test::IsOk());
+    TU_ASSIGN_OR_RAISE (installedOption, packageDatabase->getInstalledPackage(specifier));
+    ASSERT_TRUE (installedOption.isEmpty());
+}
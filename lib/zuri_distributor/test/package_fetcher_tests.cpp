@@ -136,4 +136,72 @@ TEST_F (PackageFetcher, FetchMultiplePackagesFromFileUrl) {
     auto readBazSpecifier = openBazResult.getResult()->readPackageSpecifier();
     ASSERT_THAT (readBazSpecifier, tempo_test::IsResult());
     ASSERT_EQ (bazSpecifier, readBazSpecifier.getResult());
-}
\ No newline at end of file
+}
+
+TEST_F (PackageFetcher, FetchPackagesWithOneConcurrentTransfer) {
+    zuri_distributor::PackageFetcherOptions options;
+    options.downloadRoot = downloadDir->getAbsolutePath();
+    options.maxConcurrentTransfers = 1;
+
+    zuri_distributor::PackageFetcher fetcher(options);
+    ASSERT_THAT (fetcher.configure(), tempo_test::IsOk());
+    ASSERT_THAT (fetcher.requestFile(fooUrl, fooSpecifier.toString()), tempo_test::IsOk());
+    ASSERT_THAT (fetcher.requestFile(barUrl, barSpecifier.toString()), tempo_test::IsOk());
+    ASSERT_THAT (fetcher.requestFile(bazUrl, bazSpecifier.toString()), tempo_test::IsOk());
+    ASSERT_THAT (fetcher.requestFile(quxUrl, quxSpecifier.toString()), tempo_test::IsOk());
+    ASSERT_THAT (fetcher.fetchFiles(), tempo_test::IsOk());
+
+    ASSERT_EQ (4, fetcher.numResults());
+    for (auto it = fetcher.resultsBegin(); it != fetcher.resultsEnd(); it++) {
+        ASSERT_THAT (it->second.status, tempo_test::IsOk());
+        ASSERT_TRUE (std::filesystem::is_regular_file(it->second.path));
+    }
+}
+
+TEST_F (PackageFetcher, FailedFetchDoesNotLeaveTempfile) {
+    zuri_distributor::PackageFetcherOptions options;
+    options.downloadRoot = downloadDir->getAbsolutePath();
+
+    zuri_distributor::PackageFetcher fetcher(options);
+    ASSERT_THAT (fetcher.configure(), tempo_test::IsOk());
+    auto missingUrl = tempo_utils::Url::fromFilesystemPath(fetchDir->getTempdir() / "missing.zpk");
+    ASSERT_THAT (fetcher.requestFile(missingUrl, "missing"), tempo_test::IsOk());
+    ASSERT_THAT (fetcher.fetchFiles(), tempo_test::IsOk());
+
+    ASSERT_EQ (1, fetcher.numResults());
+    auto result = fetcher.getResult("missing");
+    ASSERT_TRUE (result.status.notOk());
+    ASSERT_TRUE (std::filesystem::is_empty(downloadDir->getAbsolutePath()));
+}
+
+TEST_F (PackageFetcher, VerifyFetchedFileDigest) {
+    zuri_distributor::PackageFetcherOptions options;
+    options.downloadRoot = downloadDir->getAbsolutePath();
+
+    std::string digest;
+    {
+        zuri_distributor::PackageFetcher fetcher(options);
+        ASSERT_THAT (fetcher.configure(), tempo_test::IsOk());
+        ASSERT_THAT (fetcher.requestFile(fooUrl, "foo"), tempo_test::IsOk());
+        ASSERT_THAT (fetcher.fetchFiles(), tempo_test::IsOk());
+        auto result = fetcher.getResult("foo");
+        ASSERT_THAT (result.status, tempo_test::IsOk());
+        digest = result.digest;
+        ASSERT_EQ (64, digest.size());
+        std::filesystem::remove(result.path);
+    }
+
+    zuri_distributor::PackageFetcher fetcher(options);
+    ASSERT_THAT (fetcher.configure(), tempo_test::IsOk());
+    ASSERT_THAT (fetcher.requestFile(fooUrl, "match", digest), tempo_test::IsOk());
+    ASSERT_THAT (fetcher.requestFile(barUrl, "mismatch", digest), tempo_test::IsOk());
+    ASSERT_THAT (fetcher.fetchFiles(), tempo_test::IsOk());
+
+    auto matchResult = fetcher.getResult("match");
+    ASSERT_THAT (matchResult.status, tempo_test::IsOk());
+    ASSERT_EQ (digest, matchResult.digest);
+
+    auto mismatchResult = fetcher.getResult("mismatch");
+    ASSERT_TRUE (mismatchResult.status.notOk());
+    ASSERT_FALSE (std::filesystem::exists(barSpecifier.toPackagePath(downloadDir->getAbsolutePath())));
+}
@@ -21,10 +21,12 @@ namespace zuri_packager {
 
         bool isValid() const;
 
+        tu_uint32 getAddress() const;
         EntryType getEntryType() const;
         tempo_utils::UrlPath getPath() const;
         tu_uint64 getFileOffset() const;
         tu_uint64 getFileSize() const;
+        EntryWalker getDict() const;
         EntryWalker getLink() const;
         EntryWalker resolveLink() const;
 
@@ -20,6 +20,7 @@ namespace zuri_packager {
             ManifestState *state);
 
         EntryType getEntryType() const;
+        void setEntryType(EntryType type);
         tempo_utils::UrlPath getEntryPath() const;
         std::string getEntryName() const;
         EntryAddress getAddress() const;
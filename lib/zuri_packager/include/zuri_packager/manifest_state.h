@@ -36,6 +36,7 @@ namespace zuri_packager {
         ManifestEntry *getEntry(int index) const;
         ManifestEntry *getEntry(const tempo_utils::UrlPath &path) const;
         tempo_utils::Result<ManifestEntry *> appendEntry(EntryType type, const tempo_utils::UrlPath &path);
+        ManifestEntry *appendDictionaryEntry();
         std::vector<ManifestEntry *>::const_iterator entriesBegin() const;
         std::vector<ManifestEntry *>::const_iterator entriesEnd() const;
         int numEntries() const;
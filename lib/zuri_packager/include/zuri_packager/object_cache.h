@@ -0,0 +1,68 @@
+#ifndef ZURI_PACKAGER_OBJECT_CACHE_H
+#define ZURI_PACKAGER_OBJECT_CACHE_H
+
+#include <filesystem>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include <lyric_object/lyric_object.h>
+#include <tempo_utils/immutable_bytes.h>
+#include <tempo_utils/result.h>
+
+namespace zuri_packager {
+
+    /**
+     * Identifies the contents of an object file on disk. Two files with the same identity are
+     * assumed to have the same contents.
+     */
+    struct ObjectFileIdentity {
+        tu_uint64 device = 0;
+        tu_uint64 inode = 0;
+        tu_int64 mtimeNanos = 0;
+        tu_uint64 size = 0;
+
+        bool operator==(const ObjectFileIdentity &other) const {
+            return device == other.device
+                && inode == other.inode
+                && mtimeNanos == other.mtimeNanos
+                && size == other.size;
+        }
+
+        template <typename H>
+        friend H AbslHashValue(H h, const ObjectFileIdentity &identity) {
+            return H::combine(std::move(h), identity.device, identity.inode, identity.mtimeNanos, identity.size);
+        }
+    };
+
+    /**
+     * Loads object files by memory-mapping them. Objects which are loaded while another load of the
+     * same file is still alive share a single mapping, and each file identity is verified at most
+     * once for the lifetime of the cache.
+     */
+    class ObjectCache {
+    public:
+        ObjectCache() = default;
+
+        static std::shared_ptr<ObjectCache> processCache();
+
+        tempo_utils::Result<lyric_object::LyricObject> loadObject(const std::filesystem::path &objectPath);
+
+        bool isVerified(const std::filesystem::path &objectPath) const;
+        int numMappedObjects() const;
+
+    private:
+        struct ObjectEntry {
+            std::weak_ptr<const tempo_utils::ImmutableBytes> bytes;
+        };
+
+        // objects which have been verified, keyed by file identity. the mapping is held weakly so
+        // that unused objects are unmapped, but the entry is kept so the file is never re-verified.
+        mutable absl::Mutex m_lock;
+        absl::flat_hash_map<ObjectFileIdentity,ObjectEntry> m_objects ABSL_GUARDED_BY(m_lock);
+    };
+
+    tempo_utils::Result<ObjectFileIdentity> get_object_file_identity(const std::filesystem::path &objectPath);
+}
+
+#endif // ZURI_PACKAGER_OBJECT_CACHE_H
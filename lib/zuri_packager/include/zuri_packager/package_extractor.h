@@ -3,6 +3,7 @@
 
 #include <filesystem>
 #include <queue>
+#include <vector>
 
 #include <tempo_utils/result.h>
 
@@ -12,6 +13,20 @@
 
 namespace zuri_packager {
 
+    /**
+     * Interface for writing the contents of a file entry to its destination path during extraction.
+     * when the extractor is configured with more than one worker, materializeFile may be invoked
+     * concurrently from multiple threads, so implementations must be thread-safe.
+     */
+    class AbstractFileMaterializer {
+    public:
+        virtual ~AbstractFileMaterializer() = default;
+
+        virtual tempo_utils::Status materializeFile(
+            const tempo_utils::Slice &contents,
+            const std::filesystem::path &filePath) = 0;
+    };
+
     struct PackageExtractorOptions {
         /**
          *
@@ -21,6 +36,16 @@ namespace zuri_packager {
          *
          */
         std::filesystem::path workingRoot = {};
+        /**
+         * the number of threads used to write file contents. if zero, then the number of threads is
+         * the hardware concurrency. by default files are written serially on the calling thread.
+         */
+        int numWorkers = 1;
+        /**
+         * if specified, then file contents are written by the materializer instead of being written
+         * directly to the destination path.
+         */
+        std::shared_ptr<AbstractFileMaterializer> materializer = {};
     };
 
     class PackageExtractor {
@@ -38,10 +63,12 @@ namespace zuri_packager {
         PackageSpecifier m_specifier;
         std::filesystem::path m_workdirPath;
         std::queue<EntryWalker> m_pendingDirectories;
+        std::vector<EntryWalker> m_pendingFiles;
         std::queue<EntryWalker> m_unresolvedLinks;
 
         tempo_utils::Status extractRoot(const EntryWalker &root);
         tempo_utils::Status extractChildren(const EntryWalker &parent);
+        tempo_utils::Status extractFiles();
         tempo_utils::Status extractFile(const EntryWalker &file);
         tempo_utils::Status linkEntry(const EntryWalker &link);
     };
@@ -2,6 +2,9 @@
 #define ZURI_PACKAGER_PACKAGE_READER_H
 
 #include <filesystem>
+
+#include <absl/synchronization/mutex.h>
+
 #include <lyric_common/module_location.h>
 
 #include <tempo_config/config_types.h>
@@ -14,13 +17,32 @@
 
 namespace zuri_packager {
 
+    struct PackageReaderOptions {
+        /**
+         * the maximum number of decompressed file contents to retain in memory. when a compressed
+         * entry is read and its contents are cached, subsequent reads of the entry return the cached
+         * contents instead of decompressing again. by default no decompressed contents are cached.
+         */
+        int decompressedCacheSize = 0;
+        /**
+         * the maximum size in bytes of the decompressed contents of a compressed entry. the size is
+         * read from the compressed frame before any memory is allocated, and an entry which claims
+         * to be larger is rejected as an invalid manifest.
+         */
+        tu_uint32 maxDecompressedEntrySize = 256 * 1024 * 1024;
+    };
+
     class PackageReader {
 
     public:
+        ~PackageReader();
+
         static tempo_utils::Result<std::shared_ptr<PackageReader>> create(
-            std::shared_ptr<const tempo_utils::ImmutableBytes> packageBytes);
+            std::shared_ptr<const tempo_utils::ImmutableBytes> packageBytes,
+            const PackageReaderOptions &options = {});
         static tempo_utils::Result<std::shared_ptr<PackageReader>> open(
-            const std::filesystem::path &packagePath);
+            const std::filesystem::path &packagePath,
+            const PackageReaderOptions &options = {});
 
         bool isValid() const;
 
@@ -36,17 +58,45 @@ namespace zuri_packager {
             const tempo_utils::UrlPath &entryPath,
             bool followSymlinks = false) const;
 
+        tempo_utils::Result<PackageSpecifier> getPackageSpecifier() const;
+        tempo_utils::Result<lyric_common::ModuleLocation> getProgramMain() const;
+        tempo_utils::Result<RequirementsMap> getRequirementsMap() const;
+        tempo_utils::Result<tempo_config::ConfigMap> getPackageConfig() const;
+
     private:
         tu_uint8 m_version;
         tu_uint8 m_flags;
         ZuriManifest m_manifest;
         tempo_utils::Slice m_contents;
+        PackageReaderOptions m_options;
+
+        struct ConfigCache {
+            tempo_utils::Status configStatus;
+            tempo_config::ConfigMap packageConfig;
+            tempo_utils::Status specifierStatus;
+            PackageSpecifier specifier;
+            tempo_utils::Status programMainStatus;
+            lyric_common::ModuleLocation programMain;
+            tempo_utils::Status requirementsStatus;
+            RequirementsMap requirementsMap;
+        };
+        mutable absl::Mutex m_lock;
+        mutable std::unique_ptr<ConfigCache> m_configCache ABSL_GUARDED_BY(m_lock);
+
+        struct DecompressCache;
+        mutable absl::Mutex m_decompressLock;
+        std::unique_ptr<DecompressCache> m_decompressCache ABSL_GUARDED_BY(m_decompressLock);
+
+        const ConfigCache *loadConfigCache() const;
+        tempo_utils::Result<tempo_utils::Slice> readEntryContents(const EntryWalker &entry) const;
+        tempo_utils::Result<tempo_utils::Slice> decompressEntry(const EntryWalker &entry) const;
 
         PackageReader(
             tu_uint8 version,
             tu_uint8 flags,
             ZuriManifest manifest,
-            tempo_utils::Slice contents);
+            tempo_utils::Slice contents,
+            const PackageReaderOptions &options);
     };
 }
 
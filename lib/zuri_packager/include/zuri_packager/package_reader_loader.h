@@ -3,17 +3,38 @@
 
 #include <filesystem>
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/synchronization/mutex.h>
+
 #include <lyric_runtime/abstract_loader.h>
 
 #include "package_reader.h"
+#include "plugin_cache.h"
 
 namespace zuri_packager {
 
+    struct PackageReaderLoaderOptions {
+        /**
+         * if true, then the entire package is extracted into a temporary directory when the loader
+         * is created and modules are loaded from the extracted files. by default modules are loaded
+         * directly from the package contents, and only plugins (and the libraries they link against)
+         * are materialized on disk the first time they are loaded.
+         */
+        bool extractPackage = false;
+        /**
+         * the cache used to load plugins. if not specified then the process-wide plugin cache
+         * is used.
+         */
+        std::shared_ptr<PluginCache> pluginCache;
+    };
+
     class PackageReaderLoader : public lyric_runtime::AbstractLoader {
     public:
         static tempo_utils::Result<std::shared_ptr<PackageReaderLoader>> create(
             std::shared_ptr<PackageReader> reader,
-            const std::filesystem::path &tempRoot);
+            const std::filesystem::path &tempRoot,
+            const PackageReaderLoaderOptions &options = {});
 
         tempo_utils::Result<bool> hasModule(
             const lyric_common::ModuleLocation &location) const override;
@@ -28,17 +49,30 @@ namespace zuri_packager {
         PackageSpecifier m_specifier;
         std::filesystem::path m_packageDirectory;
         std::filesystem::path m_tempDirectory;
+        bool m_isExtracted;
+        std::shared_ptr<PluginCache> m_pluginCache;
+
+        absl::Mutex m_lock;
+        absl::flat_hash_set<tempo_utils::UrlPath> m_materialized ABSL_GUARDED_BY(m_lock);
+        // objects which have been verified, keyed by entry path. the object contents are held weakly
+        // so that a compressed entry is only decompressed again once every loaded copy is released.
+        absl::flat_hash_map<tempo_utils::UrlPath,std::weak_ptr<const tempo_utils::ImmutableBytes>> m_objects
+            ABSL_GUARDED_BY(m_lock);
 
         PackageReaderLoader(
             std::shared_ptr<PackageReader> reader,
             const PackageSpecifier &specifier,
             const std::filesystem::path &packageDirectory,
-            const std::filesystem::path &tempDirectory);
+            const std::filesystem::path &tempDirectory,
+            bool isExtracted,
+            std::shared_ptr<PluginCache> pluginCache);
 
-        tempo_utils::Result<std::filesystem::path> findModule(
+        tempo_utils::Result<tempo_utils::UrlPath> findEntry(
             const lyric_common::ModuleLocation &location,
             std::string_view dotSuffix) const;
+        tempo_utils::Result<std::filesystem::path> materializeEntry(const tempo_utils::UrlPath &entryPath);
+        tempo_utils::Status materializeLibraries();
     };
 }
 
-#endif // ZURI_PACKAGER_PACKAGE_READER_LOADER_H
\ No newline at end of file
+#endif // ZURI_PACKAGER_PACKAGE_READER_LOADER_H
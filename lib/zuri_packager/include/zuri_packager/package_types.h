@@ -33,9 +33,11 @@ namespace zuri_packager {
     enum class EntryType {
         Invalid,
         File,
+        CompressedFile,
         Directory,
         Link,
         Package,
+        Dictionary,
     };
 
     struct PrologueEntry {
@@ -44,12 +44,46 @@ namespace zuri_packager {
          * if true, then if the package file already exists in the install root it will be overwritten.
          */
         bool overwriteFile = false;
+        /**
+         * if true, then file contents are spooled to a temporary data file in the install root as
+         * they are added, instead of being held in memory until the package is written. this bounds
+         * the memory used by the writer regardless of the size of the package.
+         */
+        bool spoolContents = false;
+        /**
+         * if true, then file contents are compressed using zstd when the package is written. a file
+         * is stored compressed only if compression reduces its size.
+         */
+        bool compressFiles = false;
+        /**
+         * the zstd compression level used when compressFiles is true.
+         */
+        int compressionLevel = 3;
+        /**
+         * if true and compressFiles is true, then a dictionary is trained from the file contents and
+         * stored in the package as a dictionary entry, and files are compressed against it.
+         */
+        bool trainDictionary = false;
+        /**
+         * the maximum size in bytes of the trained dictionary.
+         */
+        tu_uint32 maxDictionarySize = 112640;
+        /**
+         * the maximum total size in bytes of the file contents sampled to train the dictionary. at
+         * most maxDictionarySampleSize bytes are sampled from the start of each file.
+         */
+        tu_uint64 maxDictionarySamplesSize = 8 * 1024 * 1024;
+        /**
+         * the maximum size in bytes sampled from a single file to train the dictionary.
+         */
+        tu_uint32 maxDictionarySampleSize = 128 * 1024;
     };
 
     class PackageWriter {
 
     public:
         explicit PackageWriter(const PackageSpecifier &specifier, const PackageWriterOptions &options = {});
+        ~PackageWriter();
 
         tempo_utils::Status configure();
 
@@ -70,6 +104,9 @@ namespace zuri_packager {
         tempo_utils::Result<EntryAddress> putFile(
             const tempo_utils::UrlPath &path,
             std::shared_ptr<const tempo_utils::ImmutableBytes> bytes);
+        tempo_utils::Result<EntryAddress> putFile(
+            const tempo_utils::UrlPath &path,
+            const std::filesystem::path &sourcePath);
         tempo_utils::Result<EntryAddress> linkToTarget(
             const tempo_utils::UrlPath &path,
             EntryAddress target);
@@ -83,12 +120,30 @@ namespace zuri_packager {
         PackageSpecifier m_specifier;
         PackageWriterOptions m_options;
 
+        struct FileContent {
+            std::shared_ptr<const tempo_utils::ImmutableBytes> bytes;
+            std::filesystem::path sourcePath;
+            tu_uint64 spoolOffset = 0;
+            tu_uint64 size = 0;
+        };
+
         std::unique_ptr<ManifestState> m_state;
         ManifestEntry *m_packageEntry;
-        absl::flat_hash_map<
-            tempo_utils::UrlPath,
-            std::shared_ptr<const tempo_utils::ImmutableBytes>> m_contents;
+        absl::flat_hash_map<tempo_utils::UrlPath,FileContent> m_contents;
+        absl::flat_hash_map<tu_uint32,FileContent> m_dictionaries;
         tempo_config::ConfigMap m_config;
+        int m_spoolFd;
+        tu_uint64 m_spoolSize;
+
+        tempo_utils::Status storeContent(
+            const tempo_utils::UrlPath &path,
+            std::shared_ptr<const tempo_utils::ImmutableBytes> bytes);
+        tempo_utils::Result<FileContent> spoolContent(std::shared_ptr<const tempo_utils::ImmutableBytes> bytes);
+        const FileContent *findContent(const ManifestEntry *entry) const;
+        tempo_utils::Status writeContent(int fd, const FileContent &content);
+        tempo_utils::Result<std::shared_ptr<const tempo_utils::ImmutableBytes>> loadContent(
+            const FileContent &content);
+        tempo_utils::Status compressContents();
 
     public:
         /**
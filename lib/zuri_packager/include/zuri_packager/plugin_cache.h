@@ -0,0 +1,72 @@
+#ifndef ZURI_PACKAGER_PLUGIN_CACHE_H
+#define ZURI_PACKAGER_PLUGIN_CACHE_H
+
+#include <filesystem>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include <lyric_runtime/abstract_loader.h>
+#include <tempo_utils/result.h>
+
+#include "object_cache.h"
+
+namespace zuri_packager {
+
+    struct PluginCacheOptions {
+        /**
+         * the maximum number of plugins retained by the cache. plugins which are in use are never
+         * evicted, so the cache may temporarily hold more plugins than this. when the limit is
+         * exceeded, the least recently loaded plugins which are not in use are released.
+         */
+        int maxCachedPlugins = 64;
+    };
+
+    /**
+     * Loads plugin libraries and shares the loaded plugins. Plugins are keyed by the canonical
+     * path of the library and the identity of the file contents, so a library which is replaced
+     * on disk is loaded again rather than returning the stale plugin. While the previous version
+     * is still loaded, the replacement is loaded from a private copy of the library.
+     */
+    class PluginCache {
+    public:
+        explicit PluginCache(const PluginCacheOptions &options = {});
+
+        static std::shared_ptr<PluginCache> processCache();
+
+        tempo_utils::Result<Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>>> loadPlugin(
+            const std::filesystem::path &pluginPath);
+
+        void evictUnused();
+        int numCachedPlugins() const;
+
+    private:
+        PluginCacheOptions m_options;
+
+        struct PluginKey {
+            std::string canonicalPath;
+            ObjectFileIdentity identity;
+
+            bool operator==(const PluginKey &other) const {
+                return canonicalPath == other.canonicalPath && identity == other.identity;
+            }
+
+            template <typename H>
+            friend H AbslHashValue(H h, const PluginKey &key) {
+                return H::combine(std::move(h), key.canonicalPath, key.identity);
+            }
+        };
+        struct PluginEntry {
+            std::shared_ptr<const lyric_runtime::AbstractPlugin> plugin;
+            tu_uint64 lastLoaded;
+        };
+
+        mutable absl::Mutex m_lock;
+        absl::flat_hash_map<PluginKey,PluginEntry> m_plugins ABSL_GUARDED_BY(m_lock);
+        tu_uint64 m_clock ABSL_GUARDED_BY(m_lock);
+
+        void evict(int maxCachedPlugins) ABSL_EXCLUSIVE_LOCKS_REQUIRED(m_lock);
+    };
+}
+
+#endif // ZURI_PACKAGER_PLUGIN_CACHE_H
@@ -26,6 +26,12 @@ zuri_packager::EntryWalker::isValid() const
     return m_reader && m_reader->isValid() && m_index < m_reader->numEntries();
 }
 
+tu_uint32
+zuri_packager::EntryWalker::getAddress() const
+{
+    return m_index;
+}
+
 zuri_packager::EntryType
 zuri_packager::EntryWalker::getEntryType() const
 {
@@ -35,12 +41,16 @@ zuri_packager::EntryWalker::getEntryType() const
     switch (entry->entry_type()) {
         case zpk1::EntryType::File:
             return EntryType::File;
+        case zpk1::EntryType::CompressedFile:
+            return EntryType::CompressedFile;
         case zpk1::EntryType::Directory:
             return EntryType::Directory;
         case zpk1::EntryType::Link:
             return EntryType::Link;
         case zpk1::EntryType::Package:
             return EntryType::Package;
+        case zpk1::EntryType::Dictionary:
+            return EntryType::Dictionary;
         default:
             return EntryType::Invalid;
     }
@@ -75,6 +85,17 @@ zuri_packager::EntryWalker::getFileSize() const
     return entry->entry_size();
 }
 
+zuri_packager::EntryWalker
+zuri_packager::EntryWalker::getDict() const
+{
+    auto *entry = m_reader->getEntry(m_index);
+    if (entry == nullptr)
+        return {};
+    if (entry->entry_dict() == kInvalidOffsetU32)
+        return {};
+    return EntryWalker(m_reader, entry->entry_dict());
+}
+
 zuri_packager::EntryWalker
 zuri_packager::EntryWalker::getLink() const
 {
@@ -24,6 +24,12 @@ zuri_packager::ManifestEntry::getEntryType() const
     return m_type;
 }
 
+void
+zuri_packager::ManifestEntry::setEntryType(EntryType type)
+{
+    m_type = type;
+}
+
 tempo_utils::UrlPath
 zuri_packager::ManifestEntry::getEntryPath() const
 {
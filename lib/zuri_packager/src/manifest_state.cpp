@@ -132,7 +132,10 @@ zuri_packager::ManifestState::appendEntry(EntryType type, const tempo_utils::Url
         return PackagerStatus::forCondition(
             PackagerCondition::kDuplicateEntry, "entry already exists at path");
 
-    if (path.isEmpty()) {
+    if (type == EntryType::Dictionary) {
+        return PackagerStatus::forCondition(
+            PackagerCondition::kPackagerInvariant, "dictionary entry cannot be appended at a path");
+    } else if (path.isEmpty()) {
         // an empty path indicates the package (i.e. root) entry
         EntryAddress address(m_manifestEntries.size());
         auto *entry = new ManifestEntry(type, path, address, this);
@@ -157,6 +160,22 @@ zuri_packager::ManifestState::appendEntry(EntryType type, const tempo_utils::Url
     }
 }
 
+/**
+ * Append a dictionary entry. A dictionary entry has no path and is not a child of any directory,
+ * so it can never collide with a file in the package. It is only reachable by address from the
+ * compressed file entries which refer to it.
+ *
+ * @return The dictionary entry.
+ */
+zuri_packager::ManifestEntry *
+zuri_packager::ManifestState::appendDictionaryEntry()
+{
+    EntryAddress address(m_manifestEntries.size());
+    auto *entry = new ManifestEntry(EntryType::Dictionary, {}, address, this);
+    m_manifestEntries.push_back(entry);
+    return entry;
+}
+
 std::vector<zuri_packager::ManifestEntry *>::const_iterator
 zuri_packager::ManifestState::entriesBegin() const
 {
@@ -271,12 +290,18 @@ zuri_packager::ManifestState::toManifest() const
             case EntryType::File:
                 type = zpk1::EntryType::File;
                 break;
+            case EntryType::CompressedFile:
+                type = zpk1::EntryType::CompressedFile;
+                break;
             case EntryType::Directory:
                 type = zpk1::EntryType::Directory;
                 break;
             case EntryType::Link:
                 type = zpk1::EntryType::Link;
                 break;
+            case EntryType::Dictionary:
+                type = zpk1::EntryType::Dictionary;
+                break;
             default:
                 return PackagerStatus::forCondition(
                     PackagerCondition::kPackagerInvariant, "invalid entry type");
@@ -302,7 +327,9 @@ zuri_packager::ManifestState::toManifest() const
             entry->getEntryOffset(), entry->getEntrySize(),
             entry->getEntryDict().getAddress(), entry->getEntryLink().getAddress()));
 
-        // append path
+        // append path, dictionary entries have no path so they are not indexed
+        if (entry->getEntryType() == EntryType::Dictionary)
+            continue;
         paths_vector.push_back(zpk1::CreatePathDescriptor(buffer, fb_path, entry->getAddress().getAddress()));
     }
     auto fb_entries = buffer.CreateVector(entries_vector);
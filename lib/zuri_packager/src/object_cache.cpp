@@ -0,0 +1,179 @@
+
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <tempo_utils/log_stream.h>
+#include <zuri_packager/object_cache.h>
+#include <zuri_packager/packager_result.h>
+
+static zuri_packager::ObjectFileIdentity
+stat_to_identity(const struct stat &st)
+{
+    zuri_packager::ObjectFileIdentity identity;
+    identity.device = st.st_dev;
+    identity.inode = st.st_ino;
+#if defined(__APPLE__)
+    identity.mtimeNanos = (static_cast<tu_int64>(st.st_mtimespec.tv_sec) * 1000000000) + st.st_mtimespec.tv_nsec;
+#else
+    identity.mtimeNanos = (static_cast<tu_int64>(st.st_mtim.tv_sec) * 1000000000) + st.st_mtim.tv_nsec;
+#endif
+    identity.size = st.st_size;
+    return identity;
+}
+
+/**
+ * Stat the specified object file and return its identity.
+ *
+ * @param objectPath The path to the object file.
+ * @return The file identity, or a status if the file could not be stat'ed.
+ */
+tempo_utils::Result<zuri_packager::ObjectFileIdentity>
+zuri_packager::get_object_file_identity(const std::filesystem::path &objectPath)
+{
+    struct stat st;
+    if (::stat(objectPath.c_str(), &st) != 0)
+        return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+            "failed to stat object file {}", objectPath.string());
+    return stat_to_identity(st);
+}
+
+/**
+ * Read-only mapping of an object file, which is unmapped when destroyed.
+ */
+class MappedObjectBytes : public tempo_utils::ImmutableBytes {
+public:
+    MappedObjectBytes(void *addr, size_t size) : m_addr(addr), m_size(size) {};
+    ~MappedObjectBytes() override { ::munmap(m_addr, m_size); };
+    const tu_uint8 *getData() const override { return static_cast<const tu_uint8 *>(m_addr); };
+    tu_uint32 getSize() const override { return m_size; };
+
+private:
+    void *m_addr;
+    size_t m_size;
+};
+
+/**
+ * Open the object file and return the identity of the opened file, as reported by fstat on the
+ * file descriptor. The caller is responsible for closing the descriptor.
+ */
+static tempo_utils::Result<zuri_packager::ObjectFileIdentity>
+open_object_file(const std::filesystem::path &objectPath, int &fd)
+{
+    fd = ::open(objectPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return zuri_packager::PackagerStatus::forCondition(
+            zuri_packager::PackagerCondition::kPackagerInvariant,
+            "failed to open object file {}", objectPath.string());
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        fd = -1;
+        return zuri_packager::PackagerStatus::forCondition(
+            zuri_packager::PackagerCondition::kPackagerInvariant,
+            "failed to stat object file {}", objectPath.string());
+    }
+    return stat_to_identity(st);
+}
+
+/**
+ * Returns the object cache shared by all loaders in the process.
+ */
+std::shared_ptr<zuri_packager::ObjectCache>
+zuri_packager::ObjectCache::processCache()
+{
+    static auto cache = std::make_shared<ObjectCache>();
+    return cache;
+}
+
+/**
+ * Load the object file at the specified path. If the file is already mapped by a live object
+ * then the existing mapping is returned, otherwise the file is mapped. The contents are verified
+ * only the first time a given file identity is loaded. The identity is taken from the opened file
+ * descriptor rather than the path, so a file which is replaced while it is being loaded can never
+ * be mapped under the identity of the file it replaced.
+ *
+ * @param objectPath The path to the object file.
+ * @return The object, or a status if the file could not be mapped or failed verification.
+ */
+tempo_utils::Result<lyric_object::LyricObject>
+zuri_packager::ObjectCache::loadObject(const std::filesystem::path &objectPath)
+{
+    int fd;
+    ObjectFileIdentity identity;
+    TU_ASSIGN_OR_RETURN (identity, open_object_file(objectPath, fd));
+
+    bool verified = false;
+    {
+        absl::MutexLock locker(&m_lock);
+        auto entry = m_objects.find(identity);
+        if (entry != m_objects.cend()) {
+            auto bytes = entry->second.bytes.lock();
+            if (bytes != nullptr) {
+                ::close(fd);
+                return lyric_object::LyricObject(bytes);
+            }
+            verified = true;
+        }
+    }
+
+    if (identity.size == 0 || identity.size > std::numeric_limits<tu_uint32>::max()) {
+        ::close(fd);
+        return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+            "invalid size for object file {}", objectPath.string());
+    }
+    auto *addr = ::mmap(nullptr, identity.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+            "failed to map object file {}", objectPath.string());
+    std::shared_ptr<const tempo_utils::ImmutableBytes> bytes =
+        std::make_shared<const MappedObjectBytes>(addr, identity.size);
+
+    if (!verified) {
+        if (!lyric_object::LyricObject::verify(std::span<const tu_uint8>(bytes->getData(), bytes->getSize())))
+            return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+                "failed to verify object {}", objectPath.string());
+        TU_LOG_V << "verified object " << objectPath;
+    }
+
+    absl::MutexLock locker(&m_lock);
+    auto &entry = m_objects[identity];
+    auto existing = entry.bytes.lock();
+    if (existing != nullptr)
+        return lyric_object::LyricObject(existing);
+    entry.bytes = bytes;
+    return lyric_object::LyricObject(bytes);
+}
+
+/**
+ * Returns true if the current contents of the specified object file have already been verified.
+ */
+bool
+zuri_packager::ObjectCache::isVerified(const std::filesystem::path &objectPath) const
+{
+    auto identityResult = get_object_file_identity(objectPath);
+    if (identityResult.isStatus())
+        return false;
+    absl::MutexLock locker(&m_lock);
+    return m_objects.contains(identityResult.getResult());
+}
+
+/**
+ * Returns the number of objects which are currently mapped.
+ */
+int
+zuri_packager::ObjectCache::numMappedObjects() const
+{
+    absl::MutexLock locker(&m_lock);
+    int numMapped = 0;
+    for (const auto &entry : m_objects) {
+        if (!entry.second.bytes.expired()) {
+            numMapped++;
+        }
+    }
+    return numMapped;
+}
@@ -1,3 +1,7 @@
+#include <atomic>
+#include <thread>
+
+#include <absl/synchronization/mutex.h>
 
 #include <lyric_build/build_types.h>
 #include <tempo_config/base_conversions.h>
@@ -25,7 +29,7 @@ zuri_packager::PackageExtractor::configure()
         return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
             "extractor is already configured");
 
-    TU_ASSIGN_OR_RETURN (m_specifier, m_reader->readPackageSpecifier());
+    TU_ASSIGN_OR_RETURN (m_specifier, m_reader->getPackageSpecifier());
 
     return {};
 }
@@ -39,12 +43,16 @@ zuri_packager::PackageExtractor::extractRoot(const EntryWalker &root)
 
     m_pendingDirectories.push(root);
 
+    // create all directories up front, collecting file entries along the way
     while (!m_pendingDirectories.empty()) {
         auto curr = m_pendingDirectories.front();
         m_pendingDirectories.pop();
         TU_RETURN_IF_NOT_OK (extractChildren(curr));
     }
 
+    // write file contents
+    TU_RETURN_IF_NOT_OK (extractFiles());
+
     // resolve links
     while (!m_unresolvedLinks.empty()) {
         TU_RETURN_IF_NOT_OK (linkEntry(m_unresolvedLinks.front()));
@@ -67,8 +75,9 @@ zuri_packager::PackageExtractor::extractChildren(const EntryWalker &parent)
     for (int i = 0; i < parent.numChildren(); i++) {
         auto child = parent.getChild(i);
         switch (child.getEntryType()) {
-            case EntryType::File: {
-                TU_RETURN_IF_NOT_OK (extractFile(child));
+            case EntryType::File:
+            case EntryType::CompressedFile: {
+                m_pendingFiles.push_back(child);
                 break;
             }
             case EntryType::Directory: {
@@ -87,6 +96,57 @@ zuri_packager::PackageExtractor::extractChildren(const EntryWalker &parent)
     return {};
 }
 
+tempo_utils::Status
+zuri_packager::PackageExtractor::extractFiles()
+{
+    int numWorkers = m_options.numWorkers;
+    if (numWorkers <= 0) {
+        numWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    numWorkers = std::min<int>(numWorkers, m_pendingFiles.size());
+
+    // if there is at most one worker then write files serially on the calling thread
+    if (numWorkers <= 1) {
+        for (const auto &file : m_pendingFiles) {
+            TU_RETURN_IF_NOT_OK (extractFile(file));
+        }
+        m_pendingFiles.clear();
+        return {};
+    }
+
+    // otherwise each worker claims the next unwritten file until all files are written or a write fails
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    absl::Mutex lock;
+    tempo_utils::Status firstError;
+
+    auto work = [&]() {
+        while (!failed.load()) {
+            auto index = next.fetch_add(1);
+            if (index >= m_pendingFiles.size())
+                return;
+            auto status = extractFile(m_pendingFiles.at(index));
+            if (status.notOk()) {
+                absl::MutexLock locker(&lock);
+                if (!failed.exchange(true)) {
+                    firstError = status;
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < numWorkers; i++) {
+        workers.emplace_back(work);
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    m_pendingFiles.clear();
+    return firstError;
+}
+
 tempo_utils::Status
 zuri_packager::PackageExtractor::extractFile(const EntryWalker &file)
 {
@@ -94,6 +154,8 @@ zuri_packager::PackageExtractor::extractFile(const EntryWalker &file)
     auto filePath = relativePath.toFilesystemPath(m_workdirPath);
     tempo_utils::Slice slice;
     TU_ASSIGN_OR_RETURN (slice, m_reader->readFileContents(file.getPath()));
+    if (m_options.materializer != nullptr)
+        return m_options.materializer->materializeFile(slice, filePath);
     tempo_utils::FileWriter fileWriter(filePath, slice.toImmutableBytes(), tempo_utils::FileWriterMode::CREATE_ONLY);
     return fileWriter.getStatus();
 }
@@ -1,4 +1,10 @@
 
+#include <list>
+
+#include <zstd.h>
+
+#include <absl/container/flat_hash_map.h>
+
 #include <lyric_common/common_conversions.h>
 #include <tempo_config/base_conversions.h>
 #include <tempo_config/parse_config.h>
@@ -9,19 +15,53 @@
 #include <zuri_packager/packager_result.h>
 #include <zuri_packager/packaging_conversions.h>
 
+struct zuri_packager::PackageReader::DecompressCache {
+    absl::flat_hash_map<tu_uint32,ZSTD_DDict *> dictionaries;
+    std::list<std::pair<tu_uint32,tempo_utils::Slice>> recent;
+    absl::flat_hash_map<tu_uint32,std::list<std::pair<tu_uint32,tempo_utils::Slice>>::iterator> recentIndex;
+
+    ~DecompressCache()
+    {
+        for (auto &entry : dictionaries) {
+            ZSTD_freeDDict(entry.second);
+        }
+    }
+};
+
+/**
+ * Owns the decompressed contents of a compressed file entry.
+ */
+class DecompressedBytes : public tempo_utils::ImmutableBytes {
+public:
+    explicit DecompressedBytes(tu_uint32 size) : m_bytes(size) {};
+    tu_uint8 *data() { return m_bytes.data(); };
+    const tu_uint8 *getData() const override { return m_bytes.data(); };
+    tu_uint32 getSize() const override { return m_bytes.size(); };
+
+private:
+    std::vector<tu_uint8> m_bytes;
+};
+
 zuri_packager::PackageReader::PackageReader(
     tu_uint8 version,
     tu_uint8 flags,
     zuri_packager::ZuriManifest manifest,
-    tempo_utils::Slice contents)
+    tempo_utils::Slice contents,
+    const PackageReaderOptions &options)
     : m_version(version),
       m_flags(flags),
       m_manifest(manifest),
-      m_contents(contents)
+      m_contents(contents),
+      m_options(options),
+      m_decompressCache(std::make_unique<DecompressCache>())
 {
     TU_ASSERT (m_manifest.isValid());
 }
 
+zuri_packager::PackageReader::~PackageReader()
+{
+}
+
 bool
 zuri_packager::PackageReader::isValid() const
 {
@@ -46,12 +86,9 @@ zuri_packager::PackageReader::getManifest() const
     return m_manifest;
 }
 
-tempo_utils::Result<zuri_packager::PackageSpecifier>
-zuri_packager::PackageReader::readPackageSpecifier() const
+static tempo_utils::Result<zuri_packager::PackageSpecifier>
+parse_package_specifier(const tempo_config::ConfigMap &packageConfig)
 {
-    tempo_config::ConfigMap packageConfig;
-    TU_ASSIGN_OR_RETURN (packageConfig, readPackageConfig());
-
     tempo_config::StringParser nameParser;
     std::string packageName;
     TU_RETURN_IF_NOT_OK (tempo_config::parse_config(packageName, nameParser, packageConfig, "name"));
@@ -64,16 +101,13 @@ zuri_packager::PackageReader::readPackageSpecifier() const
     std::string packageDomain;
     TU_RETURN_IF_NOT_OK (tempo_config::parse_config(packageDomain, domainParser, packageConfig, "domain"));
 
-    return PackageSpecifier::fromString(absl::StrCat(
+    return zuri_packager::PackageSpecifier::fromString(absl::StrCat(
         packageName, "-", packageVersion, "@", packageDomain));
 }
 
-tempo_utils::Result<lyric_common::ModuleLocation>
-zuri_packager::PackageReader::readProgramMain() const
+static tempo_utils::Result<lyric_common::ModuleLocation>
+parse_program_main(const tempo_config::ConfigMap &packageConfig)
 {
-    tempo_config::ConfigMap packageConfig;
-    TU_ASSIGN_OR_RETURN (packageConfig, readPackageConfig());
-
     lyric_common::ModuleLocationParser programMainParser;
     lyric_common::ModuleLocation programMain;
     TU_RETURN_IF_NOT_OK (tempo_config::parse_config(programMain, programMainParser,
@@ -82,20 +116,41 @@ zuri_packager::PackageReader::readProgramMain() const
     return programMain;
 }
 
-tempo_utils::Result<zuri_packager::RequirementsMap>
-zuri_packager::PackageReader::readRequirementsMap() const
+static tempo_utils::Result<zuri_packager::RequirementsMap>
+parse_requirements_map(const tempo_config::ConfigMap &packageConfig)
 {
-    tempo_config::ConfigMap packageConfig;
-    TU_ASSIGN_OR_RETURN (packageConfig, readPackageConfig());
-
-    RequirementsMapParser requirementsMapParser(RequirementsMap{});
-    RequirementsMap requirementsMap;
+    zuri_packager::RequirementsMapParser requirementsMapParser(zuri_packager::RequirementsMap{});
+    zuri_packager::RequirementsMap requirementsMap;
     TU_RETURN_IF_NOT_OK (tempo_config::parse_config(requirementsMap, requirementsMapParser,
         packageConfig, "requirements"));
 
     return requirementsMap;
 }
 
+tempo_utils::Result<zuri_packager::PackageSpecifier>
+zuri_packager::PackageReader::readPackageSpecifier() const
+{
+    tempo_config::ConfigMap packageConfig;
+    TU_ASSIGN_OR_RETURN (packageConfig, readPackageConfig());
+    return parse_package_specifier(packageConfig);
+}
+
+tempo_utils::Result<lyric_common::ModuleLocation>
+zuri_packager::PackageReader::readProgramMain() const
+{
+    tempo_config::ConfigMap packageConfig;
+    TU_ASSIGN_OR_RETURN (packageConfig, readPackageConfig());
+    return parse_program_main(packageConfig);
+}
+
+tempo_utils::Result<zuri_packager::RequirementsMap>
+zuri_packager::PackageReader::readRequirementsMap() const
+{
+    tempo_config::ConfigMap packageConfig;
+    TU_ASSIGN_OR_RETURN (packageConfig, readPackageConfig());
+    return parse_requirements_map(packageConfig);
+}
+
 tempo_utils::Result<tempo_config::ConfigMap>
 zuri_packager::PackageReader::readPackageConfig() const
 {
@@ -112,14 +167,103 @@ zuri_packager::PackageReader::readPackageConfig() const
     return packageConfig.toMap();
 }
 
+/**
+ * Parse the package config and the values derived from it the first time any of them is requested.
+ * The parse status of each value is cached along with the value, so a package which is missing an
+ * optional field (such as programMain) is only parsed once as well.
+ *
+ * @return The config cache. The returned pointer remains valid for the lifetime of the reader.
+ */
+const zuri_packager::PackageReader::ConfigCache *
+zuri_packager::PackageReader::loadConfigCache() const
+{
+    absl::MutexLock locker(&m_lock);
+    if (m_configCache != nullptr)
+        return m_configCache.get();
+
+    auto cache = std::make_unique<ConfigCache>();
+
+    auto readConfigResult = readPackageConfig();
+    if (readConfigResult.isStatus()) {
+        cache->configStatus = readConfigResult.getStatus();
+        cache->specifierStatus = cache->configStatus;
+        cache->programMainStatus = cache->configStatus;
+        cache->requirementsStatus = cache->configStatus;
+    } else {
+        cache->packageConfig = readConfigResult.getResult();
+
+        auto parseSpecifierResult = parse_package_specifier(cache->packageConfig);
+        if (parseSpecifierResult.isStatus()) {
+            cache->specifierStatus = parseSpecifierResult.getStatus();
+        } else {
+            cache->specifier = parseSpecifierResult.getResult();
+        }
+
+        auto parseProgramMainResult = parse_program_main(cache->packageConfig);
+        if (parseProgramMainResult.isStatus()) {
+            cache->programMainStatus = parseProgramMainResult.getStatus();
+        } else {
+            cache->programMain = parseProgramMainResult.getResult();
+        }
+
+        auto parseRequirementsResult = parse_requirements_map(cache->packageConfig);
+        if (parseRequirementsResult.isStatus()) {
+            cache->requirementsStatus = parseRequirementsResult.getStatus();
+        } else {
+            cache->requirementsMap = parseRequirementsResult.getResult();
+        }
+    }
+
+    m_configCache = std::move(cache);
+    return m_configCache.get();
+}
+
+tempo_utils::Result<zuri_packager::PackageSpecifier>
+zuri_packager::PackageReader::getPackageSpecifier() const
+{
+    auto *cache = loadConfigCache();
+    TU_RETURN_IF_NOT_OK (cache->specifierStatus);
+    return cache->specifier;
+}
+
+tempo_utils::Result<lyric_common::ModuleLocation>
+zuri_packager::PackageReader::getProgramMain() const
+{
+    auto *cache = loadConfigCache();
+    TU_RETURN_IF_NOT_OK (cache->programMainStatus);
+    return cache->programMain;
+}
+
+tempo_utils::Result<zuri_packager::RequirementsMap>
+zuri_packager::PackageReader::getRequirementsMap() const
+{
+    auto *cache = loadConfigCache();
+    TU_RETURN_IF_NOT_OK (cache->requirementsStatus);
+    return cache->requirementsMap;
+}
+
+tempo_utils::Result<tempo_config::ConfigMap>
+zuri_packager::PackageReader::getPackageConfig() const
+{
+    auto *cache = loadConfigCache();
+    TU_RETURN_IF_NOT_OK (cache->configStatus);
+    return cache->packageConfig;
+}
+
 static tempo_utils::Result<tempo_utils::Slice>
 get_file_entry_contents(
     const zuri_packager::EntryWalker &walker,
     const tempo_utils::Slice &contents)
 {
-    if (walker.getEntryType() != zuri_packager::EntryType::File)
-        return zuri_packager::PackagerStatus::forCondition(zuri_packager::PackagerCondition::kInvalidManifest,
-            "invalid entry type");
+    switch (walker.getEntryType()) {
+        case zuri_packager::EntryType::File:
+        case zuri_packager::EntryType::CompressedFile:
+        case zuri_packager::EntryType::Dictionary:
+            break;
+        default:
+            return zuri_packager::PackagerStatus::forCondition(zuri_packager::PackagerCondition::kInvalidManifest,
+                "invalid entry type");
+    }
     if (contents.getSize() < walker.getFileOffset())
         return zuri_packager::PackagerStatus::forCondition(zuri_packager::PackagerCondition::kInvalidManifest,
             "invalid file entry offset");
@@ -139,18 +283,125 @@ zuri_packager::PackageReader::readFileContents(const tempo_utils::UrlPath &entry
     auto entry = m_manifest.getEntry(entryPath);
     switch (entry.getEntryType()) {
         case EntryType::File:
-            return get_file_entry_contents(entry, m_contents);
+        case EntryType::CompressedFile:
+            return readEntryContents(entry);
         case EntryType::Link:
             if (!followSymlinks)
                 return PackagerStatus::forCondition(PackagerCondition::kInvalidManifest,
                     "invalid entry type");
-            return get_file_entry_contents(entry.resolveLink(), m_contents);
+            return readEntryContents(entry.resolveLink());
         default:
             return PackagerStatus::forCondition(PackagerCondition::kInvalidManifest,
                 "invalid entry type");
     }
 }
 
+tempo_utils::Result<tempo_utils::Slice>
+zuri_packager::PackageReader::readEntryContents(const EntryWalker &entry) const
+{
+    if (entry.getEntryType() == EntryType::CompressedFile)
+        return decompressEntry(entry);
+    return get_file_entry_contents(entry, m_contents);
+}
+
+/**
+ * Decompress the contents of the specified compressed file entry. If the entry refers to a dictionary
+ * then the digested dictionary is created on first use and reused for all entries which refer to it.
+ * If the reader was created with a non-zero decompressedCacheSize, then the most recently decompressed
+ * contents are retained and returned directly on subsequent reads. An entry whose decompressed size
+ * exceeds maxDecompressedEntrySize is rejected before any memory is allocated for it.
+ *
+ * @param entry The compressed file entry.
+ * @return A slice containing the decompressed contents.
+ */
+tempo_utils::Result<tempo_utils::Slice>
+zuri_packager::PackageReader::decompressEntry(const EntryWalker &entry) const
+{
+    auto index = entry.getAddress();
+
+    if (m_options.decompressedCacheSize > 0) {
+        absl::MutexLock locker(&m_decompressLock);
+        auto &cache = *m_decompressCache;
+        auto recentEntry = cache.recentIndex.find(index);
+        if (recentEntry != cache.recentIndex.cend()) {
+            cache.recent.splice(cache.recent.begin(), cache.recent, recentEntry->second);
+            return recentEntry->second->second;
+        }
+    }
+
+    tempo_utils::Slice compressed;
+    TU_ASSIGN_OR_RETURN (compressed, get_file_entry_contents(entry, m_contents));
+
+    auto contentSize = ZSTD_getFrameContentSize(compressed.getData(), compressed.getSize());
+    if (contentSize == ZSTD_CONTENTSIZE_UNKNOWN || contentSize == ZSTD_CONTENTSIZE_ERROR)
+        return PackagerStatus::forCondition(PackagerCondition::kInvalidManifest,
+            "invalid compressed entry {}", entry.getPath().toString());
+    if (contentSize > m_options.maxDecompressedEntrySize)
+        return PackagerStatus::forCondition(PackagerCondition::kInvalidManifest,
+            "compressed entry {} size {} exceeds the maximum decompressed entry size {}",
+            entry.getPath().toString(), contentSize, m_options.maxDecompressedEntrySize);
+
+    // if the entry has a dictionary then get the digested dictionary, creating it if necessary
+    ZSTD_DDict *ddict = nullptr;
+    auto dict = entry.getDict();
+    if (dict.isValid()) {
+        if (dict.getEntryType() != EntryType::Dictionary)
+            return PackagerStatus::forCondition(PackagerCondition::kInvalidManifest,
+                "invalid dictionary for compressed entry {}", entry.getPath().toString());
+        tempo_utils::Slice dictContents;
+        TU_ASSIGN_OR_RETURN (dictContents, get_file_entry_contents(dict, m_contents));
+
+        absl::MutexLock locker(&m_decompressLock);
+        auto &dictionaries = m_decompressCache->dictionaries;
+        auto dictEntry = dictionaries.find(dict.getAddress());
+        if (dictEntry != dictionaries.cend()) {
+            ddict = dictEntry->second;
+        } else {
+            ddict = ZSTD_createDDict(dictContents.getData(), dictContents.getSize());
+            if (ddict == nullptr)
+                return PackagerStatus::forCondition(PackagerCondition::kInvalidManifest,
+                    "invalid dictionary for compressed entry {}", entry.getPath().toString());
+            dictionaries[dict.getAddress()] = ddict;
+        }
+    }
+
+    // decompress directly into the bytes which back the returned slice
+    auto decompressed = std::make_shared<DecompressedBytes>(contentSize);
+    auto *dctx = ZSTD_createDCtx();
+    size_t ret;
+    if (ddict != nullptr) {
+        ret = ZSTD_decompress_usingDDict(dctx, decompressed->data(), decompressed->getSize(),
+            compressed.getData(), compressed.getSize(), ddict);
+    } else {
+        ret = ZSTD_decompressDCtx(dctx, decompressed->data(), decompressed->getSize(),
+            compressed.getData(), compressed.getSize());
+    }
+    ZSTD_freeDCtx(dctx);
+    if (ZSTD_isError(ret))
+        return PackagerStatus::forCondition(PackagerCondition::kInvalidManifest,
+            "failed to decompress entry {}: {}", entry.getPath().toString(), ZSTD_getErrorName(ret));
+    if (ret != contentSize)
+        return PackagerStatus::forCondition(PackagerCondition::kInvalidManifest,
+            "invalid decompressed size for entry {}", entry.getPath().toString());
+
+    tempo_utils::Slice slice(decompressed, 0, decompressed->getSize());
+
+    if (m_options.decompressedCacheSize > 0) {
+        absl::MutexLock locker(&m_decompressLock);
+        auto &cache = *m_decompressCache;
+        if (!cache.recentIndex.contains(index)) {
+            cache.recent.emplace_front(index, slice);
+            cache.recentIndex[index] = cache.recent.begin();
+            while (std::cmp_greater(cache.recent.size(), m_options.decompressedCacheSize)) {
+                cache.recentIndex.erase(cache.recent.back().first);
+                cache.recent.pop_back();
+            }
+        }
+    }
+
+    return slice;
+}
+
 // tempo_utils::Result<tu_uint32>
 // zuri_packager::PackageReader::readFileSize(const tempo_utils::UrlPath &entryPath, bool followSymlinks) const
 // {
@@ -175,10 +426,13 @@ zuri_packager::PackageReader::readFileContents(const tempo_utils::UrlPath &entry
 /**
  *
  * @param packageBytes
+ * @param options
  * @return
  */
 tempo_utils::Result<std::shared_ptr<zuri_packager::PackageReader>>
-zuri_packager::PackageReader::create(std::shared_ptr<const tempo_utils::ImmutableBytes> packageBytes)
+zuri_packager::PackageReader::create(
+    std::shared_ptr<const tempo_utils::ImmutableBytes> packageBytes,
+    const PackageReaderOptions &options)
 {
     auto *mmapData = packageBytes->getData();
     auto mmapSize = packageBytes->getSize();
@@ -217,21 +471,24 @@ zuri_packager::PackageReader::create(std::shared_ptr<const tempo_utils::Immutabl
     tempo_utils::Slice contents(packageBytes, dataOffset, mmapSize - dataOffset);
 
     return std::shared_ptr<PackageReader>(new PackageReader(
-        version, flags, manifest, contents));
+        version, flags, manifest, contents, options));
 }
 
 /**
  *
  * @param packagePath
+ * @param options
  * @return
  */
 tempo_utils::Result<std::shared_ptr<zuri_packager::PackageReader>>
-zuri_packager::PackageReader::open(const std::filesystem::path &packagePath)
+zuri_packager::PackageReader::open(
+    const std::filesystem::path &packagePath,
+    const PackageReaderOptions &options)
 {
     auto mmapFileResult = tempo_utils::MemoryMappedBytes::open(packagePath);
     if (mmapFileResult.isStatus())
         return mmapFileResult.getStatus();
     auto bytes = mmapFileResult.getResult();
 
-    return create(static_pointer_cast<const tempo_utils::ImmutableBytes>(bytes));
+    return create(static_pointer_cast<const tempo_utils::ImmutableBytes>(bytes), options);
 }
\ No newline at end of file
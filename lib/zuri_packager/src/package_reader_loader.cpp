@@ -1,12 +1,12 @@
-
 #include <absl/strings/str_join.h>
 #include <absl/strings/str_split.h>
 
 #include <lyric_common/common_types.h>
 #include <lyric_common/plugin.h>
-#include <lyric_runtime/library_plugin.h>
+#include <tempo_utils/directory_maker.h>
 #include <tempo_utils/file_reader.h>
-#include <tempo_utils/library_loader.h>
+#include <tempo_utils/file_writer.h>
+#include <tempo_utils/immutable_bytes.h>
 #include <tempo_utils/log_stream.h>
 #include <tempo_utils/platform.h>
 #include <tempo_utils/tempdir_maker.h>
@@ -14,26 +14,46 @@
 #include <zuri_packager/package_extractor.h>
 #include <zuri_packager/package_reader_loader.h>
 
+/**
+ * ImmutableBytes view of a slice. The slice holds a reference to the underlying bytes, so the view
+ * keeps the mapped package contents alive without copying them.
+ */
+class SliceBytes : public tempo_utils::ImmutableBytes {
+public:
+    explicit SliceBytes(const tempo_utils::Slice &slice) : m_slice(slice) {};
+    const tu_uint8 *getData() const override { return m_slice.getData(); };
+    tu_uint32 getSize() const override { return m_slice.getSize(); };
+
+private:
+    tempo_utils::Slice m_slice;
+};
+
 zuri_packager::PackageReaderLoader::PackageReaderLoader(
     std::shared_ptr<PackageReader> reader,
     const PackageSpecifier &specifier,
     const std::filesystem::path &packageDirectory,
-    const std::filesystem::path &tempDirectory)
+    const std::filesystem::path &tempDirectory,
+    bool isExtracted,
+    std::shared_ptr<PluginCache> pluginCache)
     : m_reader(std::move(reader)),
       m_specifier(specifier),
       m_packageDirectory(packageDirectory),
-      m_tempDirectory(tempDirectory)
+      m_tempDirectory(tempDirectory),
+      m_isExtracted(isExtracted),
+      m_pluginCache(std::move(pluginCache))
 {
     TU_ASSERT (m_reader != nullptr);
     TU_ASSERT (m_specifier.isValid());
     TU_ASSERT (!m_packageDirectory.empty());
     TU_ASSERT (!m_tempDirectory.empty());
+    TU_ASSERT (m_pluginCache != nullptr);
 }
 
 tempo_utils::Result<std::shared_ptr<zuri_packager::PackageReaderLoader>>
 zuri_packager::PackageReaderLoader::create(
     std::shared_ptr<PackageReader> reader,
-    const std::filesystem::path &tempRoot)
+    const std::filesystem::path &tempRoot,
+    const PackageReaderLoaderOptions &options)
 {
     if (reader == nullptr)
         return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
@@ -43,78 +63,180 @@ zuri_packager::PackageReaderLoader::create(
             "invalid temp root '{}'", tempRoot.string());
 
     PackageSpecifier specifier;
-    TU_ASSIGN_OR_RETURN (specifier, reader->readPackageSpecifier());
+    TU_ASSIGN_OR_RETURN (specifier, reader->getPackageSpecifier());
+
+    auto pluginCache = options.pluginCache;
+    if (pluginCache == nullptr) {
+        pluginCache = PluginCache::processCache();
+    }
 
     tempo_utils::TempdirMaker packageRoot(tempRoot, "XXXXXXXX");
     TU_RETURN_IF_NOT_OK (packageRoot.getStatus());
     auto tempDirectory = packageRoot.getTempdir();
 
-    PackageExtractorOptions options;
-    options.workingRoot = tempDirectory;
-    options.destinationRoot = tempDirectory;
-    PackageExtractor extractor(reader, options);
+    // if extraction is not requested then files are materialized into the package directory on demand
+    if (!options.extractPackage) {
+        auto packageDirectory = specifier.toDirectoryPath(tempDirectory);
+        return std::shared_ptr<PackageReaderLoader>(new PackageReaderLoader(
+            std::move(reader), specifier, packageDirectory, tempDirectory, false, pluginCache));
+    }
+
+    PackageExtractorOptions extractorOptions;
+    extractorOptions.workingRoot = tempDirectory;
+    extractorOptions.destinationRoot = tempDirectory;
+    PackageExtractor extractor(reader, extractorOptions);
     TU_RETURN_IF_NOT_OK (extractor.configure());
 
     std::filesystem::path packageDirectory;
     TU_ASSIGN_OR_RETURN (packageDirectory, extractor.extractPackage());
 
     return std::shared_ptr<PackageReaderLoader>(new PackageReaderLoader(
-        std::move(reader), specifier, packageDirectory, tempDirectory));
+        std::move(reader), specifier, packageDirectory, tempDirectory, true, pluginCache));
 }
 
-tempo_utils::Result<std::filesystem::path>
-zuri_packager::PackageReaderLoader::findModule(
+tempo_utils::Result<tempo_utils::UrlPath>
+zuri_packager::PackageReaderLoader::findEntry(
     const lyric_common::ModuleLocation &location,
     std::string_view dotSuffix) const
 {
     if (!location.isValid() || location.getScheme() != "dev.zuri.pkg")
-        return std::filesystem::path{};
+        return tempo_utils::UrlPath{};
     auto specifier = PackageSpecifier::fromAuthority(location.getAuthority());
     if (!specifier.isValid())
-        return std::filesystem::path{};
+        return tempo_utils::UrlPath{};
 
     if (specifier != m_specifier)
-        return std::filesystem::path{};
+        return tempo_utils::UrlPath{};
 
-    auto modulesPath = m_packageDirectory / "modules";
-    auto modulePath = location.getPath().toFilesystemPath(modulesPath);
+    auto modulePath = location.getPath().toFilesystemPath("/modules");
     modulePath.replace_extension(dotSuffix);
-
     if (modulePath.empty())
-        return std::filesystem::path{};
-    if (!std::filesystem::is_regular_file(modulePath))
-        return std::filesystem::path{};
-    return modulePath;
+        return tempo_utils::UrlPath{};
+
+    auto entryPath = tempo_utils::UrlPath::fromString(modulePath.string());
+    auto manifest = m_reader->getManifest();
+    if (!manifest.hasEntry(entryPath))
+        return tempo_utils::UrlPath{};
+    auto entry = manifest.getEntry(entryPath);
+    switch (entry.getEntryType()) {
+        case EntryType::File:
+        case EntryType::CompressedFile:
+            break;
+        default:
+            return tempo_utils::UrlPath{};
+    }
+    return entryPath;
+}
+
+/**
+ * Write the contents of the specified file entry into the package directory, unless the entry
+ * has already been written.
+ *
+ * @param entryPath The path of the file entry in the package.
+ * @return The absolute path of the materialized file.
+ */
+tempo_utils::Result<std::filesystem::path>
+zuri_packager::PackageReaderLoader::materializeEntry(const tempo_utils::UrlPath &entryPath)
+{
+    auto filePath = entryPath.toRelative().toFilesystemPath(m_packageDirectory);
+    if (m_isExtracted)
+        return filePath;
+
+    absl::MutexLock locker(&m_lock);
+
+    if (m_materialized.contains(entryPath))
+        return filePath;
+
+    tempo_utils::DirectoryMaker directoryMaker(filePath.parent_path());
+    TU_RETURN_IF_NOT_OK (directoryMaker.getStatus());
+
+    tempo_utils::Slice slice;
+    TU_ASSIGN_OR_RETURN (slice, m_reader->readFileContents(entryPath));
+    tempo_utils::FileWriter fileWriter(filePath, slice.toImmutableBytes(), tempo_utils::FileWriterMode::CREATE_ONLY);
+    TU_RETURN_IF_NOT_OK (fileWriter.getStatus());
+
+    m_materialized.insert(entryPath);
+    TU_LOG_V << "materialized " << entryPath.toString() << " to " << filePath;
+    return filePath;
+}
+
+/**
+ * Materialize the libraries bundled in the package, so that the relative rpath of a materialized
+ * plugin resolves the same way it does in an extracted package.
+ *
+ * @return Status
+ */
+tempo_utils::Status
+zuri_packager::PackageReaderLoader::materializeLibraries()
+{
+    if (m_isExtracted)
+        return {};
+
+    auto libPath = tempo_utils::UrlPath::fromString("/lib");
+    auto manifest = m_reader->getManifest();
+    if (!manifest.hasEntry(libPath))
+        return {};
+
+    auto libEntry = manifest.getEntry(libPath);
+    for (int i = 0; i < libEntry.numChildren(); i++) {
+        auto child = libEntry.getChild(i);
+        auto childType = child.getEntryType();
+        if (childType != EntryType::File && childType != EntryType::CompressedFile)
+            continue;
+        TU_RETURN_IF_STATUS (materializeEntry(child.getPath()));
+    }
+    return {};
 }
 
 tempo_utils::Result<bool>
 zuri_packager::PackageReaderLoader::hasModule(const lyric_common::ModuleLocation &location) const
 {
-    std::filesystem::path absolutePath;
-    TU_ASSIGN_OR_RETURN (absolutePath, findModule(location, lyric_common::kObjectFileDotSuffix));
-    return !absolutePath.empty();
+    tempo_utils::UrlPath entryPath;
+    TU_ASSIGN_OR_RETURN (entryPath, findEntry(location, lyric_common::kObjectFileDotSuffix));
+    return entryPath.isValid();
 }
 
 tempo_utils::Result<Option<lyric_object::LyricObject>>
 zuri_packager::PackageReaderLoader::loadModule(const lyric_common::ModuleLocation &location)
 {
-    std::filesystem::path absolutePath;
-    TU_ASSIGN_OR_RETURN (absolutePath, findModule(location, lyric_common::kObjectFileDotSuffix));
-    if (absolutePath.empty())
+    tempo_utils::UrlPath entryPath;
+    TU_ASSIGN_OR_RETURN (entryPath, findEntry(location, lyric_common::kObjectFileDotSuffix));
+    if (!entryPath.isValid())
         return Option<lyric_object::LyricObject>();
 
-    tempo_utils::FileReader reader(absolutePath.string());
-    if (!reader.isValid())
-        return reader.getStatus();
-    auto bytes = reader.getBytes();
+    // return the existing object contents if a previously loaded copy is still alive
+    bool verified = false;
+    {
+        absl::MutexLock locker(&m_lock);
+        auto entry = m_objects.find(entryPath);
+        if (entry != m_objects.cend()) {
+            auto bytes = entry->second.lock();
+            if (bytes != nullptr)
+                return Option(lyric_object::LyricObject(bytes));
+            verified = true;
+        }
+    }
 
-    // verify that file contents is a valid object
-    if (!lyric_object::LyricObject::verify(std::span<const tu_uint8>(bytes->getData(), bytes->getSize())))
-        return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
-            "failed to verify object");
+    // unless the entry is compressed, the slice refers directly into the mapped package contents
+    tempo_utils::Slice slice;
+    TU_ASSIGN_OR_RETURN (slice, m_reader->readFileContents(entryPath));
+    std::shared_ptr<const tempo_utils::ImmutableBytes> bytes = std::make_shared<const SliceBytes>(slice);
+
+    // verify that file contents is a valid object. the package contents are immutable, so each
+    // entry only needs to be verified once.
+    if (!verified) {
+        if (!lyric_object::LyricObject::verify(std::span<const tu_uint8>(bytes->getData(), bytes->getSize())))
+            return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+                "failed to verify object");
+    }
+
+    {
+        absl::MutexLock locker(&m_lock);
+        m_objects[entryPath] = bytes;
+    }
 
     // return platform-specific LyricObject
-    TU_LOG_V << "loaded module at " << absolutePath;
+    TU_LOG_V << "loaded module " << entryPath.toString() << " from package " << m_specifier.toString();
     return Option(lyric_object::LyricObject(bytes));
 }
 
@@ -123,35 +245,17 @@ zuri_packager::PackageReaderLoader::loadPlugin(
     const lyric_common::ModuleLocation &location,
     const lyric_object::PluginSpecifier &specifier)
 {
-    std::filesystem::path absolutePath;
-    TU_ASSIGN_OR_RETURN (absolutePath, findModule(location, absl::StrCat(
+    tempo_utils::UrlPath entryPath;
+    TU_ASSIGN_OR_RETURN (entryPath, findEntry(location, absl::StrCat(
         ".", tempo_utils::sharedLibraryPlatformId(), tempo_utils::sharedLibraryFileDotSuffix())));
-    if (absolutePath.empty())
+    if (!entryPath.isValid())
         return Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>>();
 
-    // attempt to load the plugin
-    auto loader = std::make_shared<tempo_utils::LibraryLoader>(absolutePath, "native_init");
-    if (!loader->isValid()) {
-        auto status = loader->getStatus();
-        // if plugin is not found then return empty option instead of status
-        if (status.getStatusCode() == tempo_utils::StatusCode::kNotFound)
-            return Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>>();
-        return status;
-    }
-
-    // cast raw pointer to native_init function pointer
-    auto native_init = (lyric_runtime::NativeInitFunc) loader->symbolPointer();
-    if (native_init == nullptr)
-        return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
-            "failed to retrieve native_init symbol from plugin {}", absolutePath.string());
-
-    // retrieve the plugin interface
-    auto *iface = native_init();
-    if (iface == nullptr)
-        return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
-            "failed to retrieve interface for plugin {}", absolutePath.string());
+    // write the plugin and any bundled libraries to disk so they can be loaded by the dynamic linker
+    TU_RETURN_IF_NOT_OK (materializeLibraries());
+    std::filesystem::path absolutePath;
+    TU_ASSIGN_OR_RETURN (absolutePath, materializeEntry(entryPath));
 
-    TU_LOG_V << "loaded plugin " << absolutePath;
-    auto plugin = std::make_shared<const lyric_runtime::LibraryPlugin>(loader, iface);
-    return Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>>(plugin);
+    // load the plugin, or return the existing plugin if it has already been loaded
+    return m_pluginCache->loadPlugin(absolutePath);
 }
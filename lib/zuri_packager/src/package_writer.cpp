@@ -1,8 +1,20 @@
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zdict.h>
+#include <zstd.h>
+
 #include <tempo_config/config_builder.h>
 #include <tempo_config/config_utils.h>
 #include <tempo_utils/bytes_appender.h>
 #include <tempo_utils/file_appender.h>
+#include <tempo_utils/file_reader.h>
+#include <tempo_utils/file_utilities.h>
+#include <tempo_utils/log_stream.h>
+#include <tempo_utils/memory_bytes.h>
 #include <zuri_packager/generated/manifest.h>
 #include <zuri_packager/package_writer.h>
 
@@ -11,12 +23,21 @@ zuri_packager::PackageWriter::PackageWriter(
     const PackageWriterOptions &options)
     : m_specifier(specifier),
       m_options(options),
-      m_packageEntry(nullptr)
+      m_packageEntry(nullptr),
+      m_spoolFd(-1),
+      m_spoolSize(0)
 {
     m_state = std::make_unique<ManifestState>();
     TU_ASSERT (m_specifier.isValid());
 }
 
+zuri_packager::PackageWriter::~PackageWriter()
+{
+    if (m_spoolFd >= 0) {
+        ::close(m_spoolFd);
+    }
+}
+
 tempo_utils::Status
 zuri_packager::PackageWriter::configure()
 {
@@ -27,6 +48,18 @@ zuri_packager::PackageWriter::configure()
         return PackagerStatus::forCondition(
             PackagerCondition::kPackagerInvariant, "writer is already configured");
 
+    // if spooling is enabled then open the spool file. the spool file is unlinked immediately so
+    // it does not outlive the writer even if the process exits before the package is written.
+    if (m_options.spoolContents) {
+        auto spoolRoot = !m_options.installRoot.empty()? m_options.installRoot : std::filesystem::current_path();
+        auto spoolPath = spoolRoot / tempo_utils::generate_name(".spool.XXXXXXXX");
+        m_spoolFd = ::open(spoolPath.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (m_spoolFd < 0)
+            return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+                "failed to create spool file {}: {}", spoolPath.string(), strerror(errno));
+        ::unlink(spoolPath.c_str());
+    }
+
     TU_ASSIGN_OR_RETURN (m_packageEntry, m_state->appendEntry(
         EntryType::Package, tempo_utils::UrlPath::fromString("/")));
 
@@ -217,7 +250,7 @@ zuri_packager::PackageWriter::putFile(
     if (status.notOk())
         return status;
 
-    m_contents[path] = bytes;
+    TU_RETURN_IF_NOT_OK (storeContent(path, std::move(bytes)));
     return fileEntry->getAddress();
 }
 
@@ -263,10 +296,219 @@ zuri_packager::PackageWriter::putFile(
     if (status.notOk())
         return status;
 
-    m_contents[path] = bytes;
+    TU_RETURN_IF_NOT_OK (storeContent(path, std::move(bytes)));
+    return entry->getAddress();
+}
+
+/**
+ * Add a file entry at the specified path whose contents are read from `sourcePath` when the package
+ * is written. The contents are not read into memory; the source file must not be modified or removed
+ * until `writePackage` returns.
+ *
+ * @param path The path of the file entry.
+ * @param sourcePath The file containing the entry contents.
+ * @return The address of the file entry.
+ */
+tempo_utils::Result<zuri_packager::EntryAddress>
+zuri_packager::PackageWriter::putFile(
+    const tempo_utils::UrlPath &path,
+    const std::filesystem::path &sourcePath)
+{
+    if (!path.isValid())
+        return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+            "invalid file path");
+    if (m_state == nullptr)
+        return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+            "writer is finished");
+    if (m_packageEntry == nullptr)
+        return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+            "writer is not configured");
+
+    std::error_code ec;
+    auto size = std::filesystem::file_size(sourcePath, ec);
+    if (ec)
+        return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+            "invalid source file {}: {}", sourcePath.string(), ec.message());
+
+    tempo_utils::UrlPath parentPath = path.getInit();
+    auto name = path.getLast().getPart();
+    auto *parentEntry = m_state->getEntry(parentPath);
+    if (parentEntry == nullptr)
+        return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+            "missing parent directory");
+    switch (parentEntry->getEntryType()) {
+        case EntryType::Directory:
+        case EntryType::Package:
+            break;
+        default:
+            return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+                "invalid parent entry");
+    }
+    if (parentEntry->hasChild(name))
+        return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+            "file already exists");
+
+    auto appendEntryResult = m_state->appendEntry(EntryType::File, path);
+    if (appendEntryResult.isStatus())
+        return appendEntryResult.getStatus();
+    auto *entry = appendEntryResult.getResult();
+
+    auto status = parentEntry->putChild(entry);
+    if (status.notOk())
+        return status;
+
+    FileContent content;
+    content.sourcePath = sourcePath;
+    content.size = size;
+    m_contents[path] = std::move(content);
     return entry->getAddress();
 }
 
+static tempo_utils::Status
+write_fully(int fd, const tu_uint8 *data, tu_uint64 size)
+{
+    while (size > 0) {
+        auto ret = ::write(fd, data, size);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return zuri_packager::PackagerStatus::forCondition(
+                zuri_packager::PackagerCondition::kPackagerInvariant,
+                "failed to write package data: {}", strerror(errno));
+        }
+        data += ret;
+        size -= ret;
+    }
+    return {};
+}
+
+/**
+ * Append `size` bytes starting at `srcOffset` in `srcFd` to the current position of `dstFd`. On
+ * linux the copy is performed in the kernel using copy_file_range, otherwise (or if the filesystem
+ * does not support it) the data is copied through a fixed size buffer.
+ */
+static tempo_utils::Status
+copy_range(int srcFd, tu_uint64 srcOffset, tu_uint64 size, int dstFd)
+{
+#if defined(__linux__)
+    loff_t inOffset = srcOffset;
+    while (size > 0) {
+        auto ret = ::copy_file_range(srcFd, &inOffset, dstFd, nullptr, size, 0);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP)
+                break;
+            return zuri_packager::PackagerStatus::forCondition(
+                zuri_packager::PackagerCondition::kPackagerInvariant,
+                "failed to copy package data: {}", strerror(errno));
+        }
+        if (ret == 0)
+            return zuri_packager::PackagerStatus::forCondition(
+                zuri_packager::PackagerCondition::kPackagerInvariant,
+                "unexpected end of file while copying package data");
+        size -= ret;
+    }
+    srcOffset = inOffset;
+#endif
+
+    tu_uint8 buffer[64 * 1024];
+    while (size > 0) {
+        auto ret = ::pread(srcFd, buffer, std::min<tu_uint64>(size, sizeof(buffer)), srcOffset);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return zuri_packager::PackagerStatus::forCondition(
+                zuri_packager::PackagerCondition::kPackagerInvariant,
+                "failed to read package data: {}", strerror(errno));
+        }
+        if (ret == 0)
+            return zuri_packager::PackagerStatus::forCondition(
+                zuri_packager::PackagerCondition::kPackagerInvariant,
+                "unexpected end of file while copying package data");
+        TU_RETURN_IF_NOT_OK (write_fully(dstFd, buffer, ret));
+        srcOffset += ret;
+        size -= ret;
+    }
+    return {};
+}
+
+tempo_utils::Status
+zuri_packager::PackageWriter::storeContent(
+    const tempo_utils::UrlPath &path,
+    std::shared_ptr<const tempo_utils::ImmutableBytes> bytes)
+{
+    FileContent content;
+    TU_ASSIGN_OR_RETURN (content, spoolContent(std::move(bytes)));
+    m_contents[path] = std::move(content);
+    return {};
+}
+
+/**
+ * Hold the specified bytes until the package is written, spooling them to the spool file if
+ * spooling is enabled.
+ */
+tempo_utils::Result<zuri_packager::PackageWriter::FileContent>
+zuri_packager::PackageWriter::spoolContent(std::shared_ptr<const tempo_utils::ImmutableBytes> bytes)
+{
+    FileContent content;
+    content.size = bytes != nullptr? bytes->getSize() : 0;
+
+    if (m_spoolFd < 0) {
+        content.bytes = std::move(bytes);
+    } else {
+        if (::lseek(m_spoolFd, m_spoolSize, SEEK_SET) < 0)
+            return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+                "failed to seek spool file: {}", strerror(errno));
+        if (content.size > 0) {
+            TU_RETURN_IF_NOT_OK (write_fully(m_spoolFd, bytes->getData(), content.size));
+        }
+        content.spoolOffset = m_spoolSize;
+        m_spoolSize += content.size;
+    }
+
+    return content;
+}
+
+/**
+ * Returns the contents of the specified entry, or nullptr if the entry has no contents.
+ */
+const zuri_packager::PackageWriter::FileContent *
+zuri_packager::PackageWriter::findContent(const ManifestEntry *entry) const
+{
+    if (entry->getEntryType() == EntryType::Dictionary) {
+        auto dictEntry = m_dictionaries.find(entry->getAddress().getAddress());
+        return dictEntry != m_dictionaries.cend()? &dictEntry->second : nullptr;
+    }
+    auto contentEntry = m_contents.find(entry->getEntryPath());
+    return contentEntry != m_contents.cend()? &contentEntry->second : nullptr;
+}
+
+tempo_utils::Status
+zuri_packager::PackageWriter::writeContent(int fd, const FileContent &content)
+{
+    if (content.size == 0)
+        return {};
+
+    if (content.bytes != nullptr)
+        return write_fully(fd, content.bytes->getData(), content.size);
+
+    if (!content.sourcePath.empty()) {
+        int srcFd = ::open(content.sourcePath.c_str(), O_RDONLY);
+        if (srcFd < 0)
+            return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+                "failed to open source file {}: {}", content.sourcePath.string(), strerror(errno));
+        auto status = copy_range(srcFd, 0, content.size, fd);
+        ::close(srcFd);
+        return status;
+    }
+
+    if (m_spoolFd < 0)
+        return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+            "file entry has no contents");
+    return copy_range(m_spoolFd, content.spoolOffset, content.size, fd);
+}
+
 tempo_utils::Result<zuri_packager::EntryAddress>
 zuri_packager::PackageWriter::linkToTarget(const tempo_utils::UrlPath &path, EntryAddress target)
 {
@@ -342,6 +584,151 @@ zuri_packager::PackageWriter::linkToTarget(const tempo_utils::UrlPath &path, Ent
     return linkEntry->getAddress();
 }
 
+tempo_utils::Result<std::shared_ptr<const tempo_utils::ImmutableBytes>>
+zuri_packager::PackageWriter::loadContent(const FileContent &content)
+{
+    if (content.bytes != nullptr)
+        return content.bytes;
+
+    if (!content.sourcePath.empty()) {
+        tempo_utils::FileReader reader(content.sourcePath);
+        TU_RETURN_IF_NOT_OK (reader.getStatus());
+        return reader.getBytes();
+    }
+
+    std::vector<tu_uint8> buffer(content.size);
+    tu_uint64 offset = 0;
+    while (offset < content.size) {
+        auto ret = ::pread(m_spoolFd, buffer.data() + offset, content.size - offset, content.spoolOffset + offset);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+                "failed to read spool file: {}", strerror(errno));
+        }
+        if (ret == 0)
+            return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+                "unexpected end of spool file");
+        offset += ret;
+    }
+    return std::static_pointer_cast<const tempo_utils::ImmutableBytes>(
+        tempo_utils::MemoryBytes::copy(std::span<const tu_uint8>(buffer)));
+}
+
+/**
+ * Compress the contents of each file entry. If dictionary training is enabled then the dictionary
+ * is trained from (a prefix of) the file contents and appended as a dictionary entry. A file entry
+ * is converted to a compressed file entry only if compression reduces the size of the contents.
+ *
+ * @return Status
+ */
+tempo_utils::Status
+zuri_packager::PackageWriter::compressContents()
+{
+    std::vector<ManifestEntry *> fileEntries;
+    for (int i = 0; i < m_state->numEntries(); i++) {
+        auto *entry = m_state->getEntry(i);
+        if (entry->getEntryType() == EntryType::File && m_contents.contains(entry->getEntryPath())) {
+            fileEntries.push_back(entry);
+        }
+    }
+
+    // train the dictionary from the file contents
+    std::vector<tu_uint8> dictionary;
+    if (m_options.trainDictionary && !fileEntries.empty()) {
+        // the samples are held in memory, so bound their total size and sample a prefix of each file
+        std::vector<tu_uint8> samples;
+        std::vector<size_t> sampleSizes;
+        for (const auto *entry : fileEntries) {
+            const auto &content = m_contents.at(entry->getEntryPath());
+            if (content.size == 0)
+                continue;
+            auto remaining = m_options.maxDictionarySamplesSize - samples.size();
+            if (remaining == 0)
+                break;
+            auto sampleSize = std::min<tu_uint64>(
+                std::min<tu_uint64>(content.size, m_options.maxDictionarySampleSize), remaining);
+            std::shared_ptr<const tempo_utils::ImmutableBytes> bytes;
+            TU_ASSIGN_OR_RETURN (bytes, loadContent(content));
+            samples.insert(samples.end(), bytes->getData(), bytes->getData() + sampleSize);
+            sampleSizes.push_back(sampleSize);
+        }
+
+        dictionary.resize(m_options.maxDictionarySize);
+        auto ret = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(),
+            samples.data(), sampleSizes.data(), sampleSizes.size());
+        if (ZDICT_isError(ret)) {
+            // training fails if there are too few samples, in which case we compress without a dictionary
+            TU_LOG_V << "skipping package dictionary: " << ZDICT_getErrorName(ret);
+            dictionary.clear();
+        } else {
+            dictionary.resize(ret);
+        }
+    }
+
+    EntryAddress dictAddress;
+    ZSTD_CDict *cdict = nullptr;
+    if (!dictionary.empty()) {
+        FileContent dictContent;
+        TU_ASSIGN_OR_RETURN (dictContent, spoolContent(tempo_utils::MemoryBytes::copy(
+            std::span<const tu_uint8>(dictionary))));
+        auto *dictEntry = m_state->appendDictionaryEntry();
+        dictAddress = dictEntry->getAddress();
+        m_dictionaries[dictAddress.getAddress()] = std::move(dictContent);
+        cdict = ZSTD_createCDict(dictionary.data(), dictionary.size(), m_options.compressionLevel);
+        if (cdict == nullptr)
+            return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+                "failed to create compression dictionary");
+    }
+
+    auto *cctx = ZSTD_createCCtx();
+    tempo_utils::Status status;
+
+    for (auto *entry : fileEntries) {
+        auto path = entry->getEntryPath();
+        const auto &content = m_contents.at(path);
+        if (content.size == 0)
+            continue;
+
+        auto loadContentResult = loadContent(content);
+        if (loadContentResult.isStatus()) {
+            status = loadContentResult.getStatus();
+            break;
+        }
+        auto bytes = loadContentResult.getResult();
+
+        std::vector<tu_uint8> compressed(ZSTD_compressBound(bytes->getSize()));
+        size_t ret;
+        if (cdict != nullptr) {
+            ret = ZSTD_compress_usingCDict(cctx, compressed.data(), compressed.size(),
+                bytes->getData(), bytes->getSize(), cdict);
+        } else {
+            ret = ZSTD_compressCCtx(cctx, compressed.data(), compressed.size(),
+                bytes->getData(), bytes->getSize(), m_options.compressionLevel);
+        }
+        if (ZSTD_isError(ret)) {
+            status = PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+                "failed to compress {}: {}", path.toString(), ZSTD_getErrorName(ret));
+            break;
+        }
+
+        // leave the entry uncompressed if compression doesn't reduce the size
+        if (ret >= bytes->getSize())
+            continue;
+        compressed.resize(ret);
+
+        status = storeContent(path, tempo_utils::MemoryBytes::copy(std::span<const tu_uint8>(compressed)));
+        if (status.notOk())
+            break;
+        entry->setEntryType(EntryType::CompressedFile);
+        entry->setEntryDict(dictAddress);
+    }
+
+    ZSTD_freeCCtx(cctx);
+    ZSTD_freeCDict(cdict);
+    return status;
+}
+
 tempo_config::ConfigMap
 zuri_packager::PackageWriter::getPackageConfig() const
 {
@@ -376,6 +763,10 @@ zuri_packager::PackageWriter::writePackage()
         TU_RETURN_IF_STATUS (putFile(path, configContent));
     }
 
+    if (m_options.compressFiles) {
+        TU_RETURN_IF_NOT_OK (compressContents());
+    }
+
     tempo_utils::FileAppenderMode mode = tempo_utils::FileAppenderMode::CREATE_ONLY;
     if (m_options.overwriteFile) {
         mode = tempo_utils::FileAppenderMode::CREATE_OR_OVERWRITE;
@@ -390,20 +781,21 @@ zuri_packager::PackageWriter::writePackage()
     // update the offset and size fields for all file entries
     for (int i = 0; i < m_state->numEntries(); i++) {
         auto *entry = m_state->getEntry(i);
-        auto path = entry->getEntryPath();
-        if (!m_contents.contains(path))
+        const auto *content = findContent(entry);
+        if (content == nullptr)
             continue;
         switch (entry->getEntryType()) {
             case EntryType::File:
+            case EntryType::CompressedFile:
+            case EntryType::Dictionary:
                 break;
             default:
                 return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
                     "unexpected file content for entry");
         }
-        auto bytes = m_contents.at(path);
         entry->setEntryOffset(currOffset);
-        entry->setEntrySize(bytes->getSize());
-        currOffset += bytes->getSize();
+        entry->setEntrySize(content->size);
+        currOffset += content->size;
     }
 
     // serialize the manifest
@@ -422,25 +814,48 @@ zuri_packager::PackageWriter::writePackage()
     auto manifestBytes = manifest.bytesView();
     TU_RETURN_IF_NOT_OK (appender.appendU32(manifestBytes.size()));     // manifestSize: u32
     TU_RETURN_IF_NOT_OK (appender.appendBytes(manifestBytes));          // manifest: bytes
+    TU_RETURN_IF_NOT_OK (appender.finish());
 
-    // write each entry contents
-    for (int i = 0; i < m_state->numEntries(); i++) {
+    // append each entry contents after the manifest
+    int fd = ::open(packagePath.c_str(), O_WRONLY);
+    if (fd < 0)
+        return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+            "failed to open package file {}: {}", packagePath.string(), strerror(errno));
+    tempo_utils::Status status;
+    if (::lseek(fd, 0, SEEK_END) < 0) {
+        status = PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+            "failed to seek package file: {}", strerror(errno));
+    }
+    for (int i = 0; status.isOk() && i < m_state->numEntries(); i++) {
         const auto *entry = m_state->getEntry(i);
-        if (entry->getEntryType() == EntryType::File) {
-            auto path = entry->getEntryPath();
-            if (!m_contents.contains(path))
-                return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+        auto entryType = entry->getEntryType();
+        if (entryType == EntryType::File
+            || entryType == EntryType::CompressedFile
+            || entryType == EntryType::Dictionary) {
+            const auto *content = findContent(entry);
+            if (content == nullptr) {
+                status = PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
                     "file entry has no contents");
-            auto content = m_contents.at(path);
-            std::span<const tu_uint8> bytes(content->getData(), content->getSize());
-            TU_RETURN_IF_NOT_OK (appender.appendBytes(bytes));          // entry: bytes
+                break;
+            }
+            status = writeContent(fd, *content);                            // entry: bytes
         }
     }
-
-    TU_RETURN_IF_NOT_OK (appender.finish());
+    if (::close(fd) < 0 && status.isOk()) {
+        status = PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+            "failed to close package file: {}", strerror(errno));
+    }
+    TU_RETURN_IF_NOT_OK (status);
 
     m_packageEntry = nullptr;
     m_state.reset();
+    m_contents.clear();
+    m_dictionaries.clear();
+    if (m_spoolFd >= 0) {
+        ::close(m_spoolFd);
+        m_spoolFd = -1;
+        m_spoolSize = 0;
+    }
 
     return packagePath;
 }
@@ -0,0 +1,159 @@
+#include <algorithm>
+
+#include <lyric_runtime/library_plugin.h>
+#include <tempo_utils/library_loader.h>
+#include <tempo_utils/log_stream.h>
+#include <tempo_utils/tempdir_maker.h>
+#include <zuri_packager/packager_result.h>
+#include <zuri_packager/plugin_cache.h>
+
+zuri_packager::PluginCache::PluginCache(const PluginCacheOptions &options)
+    : m_options(options),
+      m_clock(0)
+{
+}
+
+/**
+ * Returns the plugin cache shared by all loaders in the process.
+ */
+std::shared_ptr<zuri_packager::PluginCache>
+zuri_packager::PluginCache::processCache()
+{
+    static auto cache = std::make_shared<PluginCache>();
+    return cache;
+}
+
+/**
+ * Load the plugin library at the specified path. If the library has already been loaded and
+ * has not changed on disk then the existing plugin is returned, otherwise the library is loaded
+ * and its plugin interface is retrieved by calling the `native_init` entry point. If a previous
+ * version of the library at the same path is still loaded then the replacement is loaded from a
+ * private copy, because the dynamic loader returns the already loaded library when the same path
+ * is opened again.
+ *
+ * @param pluginPath The path to the plugin library.
+ * @return The plugin, or an empty option if the library does not exist.
+ */
+tempo_utils::Result<Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>>>
+zuri_packager::PluginCache::loadPlugin(const std::filesystem::path &pluginPath)
+{
+    std::error_code ec;
+    auto canonicalPath = std::filesystem::canonical(pluginPath, ec);
+    if (ec)
+        return Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>>();
+
+    PluginKey key;
+    key.canonicalPath = canonicalPath.string();
+    TU_ASSIGN_OR_RETURN (key.identity, get_object_file_identity(canonicalPath));
+
+    // the lock is held while loading so that concurrent loads of the same plugin load it only once
+    absl::MutexLock locker(&m_lock);
+
+    auto entry = m_plugins.find(key);
+    if (entry != m_plugins.cend()) {
+        entry->second.lastLoaded = ++m_clock;
+        return Option(entry->second.plugin);
+    }
+
+    // if another version of the library is loaded from the same path then load the replacement
+    // from a copy at a unique path. the copy is removed once loaded, the mapping remains valid.
+    bool isReplaced = std::any_of(m_plugins.cbegin(), m_plugins.cend(), [&](const auto &other) {
+        return other.first.canonicalPath == key.canonicalPath;
+    });
+    std::filesystem::path loadPath = canonicalPath;
+    std::unique_ptr<tempo_utils::TempdirMaker> replacementMaker;
+    if (isReplaced) {
+        replacementMaker = std::make_unique<tempo_utils::TempdirMaker>(
+            std::filesystem::temp_directory_path(), "zuri-plugin.XXXXXXXX");
+        TU_RETURN_IF_NOT_OK (replacementMaker->getStatus());
+        loadPath = replacementMaker->getTempdir() / canonicalPath.filename();
+        std::filesystem::copy_file(canonicalPath, loadPath, ec);
+        if (ec)
+            return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+                "failed to copy replaced plugin {}: {}", canonicalPath.string(), ec.message());
+    }
+
+    // attempt to load the plugin
+    auto loader = std::make_shared<tempo_utils::LibraryLoader>(loadPath, "native_init");
+    if (replacementMaker != nullptr) {
+        std::filesystem::remove_all(replacementMaker->getTempdir(), ec);
+    }
+    if (!loader->isValid()) {
+        auto status = loader->getStatus();
+        // if plugin is not found then return empty option instead of status
+        if (status.getStatusCode() == tempo_utils::StatusCode::kNotFound)
+            return Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>>();
+        return status;
+    }
+
+    // cast raw pointer to native_init function pointer
+    auto native_init = (lyric_runtime::NativeInitFunc) loader->symbolPointer();
+    if (native_init == nullptr)
+        return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+            "failed to retrieve native_init symbol from plugin {}", canonicalPath.string());
+
+    // retrieve the plugin interface
+    auto *iface = native_init();
+    if (iface == nullptr)
+        return PackagerStatus::forCondition(PackagerCondition::kPackagerInvariant,
+            "failed to retrieve interface for plugin {}", canonicalPath.string());
+
+    TU_LOG_V << "loaded plugin " << canonicalPath;
+    auto plugin = std::make_shared<const lyric_runtime::LibraryPlugin>(loader, iface);
+
+    PluginEntry pluginEntry;
+    pluginEntry.plugin = plugin;
+    pluginEntry.lastLoaded = ++m_clock;
+    m_plugins[key] = std::move(pluginEntry);
+    evict(m_options.maxCachedPlugins);
+
+    return Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>>(plugin);
+}
+
+/**
+ * Release every cached plugin which is not in use. The library is unloaded once the last
+ * reference to the plugin is dropped.
+ */
+void
+zuri_packager::PluginCache::evictUnused()
+{
+    absl::MutexLock locker(&m_lock);
+    evict(0);
+}
+
+int
+zuri_packager::PluginCache::numCachedPlugins() const
+{
+    absl::MutexLock locker(&m_lock);
+    return m_plugins.size();
+}
+
+/**
+ * Release the least recently loaded plugins which are not in use until at most the specified
+ * number of plugins are cached. A plugin is in use if anything other than the cache holds a
+ * reference to it.
+ *
+ * @param maxCachedPlugins The maximum number of plugins to retain.
+ */
+void
+zuri_packager::PluginCache::evict(int maxCachedPlugins)
+{
+    if (static_cast<int>(m_plugins.size()) <= maxCachedPlugins)
+        return;
+
+    std::vector<std::pair<tu_uint64,PluginKey>> unused;
+    for (const auto &entry : m_plugins) {
+        if (entry.second.plugin.use_count() == 1) {
+            unused.emplace_back(entry.second.lastLoaded, entry.first);
+        }
+    }
+    std::sort(unused.begin(), unused.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.first < rhs.first;
+    });
+
+    auto numToEvict = static_cast<int>(m_plugins.size()) - maxCachedPlugins;
+    for (auto it = unused.cbegin(); it != unused.cend() && numToEvict > 0; ++it, --numToEvict) {
+        TU_LOG_V << "evicting plugin " << it->second.canonicalPath;
+        m_plugins.erase(it->second);
+    }
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <lyric_bootstrap/bootstrap_loader.h>
+#include <tempo_test/result_matchers.h>
+#include <tempo_test/status_matchers.h>
+#include <tempo_utils/file_writer.h>
+#include <tempo_utils/memory_bytes.h>
+#include <tempo_utils/tempdir_maker.h>
+
+#include <zuri_packager/object_cache.h>
+
+class ObjectCache : public ::testing::Test {
+protected:
+    std::filesystem::path testerRoot;
+    void SetUp() override {
+        tempo_utils::TempdirMaker testerMaker(std::filesystem::current_path(), "tester.XXXXXXXX");
+        TU_RAISE_IF_NOT_OK (testerMaker.getStatus());
+        testerRoot = testerMaker.getTempdir();
+    }
+    std::filesystem::path writeValidObject(std::string_view name) {
+        // the prelude is a real object, so it passes verification
+        lyric_bootstrap::BootstrapLoader bootstrapLoader;
+        Option<lyric_object::LyricObject> preludeOption;
+        TU_ASSIGN_OR_RAISE (preludeOption, bootstrapLoader.loadModule(
+            lyric_common::ModuleLocation::fromString("dev.zuri.bootstrap:/prelude")));
+        TU_ASSERT (preludeOption.hasValue());
+        auto preludeBytes = preludeOption.getValue().getBytesView();
+        auto objectPath = testerRoot / name;
+        tempo_utils::FileWriter fileWriter(objectPath,
+            tempo_utils::MemoryBytes::copy(std::string_view((const char *) preludeBytes.data(), preludeBytes.size())),
+            tempo_utils::FileWriterMode::CREATE_ONLY);
+        TU_RAISE_IF_NOT_OK (fileWriter.getStatus());
+        return objectPath;
+    }
+    void TearDown() override {
+        if (std::filesystem::exists(testerRoot)) {
+            TU_ASSERT (std::filesystem::remove_all(testerRoot));
+            testerRoot.clear();
+        }
+    }
+};
+
+TEST_F(ObjectCache, LoadInvalidObjectFailsVerification)
+{
+    auto objectPath = testerRoot / "invalid.lyo";
+    tempo_utils::FileWriter fileWriter(objectPath, tempo_utils::MemoryBytes::copy("not an object"),
+        tempo_utils::FileWriterMode::CREATE_ONLY);
+    ASSERT_THAT (fileWriter.getStatus(), tempo_test::IsOk());
+
+    zuri_packager::ObjectCache objectCache;
+    ASSERT_THAT (objectCache.loadObject(objectPath), tempo_test::IsStatus());
+
+    // a file which failed verification is not recorded, and it is not left mapped
+    ASSERT_FALSE (objectCache.isVerified(objectPath));
+    ASSERT_EQ (0, objectCache.numMappedObjects());
+}
+
+TEST_F(ObjectCache, LoadMissingObjectFails)
+{
+    zuri_packager::ObjectCache objectCache;
+    ASSERT_THAT (objectCache.loadObject(testerRoot / "missing.lyo"), tempo_test::IsStatus());
+    ASSERT_FALSE (objectCache.isVerified(testerRoot / "missing.lyo"));
+}
+
+TEST_F(ObjectCache, FileIdentityChangesWhenFileIsReplaced)
+{
+    auto objectPath = testerRoot / "object.lyo";
+    {
+        tempo_utils::FileWriter fileWriter(objectPath, tempo_utils::MemoryBytes::copy("first"),
+            tempo_utils::FileWriterMode::CREATE_ONLY);
+        ASSERT_THAT (fileWriter.getStatus(), tempo_test::IsOk());
+    }
+    zuri_packager::ObjectFileIdentity first;
+    TU_ASSIGN_OR_RAISE (first, zuri_packager::get_object_file_identity(objectPath));
+
+    std::filesystem::remove(objectPath);
+    {
+        tempo_utils::FileWriter fileWriter(objectPath, tempo_utils::MemoryBytes::copy("second file"),
+            tempo_utils::FileWriterMode::CREATE_ONLY);
+        ASSERT_THAT (fileWriter.getStatus(), tempo_test::IsOk());
+    }
+    zuri_packager::ObjectFileIdentity second;
+    TU_ASSIGN_OR_RAISE (second, zuri_packager::get_object_file_identity(objectPath));
+
+    ASSERT_NE (first, second);
+}
+
+TEST_F(ObjectCache, LoadValidObjectTwiceSharesMapping)
+{
+    auto objectPath = writeValidObject("object.lyo");
+
+    zuri_packager::ObjectCache objectCache;
+    {
+        lyric_object::LyricObject object1, object2;
+        TU_ASSIGN_OR_RAISE (object1, objectCache.loadObject(objectPath));
+        TU_ASSIGN_OR_RAISE (object2, objectCache.loadObject(objectPath));
+        ASSERT_TRUE (objectCache.isVerified(objectPath));
+        ASSERT_EQ (1, objectCache.numMappedObjects());
+        ASSERT_EQ (object1.getBytesView().data(), object2.getBytesView().data());
+    }
+
+    // the mapping is released with the last object, but the file is still known to be verified
+    ASSERT_EQ (0, objectCache.numMappedObjects());
+    ASSERT_TRUE (objectCache.isVerified(objectPath));
+}
+
+TEST_F(ObjectCache, ReplacedObjectIsMappedSeparately)
+{
+    auto objectPath = writeValidObject("object.lyo");
+
+    zuri_packager::ObjectCache objectCache;
+    lyric_object::LyricObject object1, object2;
+    TU_ASSIGN_OR_RAISE (object1, objectCache.loadObject(objectPath));
+
+    // replacing the file changes the device and inode identity even if the size and mtime match
+    auto replacementPath = writeValidObject("replacement.lyo");
+    std::filesystem::rename(replacementPath, objectPath);
+    TU_ASSIGN_OR_RAISE (object2, objectCache.loadObject(objectPath));
+    ASSERT_EQ (2, objectCache.numMappedObjects());
+    ASSERT_NE (object1.getBytesView().data(), object2.getBytesView().data());
+}
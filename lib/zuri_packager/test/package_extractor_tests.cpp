@@ -2,6 +2,8 @@
 #include <gmock/gmock.h>
 #include <tempo_config/config_builder.h>
 
+#include <absl/strings/str_cat.h>
+
 #include <tempo_test/result_matchers.h>
 #include <tempo_test/status_matchers.h>
 #include <tempo_utils/file_utilities.h>
@@ -77,3 +79,44 @@ TEST_F(PackageExtractor, ExtractEmptyPackage)
     ASSERT_THAT (extractPackageResult, tempo_test::IsResult());
     auto extractPath = extractPackageResult.getResult();
 }
+
+TEST_F(PackageExtractor, ExtractPackageUsingMultipleWorkers)
+{
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    zuri_packager::PackageWriterOptions writerOptions;
+    writerOptions.installRoot = testerRoot;
+    zuri_packager::PackageWriter writer(specifier, writerOptions);
+    ASSERT_THAT (writer.configure(), tempo_test::IsOk());
+
+    for (int i = 0; i < 32; i++) {
+        auto path = tempo_utils::UrlPath::fromString(absl::StrCat("/dir", i % 4, "/file", i, ".txt"));
+        ASSERT_THAT (writer.makeDirectory(path.getInit(), true), tempo_test::IsResult());
+        ASSERT_THAT (writer.putFile(path, tempo_utils::MemoryBytes::copy(absl::StrCat("file ", i))),
+            tempo_test::IsResult());
+    }
+
+    auto writePackageResult = writer.writePackage();
+    ASSERT_THAT (writePackageResult, tempo_test::IsResult());
+    auto packagePath = writePackageResult.getResult();
+
+    auto openPackageResult = zuri_packager::PackageReader::open(packagePath);
+    ASSERT_THAT (openPackageResult, tempo_test::IsResult());
+    auto reader = openPackageResult.getResult();
+
+    zuri_packager::PackageExtractorOptions extractorOptions;
+    extractorOptions.workingRoot = testerRoot;
+    extractorOptions.destinationRoot = testerRoot;
+    extractorOptions.numWorkers = 4;
+    zuri_packager::PackageExtractor extractor(reader, extractorOptions);
+    ASSERT_THAT (extractor.configure(), tempo_test::IsOk());
+
+    auto extractPackageResult = extractor.extractPackage();
+    ASSERT_THAT (extractPackageResult, tempo_test::IsResult());
+    auto extractPath = extractPackageResult.getResult();
+
+    for (int i = 0; i < 32; i++) {
+        auto filePath = extractPath / absl::StrCat("dir", i % 4) / absl::StrCat("file", i, ".txt");
+        ASSERT_TRUE (std::filesystem::is_regular_file(filePath)) << filePath;
+        ASSERT_EQ (absl::StrCat("file ", i).size(), std::filesystem::file_size(filePath));
+    }
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <absl/strings/str_cat.h>
+
+#include <lyric_common/common_types.h>
+#include <tempo_test/result_matchers.h>
+#include <tempo_test/status_matchers.h>
+#include <tempo_utils/memory_bytes.h>
+#include <tempo_utils/tempdir_maker.h>
+
+#include <zuri_packager/package_reader_loader.h>
+#include <zuri_packager/package_writer.h>
+
+class PackageReaderLoader : public ::testing::Test {
+protected:
+    std::filesystem::path testerRoot;
+    std::shared_ptr<zuri_packager::PackageReader> reader;
+    void SetUp() override {
+        tempo_utils::TempdirMaker testerMaker(std::filesystem::current_path(), "tester.XXXXXXXX");
+        TU_RAISE_IF_NOT_OK (testerMaker.getStatus());
+        testerRoot = testerMaker.getTempdir();
+
+        auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+        zuri_packager::PackageWriterOptions writerOptions;
+        writerOptions.installRoot = testerRoot;
+        zuri_packager::PackageWriter writer(specifier, writerOptions);
+        TU_RAISE_IF_NOT_OK (writer.configure());
+        auto modulePath = tempo_utils::UrlPath::fromString(
+            absl::StrCat("/modules/mod1", lyric_common::kObjectFileDotSuffix));
+        TU_RAISE_IF_STATUS (writer.makeDirectory(modulePath.getInit(), true));
+        TU_RAISE_IF_STATUS (writer.putFile(modulePath, tempo_utils::MemoryBytes::copy("not an object")));
+        std::filesystem::path packagePath;
+        TU_ASSIGN_OR_RAISE (packagePath, writer.writePackage());
+        TU_ASSIGN_OR_RAISE (reader, zuri_packager::PackageReader::open(packagePath));
+    }
+    void TearDown() override {
+        reader.reset();
+        if (std::filesystem::exists(testerRoot)) {
+            TU_ASSERT (std::filesystem::remove_all(testerRoot));
+            testerRoot.clear();
+        }
+    }
+};
+
+TEST_F(PackageReaderLoader, HasModuleWithoutExtractingPackage)
+{
+    auto tempRoot = testerRoot / "temp";
+    std::filesystem::create_directory(tempRoot);
+
+    auto createLoaderResult = zuri_packager::PackageReaderLoader::create(reader, tempRoot);
+    ASSERT_THAT (createLoaderResult, tempo_test::IsResult());
+    auto loader = createLoaderResult.getResult();
+
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    auto moduleLocation = lyric_common::ModuleLocation::fromUrl(
+        specifier.toUrl().resolve(tempo_utils::UrlPath::fromString("/mod1")));
+    ASSERT_THAT (loader->hasModule(moduleLocation), tempo_test::ContainsResult(true));
+
+    auto missingLocation = lyric_common::ModuleLocation::fromUrl(
+        specifier.toUrl().resolve(tempo_utils::UrlPath::fromString("/missing")));
+    ASSERT_THAT (loader->hasModule(missingLocation), tempo_test::ContainsResult(false));
+
+    // nothing is written to the temp directory until a plugin is loaded
+    std::vector<std::filesystem::path> written;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(tempRoot)) {
+        if (entry.is_regular_file()) {
+            written.push_back(entry.path());
+        }
+    }
+    ASSERT_TRUE (written.empty());
+}
+
+TEST_F(PackageReaderLoader, LoadModuleFailsVerificationForInvalidObject)
+{
+    auto tempRoot = testerRoot / "temp";
+    std::filesystem::create_directory(tempRoot);
+
+    auto createLoaderResult = zuri_packager::PackageReaderLoader::create(reader, tempRoot);
+    ASSERT_THAT (createLoaderResult, tempo_test::IsResult());
+    auto loader = createLoaderResult.getResult();
+
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    auto moduleLocation = lyric_common::ModuleLocation::fromUrl(
+        specifier.toUrl().resolve(tempo_utils::UrlPath::fromString("/mod1")));
+    ASSERT_THAT (loader->loadModule(moduleLocation), tempo_test::IsStatus());
+}
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <absl/strings/str_cat.h>
+
 #include <tempo_test/result_matchers.h>
 #include <tempo_test/status_matchers.h>
 #include <tempo_utils/file_reader.h>
@@ -82,3 +84,139 @@ TEST_F(PackageReader, ReadPackageBytes)
     std::string contents((const char *) slice.getData(), slice.getSize());
     ASSERT_EQ ("hello, world!", contents);
 }
+
+TEST_F(PackageReader, GetCachedPackageConfig)
+{
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    zuri_packager::PackageWriter writer(specifier);
+    ASSERT_THAT (writer.configure(), tempo_test::IsOk());
+    auto writePackageResult = writer.writePackage();
+    ASSERT_THAT (writePackageResult, tempo_test::IsResult());
+
+    packagePath = writePackageResult.getResult();
+    auto openReaderResult = zuri_packager::PackageReader::open(packagePath);
+    ASSERT_THAT (openReaderResult, tempo_test::IsResult());
+    auto reader = openReaderResult.getResult();
+
+    auto getSpecifierResult = reader->getPackageSpecifier();
+    ASSERT_THAT (getSpecifierResult, tempo_test::IsResult());
+    ASSERT_EQ (specifier, getSpecifierResult.getResult());
+    ASSERT_EQ (specifier, reader->getPackageSpecifier().getResult());
+    ASSERT_THAT (reader->getPackageConfig(), tempo_test::IsResult());
+
+    // the package has no requirements
+    auto getRequirementsResult = reader->getRequirementsMap();
+    ASSERT_THAT (getRequirementsResult, tempo_test::IsResult());
+    auto requirementsMap = getRequirementsResult.getResult();
+    ASSERT_TRUE (requirementsMap.requirementsBegin() == requirementsMap.requirementsEnd());
+}
+
+TEST_F(PackageReader, ReadCompressedFileContents)
+{
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    zuri_packager::PackageWriterOptions writerOptions;
+    writerOptions.compressFiles = true;
+    zuri_packager::PackageWriter writer(specifier, writerOptions);
+    ASSERT_THAT (writer.configure(), tempo_test::IsOk());
+
+    std::string expected;
+    for (int i = 0; i < 1000; i++) {
+        absl::StrAppend(&expected, "hello, world! ");
+    }
+    auto path = tempo_utils::UrlPath::fromString("/file.txt");
+    writer.putFile(path, tempo_utils::MemoryBytes::copy(expected));
+    auto writePackageResult = writer.writePackage();
+    ASSERT_THAT (writePackageResult, tempo_test::IsResult());
+
+    packagePath = writePackageResult.getResult();
+    zuri_packager::PackageReaderOptions readerOptions;
+    readerOptions.decompressedCacheSize = 4;
+    auto openReaderResult = zuri_packager::PackageReader::open(packagePath, readerOptions);
+    ASSERT_THAT (openReaderResult, tempo_test::IsResult());
+    auto reader = openReaderResult.getResult();
+
+    auto entry = reader->getManifest().getEntry(path);
+    ASSERT_EQ (zuri_packager::EntryType::CompressedFile, entry.getEntryType());
+    ASSERT_LT (entry.getFileSize(), expected.size());
+
+    auto readContentsResult = reader->readFileContents(path);
+    ASSERT_THAT (readContentsResult, tempo_test::IsResult());
+    auto slice = readContentsResult.getResult();
+    ASSERT_EQ (expected, std::string((const char *) slice.getData(), slice.getSize()));
+
+    // the package config is readable when compressed
+    ASSERT_EQ (specifier, reader->getPackageSpecifier().getResult());
+}
+
+TEST_F(PackageReader, ReadCompressedFileLargerThanMaximumFails)
+{
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    zuri_packager::PackageWriterOptions writerOptions;
+    writerOptions.compressFiles = true;
+    zuri_packager::PackageWriter writer(specifier, writerOptions);
+    ASSERT_THAT (writer.configure(), tempo_test::IsOk());
+
+    std::string expected;
+    for (int i = 0; i < 1000; i++) {
+        absl::StrAppend(&expected, "hello, world! ");
+    }
+    auto path = tempo_utils::UrlPath::fromString("/file.txt");
+    writer.putFile(path, tempo_utils::MemoryBytes::copy(expected));
+    auto writePackageResult = writer.writePackage();
+    ASSERT_THAT (writePackageResult, tempo_test::IsResult());
+
+    packagePath = writePackageResult.getResult();
+    zuri_packager::PackageReaderOptions readerOptions;
+    readerOptions.maxDecompressedEntrySize = expected.size() - 1;
+    auto openReaderResult = zuri_packager::PackageReader::open(packagePath, readerOptions);
+    ASSERT_THAT (openReaderResult, tempo_test::IsResult());
+    auto reader = openReaderResult.getResult();
+
+    ASSERT_THAT (reader->readFileContents(path), tempo_test::ContainsStatus(
+        zuri_packager::PackagerCondition::kInvalidManifest));
+}
+
+TEST_F(PackageReader, DictionaryDoesNotCollideWithPackageFile)
+{
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    zuri_packager::PackageWriterOptions writerOptions;
+    writerOptions.compressFiles = true;
+    writerOptions.trainDictionary = true;
+    writerOptions.maxDictionarySize = 4096;
+    zuri_packager::PackageWriter writer(specifier, writerOptions);
+    ASSERT_THAT (writer.configure(), tempo_test::IsOk());
+
+    // the package contains a file at the path which was previously used for the dictionary
+    std::string dictionaryFile = "not a dictionary";
+    auto dictionaryPath = tempo_utils::UrlPath::fromString("/.dictionary");
+    ASSERT_THAT (writer.putFile(dictionaryPath, tempo_utils::MemoryBytes::copy(dictionaryFile)),
+        tempo_test::IsResult());
+
+    // add enough similar files for the dictionary to be trained
+    for (int i = 0; i < 256; i++) {
+        std::string contents;
+        for (int j = 0; j < 64; j++) {
+            absl::StrAppend(&contents, "module ", i, " declares symbol ", (i * 31 + j * 17) % 1000, ";\n");
+        }
+        auto path = tempo_utils::UrlPath::fromString(absl::StrCat("/file", i, ".txt"));
+        ASSERT_THAT (writer.putFile(path, tempo_utils::MemoryBytes::copy(contents)), tempo_test::IsResult());
+    }
+    auto writePackageResult = writer.writePackage();
+    ASSERT_THAT (writePackageResult, tempo_test::IsResult());
+
+    packagePath = writePackageResult.getResult();
+    auto openReaderResult = zuri_packager::PackageReader::open(packagePath);
+    ASSERT_THAT (openReaderResult, tempo_test::IsResult());
+    auto reader = openReaderResult.getResult();
+
+    auto entry = reader->getManifest().getEntry(tempo_utils::UrlPath::fromString("/file0.txt"));
+    ASSERT_EQ (zuri_packager::EntryType::CompressedFile, entry.getEntryType());
+    auto dict = entry.getDict();
+    ASSERT_TRUE (dict.isValid());
+    ASSERT_EQ (zuri_packager::EntryType::Dictionary, dict.getEntryType());
+
+    auto readContentsResult = reader->readFileContents(dictionaryPath);
+    ASSERT_THAT (readContentsResult, tempo_test::IsResult());
+    auto slice = readContentsResult.getResult();
+    ASSERT_EQ (dictionaryFile, std::string((const char *) slice.getData(), slice.getSize()));
+}
@@ -3,8 +3,10 @@
 #include <tempo_test/result_matchers.h>
 #include <tempo_test/status_matchers.h>
 #include <tempo_utils/file_utilities.h>
+#include <tempo_utils/file_writer.h>
 #include <tempo_utils/memory_bytes.h>
 
+#include <zuri_packager/package_reader.h>
 #include <zuri_packager/package_writer.h>
 
 class PackageWriter : public ::testing::Test {
@@ -68,3 +70,55 @@ TEST_F(PackageWriter, AddFileInDirectoryAndWritePackage)
     ASSERT_THAT (writePackageResult, tempo_test::IsResult());
     packagePath = writePackageResult.getResult();
 }
+
+TEST_F(PackageWriter, SpoolContentsAndWritePackage)
+{
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    zuri_packager::PackageWriterOptions options;
+    options.spoolContents = true;
+    zuri_packager::PackageWriter writer(specifier, options);
+    ASSERT_THAT (writer.configure(), tempo_test::IsOk());
+
+    auto path1 = tempo_utils::UrlPath::fromString("/file1.txt");
+    ASSERT_THAT (writer.putFile(path1, tempo_utils::MemoryBytes::copy("hello, world!")), tempo_test::IsResult());
+    auto path2 = tempo_utils::UrlPath::fromString("/file2.txt");
+    ASSERT_THAT (writer.putFile(path2, tempo_utils::MemoryBytes::copy("goodbye!")), tempo_test::IsResult());
+
+    auto writePackageResult = writer.writePackage();
+    ASSERT_THAT (writePackageResult, tempo_test::IsResult());
+    packagePath = writePackageResult.getResult();
+
+    auto openReaderResult = zuri_packager::PackageReader::open(packagePath);
+    ASSERT_THAT (openReaderResult, tempo_test::IsResult());
+    auto reader = openReaderResult.getResult();
+
+    auto slice1 = reader->readFileContents(path1).getResult();
+    ASSERT_EQ ("hello, world!", std::string((const char *) slice1.getData(), slice1.getSize()));
+    auto slice2 = reader->readFileContents(path2).getResult();
+    ASSERT_EQ ("goodbye!", std::string((const char *) slice2.getData(), slice2.getSize()));
+}
+
+TEST_F(PackageWriter, PutFileFromSourcePathAndWritePackage)
+{
+    auto sourcePath = std::filesystem::current_path() / tempo_utils::generate_name("source.XXXXXXXX");
+    tempo_utils::FileWriter fileWriter(sourcePath, tempo_utils::MemoryBytes::copy("hello, world!"),
+        tempo_utils::FileWriterMode::CREATE_ONLY);
+    ASSERT_THAT (fileWriter.getStatus(), tempo_test::IsOk());
+
+    auto specifier = zuri_packager::PackageSpecifier::fromString("foo-1.0.0@foocorp");
+    zuri_packager::PackageWriter writer(specifier);
+    ASSERT_THAT (writer.configure(), tempo_test::IsOk());
+
+    auto path = tempo_utils::UrlPath::fromString("/file.txt");
+    ASSERT_THAT (writer.putFile(path, sourcePath), tempo_test::IsResult());
+
+    auto writePackageResult = writer.writePackage();
+    std::filesystem::remove(sourcePath);
+    ASSERT_THAT (writePackageResult, tempo_test::IsResult());
+    packagePath = writePackageResult.getResult();
+
+    auto openReaderResult = zuri_packager::PackageReader::open(packagePath);
+    ASSERT_THAT (openReaderResult, tempo_test::IsResult());
+    auto slice = openReaderResult.getResult()->readFileContents(path).getResult();
+    ASSERT_EQ ("hello, world!", std::string((const char *) slice.getData(), slice.getSize()));
+}
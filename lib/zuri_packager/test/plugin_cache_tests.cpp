@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <tempo_test/result_matchers.h>
+#include <tempo_test/status_matchers.h>
+#include <tempo_utils/tempdir_maker.h>
+
+#include <zuri_packager/plugin_cache.h>
+
+class PluginCache : public ::testing::Test {
+protected:
+    std::filesystem::path testerRoot;
+    void SetUp() override {
+        tempo_utils::TempdirMaker testerMaker(std::filesystem::current_path(), "tester.XXXXXXXX");
+        TU_RAISE_IF_NOT_OK (testerMaker.getStatus());
+        testerRoot = testerMaker.getTempdir();
+    }
+    void TearDown() override {
+        if (std::filesystem::exists(testerRoot)) {
+            TU_ASSERT (std::filesystem::remove_all(testerRoot));
+            testerRoot.clear();
+        }
+    }
+};
+
+TEST_F(PluginCache, LoadMissingPluginReturnsEmptyOption)
+{
+    zuri_packager::PluginCache pluginCache;
+
+    auto loadPluginResult = pluginCache.loadPlugin(testerRoot / "missing.so");
+    ASSERT_THAT (loadPluginResult, tempo_test::IsResult());
+    ASSERT_TRUE (loadPluginResult.getResult().isEmpty());
+    ASSERT_EQ (0, pluginCache.numCachedPlugins());
+}
+
+TEST_F(PluginCache, ProcessCacheIsShared)
+{
+    auto cache1 = zuri_packager::PluginCache::processCache();
+    auto cache2 = zuri_packager::PluginCache::processCache();
+    ASSERT_TRUE (cache1 != nullptr);
+    ASSERT_EQ (cache1.get(), cache2.get());
+}
+
+TEST_F(PluginCache, LoadPluginTwiceSharesPlugin)
+{
+    zuri_packager::PluginCache pluginCache;
+
+    Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>> pluginOption1, pluginOption2;
+    TU_ASSIGN_OR_RAISE (pluginOption1, pluginCache.loadPlugin(TEST_PLUGIN_PATH));
+    TU_ASSIGN_OR_RAISE (pluginOption2, pluginCache.loadPlugin(TEST_PLUGIN_PATH));
+    ASSERT_TRUE (pluginOption1.hasValue());
+    ASSERT_TRUE (pluginOption2.hasValue());
+    ASSERT_EQ (pluginOption1.getValue().get(), pluginOption2.getValue().get());
+    ASSERT_EQ (pluginOption1.getValue()->getTrap(0), pluginOption2.getValue()->getTrap(0));
+    ASSERT_EQ (1, pluginCache.numCachedPlugins());
+}
+
+TEST_F(PluginCache, EvictUnusedUnloadsOnlyUnusedPlugins)
+{
+    zuri_packager::PluginCache pluginCache;
+
+    std::weak_ptr<const lyric_runtime::AbstractPlugin> weakPlugin;
+    {
+        Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>> pluginOption;
+        TU_ASSIGN_OR_RAISE (pluginOption, pluginCache.loadPlugin(TEST_PLUGIN_PATH));
+        ASSERT_TRUE (pluginOption.hasValue());
+        weakPlugin = pluginOption.getValue();
+
+        // a plugin which is in use is not evicted
+        pluginCache.evictUnused();
+        ASSERT_EQ (1, pluginCache.numCachedPlugins());
+        ASSERT_FALSE (weakPlugin.expired());
+    }
+
+    // once the last reference is dropped the plugin is evicted and its library is released
+    pluginCache.evictUnused();
+    ASSERT_EQ (0, pluginCache.numCachedPlugins());
+    ASSERT_TRUE (weakPlugin.expired());
+}
+
+TEST_F(PluginCache, LoadBeyondLimitEvictsLeastRecentlyLoadedPlugin)
+{
+    auto pluginPath1 = testerRoot / "plugin1.so";
+    auto pluginPath2 = testerRoot / "plugin2.so";
+    std::filesystem::copy_file(TEST_PLUGIN_PATH, pluginPath1);
+    std::filesystem::copy_file(TEST_PLUGIN_PATH, pluginPath2);
+
+    zuri_packager::PluginCacheOptions options;
+    options.maxCachedPlugins = 1;
+    zuri_packager::PluginCache pluginCache(options);
+
+    std::weak_ptr<const lyric_runtime::AbstractPlugin> weakPlugin1;
+    {
+        Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>> pluginOption;
+        TU_ASSIGN_OR_RAISE (pluginOption, pluginCache.loadPlugin(pluginPath1));
+        ASSERT_TRUE (pluginOption.hasValue());
+        weakPlugin1 = pluginOption.getValue();
+    }
+
+    Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>> pluginOption2;
+    TU_ASSIGN_OR_RAISE (pluginOption2, pluginCache.loadPlugin(pluginPath2));
+    ASSERT_TRUE (pluginOption2.hasValue());
+    ASSERT_EQ (1, pluginCache.numCachedPlugins());
+    ASSERT_TRUE (weakPlugin1.expired());
+}
+
+TEST_F(PluginCache, ReplacedPluginIsLoadedAgain)
+{
+    auto pluginPath = testerRoot / "plugin.so";
+    std::filesystem::copy_file(TEST_PLUGIN_PATH, pluginPath);
+
+    zuri_packager::PluginCache pluginCache;
+    Option<std::shared_ptr<const lyric_runtime::AbstractPlugin>> pluginOption1, pluginOption2;
+    TU_ASSIGN_OR_RAISE (pluginOption1, pluginCache.loadPlugin(pluginPath));
+
+    auto replacementPath = testerRoot / "replacement.so";
+    std::filesystem::copy_file(TEST_PLUGIN_PATH, replacementPath);
+    std::filesystem::rename(replacementPath, pluginPath);
+    TU_ASSIGN_OR_RAISE (pluginOption2, pluginCache.loadPlugin(pluginPath));
+
+    ASSERT_TRUE (pluginOption1.hasValue());
+    ASSERT_TRUE (pluginOption2.hasValue());
+    ASSERT_EQ (2, pluginCache.numCachedPlugins());
+
+    // the replacement is a separately loaded library rather than the handle of the original library
+    auto *trap1 = pluginOption1.getValue()->getTrap(0);
+    auto *trap2 = pluginOption2.getValue()->getTrap(0);
+    ASSERT_TRUE (trap1 != nullptr);
+    ASSERT_TRUE (trap2 != nullptr);
+    ASSERT_NE (trap1, trap2);
+}
@@ -0,0 +1,34 @@
+
+#include <lyric_runtime/native_interface.h>
+
+static tempo_utils::Status
+test_trap(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable)
+{
+    return {};
+}
+
+// the trap table lives in the library image, so each loaded copy of the library has its own table
+static const lyric_runtime::NativeTrap kTestTrap = {test_trap, "TEST_TRAP", 0};
+
+/**
+ * Minimal plugin with a single trap, used to exercise loading and unloading plugin libraries.
+ */
+class NativeTestPlugin : public lyric_runtime::NativeInterface {
+
+public:
+    NativeTestPlugin() = default;
+    bool load(lyric_runtime::BytecodeSegment *segment) const override { return true; };
+    void unload(lyric_runtime::BytecodeSegment *segment) const override {};
+    const lyric_runtime::NativeTrap *getTrap(uint32_t index) const override { return index == 0? &kTestTrap : nullptr; };
+    uint32_t numTraps() const override { return 1; };
+};
+
+static const NativeTestPlugin iface;
+
+extern "C" const lyric_runtime::NativeInterface *native_init()
+{
+    return &iface;
+}
@@ -1,7 +1,10 @@
 #ifndef ZURI_TOOLING_BUILD_GRAPH_H
 #define ZURI_TOOLING_BUILD_GRAPH_H
 
+#include <span>
+
 #include <lyric_build/lyric_builder.h>
+#include <zuri_tooling/build_schedule.h>
 #include <zuri_tooling/import_store.h>
 #include <zuri_tooling/target_store.h>
 
@@ -36,6 +39,8 @@ namespace zuri_tooling {
         std::shared_ptr<ImportStore> getImportStore() const;
 
         tempo_utils::Result<std::vector<std::string>> calculateBuildOrder(const std::string &targetName) const;
+        tempo_utils::Result<BuildSchedule> calculateBuildSchedule(const std::string &targetName) const;
+        tempo_utils::Result<BuildSchedule> calculateBuildSchedule(std::span<const std::string> targetNames) const;
 
         bool hasCycles() const;
         absl::flat_hash_set<std::vector<std::string>>::const_iterator cyclesBegin() const;
@@ -0,0 +1,40 @@
+#ifndef ZURI_TOOLING_BUILD_SCHEDULE_H
+#define ZURI_TOOLING_BUILD_SCHEDULE_H
+
+#include <string>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace zuri_tooling {
+
+    /**
+     * Tracks the progress of building a set of targets. A target becomes ready once every target
+     * it depends on has completed, so all targets which are ready at the same time are independent
+     * of each other and may be built concurrently. BuildSchedule is not thread-safe, callers which
+     * share a schedule between threads must synchronize access.
+     */
+    class BuildSchedule {
+    public:
+        BuildSchedule();
+        BuildSchedule(
+            absl::flat_hash_map<std::string,int> &&numPendingDepends,
+            absl::flat_hash_map<std::string,std::vector<std::string>> &&dependents);
+
+        int numTargets() const;
+        int numRemaining() const;
+        bool isComplete() const;
+        bool hasDependents(const std::string &targetName) const;
+
+        std::vector<std::string> takeReadyTargets();
+        void completeTarget(const std::string &targetName);
+
+    private:
+        absl::flat_hash_map<std::string,int> m_numPendingDepends;
+        absl::flat_hash_map<std::string,std::vector<std::string>> m_dependents;
+        std::vector<std::string> m_ready;
+        int m_numRemaining;
+    };
+}
+
+#endif // ZURI_TOOLING_BUILD_SCHEDULE_H
@@ -222,6 +222,67 @@ zuri_tooling::BuildGraph::calculateBuildOrder(const std::string &targetName) con
     return targetBuildOrder;
 }
 
+/**
+ * Calculate the schedule for building the specified target and all of its transitive dependencies.
+ * Unlike the build order, the schedule preserves which targets are independent of each other, so
+ * that independent targets can be built concurrently.
+ *
+ * @param targetName The name of the requested target.
+ * @return The build schedule.
+ */
+tempo_utils::Result<zuri_tooling::BuildSchedule>
+zuri_tooling::BuildGraph::calculateBuildSchedule(const std::string &targetName) const
+{
+    return calculateBuildSchedule(std::span<const std::string>(&targetName, 1));
+}
+
+/**
+ * Calculate the schedule for building the specified targets and the union of their transitive
+ * dependencies. A target which is shared by more than one requested target appears in the
+ * schedule exactly once.
+ *
+ * @param targetNames The names of the requested targets.
+ * @return The build schedule.
+ */
+tempo_utils::Result<zuri_tooling::BuildSchedule>
+zuri_tooling::BuildGraph::calculateBuildSchedule(std::span<const std::string> targetNames) const
+{
+    std::vector<std::string> targetBuildOrder;
+    BuildOrderingVisitor vis(targetBuildOrder);
+
+    // share the color map between visits so that targets reachable from more than one requested
+    // target are only visited once
+    std::vector<boost::default_color_type> colors(boost::num_vertices(m_priv->buildGraph));
+    auto vertex_index = boost::get(boost::vertex_index, m_priv->buildGraph);
+    auto colorMap = boost::make_iterator_property_map(colors.begin(), vertex_index, colors[0]);
+
+    for (const auto &targetName : targetNames) {
+        auto entry = m_priv->targetsMap.find(targetName);
+        if (entry == m_priv->targetsMap.cend())
+            return tempo_config::ConfigStatus::forCondition(tempo_config::ConfigCondition::kMissingValue,
+                "unknown target '{}'", targetName);
+        if (boost::get(colorMap, entry->second) == boost::white_color) {
+            boost::depth_first_visit(m_priv->buildGraph, entry->second, vis, colorMap);
+        }
+    }
+
+    auto target_name = get(internal::vertex_target_name_t(), m_priv->buildGraph);
+
+    absl::flat_hash_map<std::string,int> numPendingDepends;
+    absl::flat_hash_map<std::string,std::vector<std::string>> dependents;
+    for (const auto &name : targetBuildOrder) {
+        auto v = m_priv->targetsMap.at(name);
+        auto &numPending = numPendingDepends[name];
+        for (auto [it, end] = boost::out_edges(v, m_priv->buildGraph); it != end; ++it) {
+            const std::string dependName = boost::get(target_name, boost::target(*it, m_priv->buildGraph));
+            dependents[dependName].push_back(name);
+            numPending++;
+        }
+    }
+
+    return BuildSchedule(std::move(numPendingDepends), std::move(dependents));
+}
+
 bool
 zuri_tooling::BuildGraph::hasCycles() const
 {
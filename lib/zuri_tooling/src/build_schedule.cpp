@@ -0,0 +1,97 @@
+
+#include <algorithm>
+
+#include <zuri_tooling/build_schedule.h>
+
+zuri_tooling::BuildSchedule::BuildSchedule()
+    : m_numRemaining(0)
+{
+}
+
+/**
+ * Construct a schedule for the specified targets.
+ *
+ * @param numPendingDepends Map of each scheduled target to the number of its dependencies.
+ * @param dependents Map of each scheduled target to the targets which depend on it.
+ */
+zuri_tooling::BuildSchedule::BuildSchedule(
+    absl::flat_hash_map<std::string,int> &&numPendingDepends,
+    absl::flat_hash_map<std::string,std::vector<std::string>> &&dependents)
+    : m_numPendingDepends(std::move(numPendingDepends)),
+      m_dependents(std::move(dependents)),
+      m_numRemaining(m_numPendingDepends.size())
+{
+    for (const auto &entry : m_numPendingDepends) {
+        if (entry.second == 0) {
+            m_ready.push_back(entry.first);
+        }
+    }
+    // order the initial targets so that the schedule is deterministic
+    std::sort(m_ready.begin(), m_ready.end());
+}
+
+int
+zuri_tooling::BuildSchedule::numTargets() const
+{
+    return m_numPendingDepends.size();
+}
+
+int
+zuri_tooling::BuildSchedule::numRemaining() const
+{
+    return m_numRemaining;
+}
+
+bool
+zuri_tooling::BuildSchedule::isComplete() const
+{
+    return m_numRemaining == 0;
+}
+
+/**
+ * Returns true if any target in the schedule depends on the specified target.
+ */
+bool
+zuri_tooling::BuildSchedule::hasDependents(const std::string &targetName) const
+{
+    auto entry = m_dependents.find(targetName);
+    return entry != m_dependents.cend() && !entry->second.empty();
+}
+
+/**
+ * Returns the targets which have become ready since the previous call. Each target is returned
+ * exactly once.
+ */
+std::vector<std::string>
+zuri_tooling::BuildSchedule::takeReadyTargets()
+{
+    std::vector<std::string> ready;
+    ready.swap(m_ready);
+    return ready;
+}
+
+/**
+ * Mark the specified target as complete, which makes each dependent target ready once all of
+ * its other dependencies have completed.
+ *
+ * @param targetName The completed target.
+ */
+void
+zuri_tooling::BuildSchedule::completeTarget(const std::string &targetName)
+{
+    auto entry = m_numPendingDepends.find(targetName);
+    if (entry == m_numPendingDepends.cend() || entry->second < 0)
+        return;
+    entry->second = -1;
+    m_numRemaining--;
+
+    auto dependentsEntry = m_dependents.find(targetName);
+    if (dependentsEntry == m_dependents.cend())
+        return;
+    for (const auto &dependent : dependentsEntry->second) {
+        auto &numPending = m_numPendingDepends[dependent];
+        if (--numPending == 0) {
+            m_ready.push_back(dependent);
+        }
+    }
+}
@@ -173,3 +173,100 @@ TEST(BuildGraph, DetermineTargetBuildOrder)
     ASSERT_THAT  (orderA, testing::ElementsAre("C", "B", "A"));
 }
 
+
+TEST(BuildGraph, DetermineTargetBuildSchedule)
+{
+    tempo_config::ConfigNode targetsConfig;
+    TU_ASSIGN_OR_RAISE (targetsConfig, tempo_config::read_config_string(R"(
+    {
+        "A": {
+            "type": "Program",
+            "specifier": "prog1-1.0.1@foo.corp",
+            "programMain": "/prog1",
+            "depends": [ "B", "C" ]
+        },
+        "B": {
+            "type": "Library",
+            "specifier": "lib1-1.0.1@foo.corp",
+            "libraryModules": ["/lib1"],
+            "depends": [ "D" ]
+        },
+        "C": {
+            "type": "Library",
+            "specifier": "lib2-1.0.1@foo.corp",
+            "libraryModules": ["/lib2"]
+        },
+        "D": {
+            "type": "Library",
+            "specifier": "lib3-1.0.1@foo.corp",
+            "libraryModules": ["/lib3"]
+        }
+    }
+    )"));
+    auto targetStore = std::make_shared<zuri_tooling::TargetStore>(targetsConfig.toMap());
+    TU_RAISE_IF_NOT_OK (targetStore->configure());
+    auto importStore = std::make_shared<zuri_tooling::ImportStore>(tempo_config::ConfigMap{});
+    TU_RAISE_IF_NOT_OK (importStore->configure());
+    std::shared_ptr<zuri_tooling::BuildGraph> buildGraph;
+    TU_ASSIGN_OR_RAISE (buildGraph, zuri_tooling::BuildGraph::create(targetStore, importStore));
+
+    zuri_tooling::BuildSchedule schedule;
+    TU_ASSIGN_OR_RAISE (schedule, buildGraph->calculateBuildSchedule("A"));
+    ASSERT_EQ (4, schedule.numTargets());
+
+    // the independent targets are ready immediately
+    ASSERT_THAT (schedule.takeReadyTargets(), testing::ElementsAre("C", "D"));
+    ASSERT_TRUE (schedule.takeReadyTargets().empty());
+
+    schedule.completeTarget("D");
+    ASSERT_THAT (schedule.takeReadyTargets(), testing::ElementsAre("B"));
+    schedule.completeTarget("B");
+    ASSERT_TRUE (schedule.takeReadyTargets().empty());
+    schedule.completeTarget("C");
+    ASSERT_THAT (schedule.takeReadyTargets(), testing::ElementsAre("A"));
+    schedule.completeTarget("A");
+    ASSERT_TRUE (schedule.isComplete());
+}
+
+TEST(BuildGraph, DetermineBuildScheduleForMultipleTargets)
+{
+    tempo_config::ConfigNode targetsConfig;
+    TU_ASSIGN_OR_RAISE (targetsConfig, tempo_config::read_config_string(R"(
+    {
+        "A": {
+            "type": "Program",
+            "specifier": "prog1-1.0.1@foo.corp",
+            "programMain": "/prog1",
+            "depends": [ "C" ]
+        },
+        "B": {
+            "type": "Program",
+            "specifier": "prog2-1.0.1@foo.corp",
+            "programMain": "/prog2",
+            "depends": [ "C" ]
+        },
+        "C": {
+            "type": "Library",
+            "specifier": "lib1-1.0.1@foo.corp",
+            "libraryModules": ["/lib1"]
+        }
+    }
+    )"));
+    auto targetStore = std::make_shared<zuri_tooling::TargetStore>(targetsConfig.toMap());
+    TU_RAISE_IF_NOT_OK (targetStore->configure());
+    auto importStore = std::make_shared<zuri_tooling::ImportStore>(tempo_config::ConfigMap{});
+    TU_RAISE_IF_NOT_OK (importStore->configure());
+    std::shared_ptr<zuri_tooling::BuildGraph> buildGraph;
+    TU_ASSIGN_OR_RAISE (buildGraph, zuri_tooling::BuildGraph::create(targetStore, importStore));
+
+    std::vector<std::string> targetNames = {"A", "B"};
+    zuri_tooling::BuildSchedule schedule;
+    TU_ASSIGN_OR_RAISE (schedule, buildGraph->calculateBuildSchedule(targetNames));
+
+    // the shared dependency is scheduled once
+    ASSERT_EQ (3, schedule.numTargets());
+    ASSERT_TRUE (schedule.hasDependents("C"));
+    ASSERT_THAT (schedule.takeReadyTargets(), testing::ElementsAre("C"));
+    schedule.completeTarget("C");
+    ASSERT_THAT (schedule.takeReadyTargets(), testing::UnorderedElementsAre("A", "B"));
+}
@@ -32,8 +32,8 @@ HashMapRef::initialize(const HashMapEq &eq)
 std::string
 HashMapRef::toString() const
 {
-    return absl::Substitute("<$0: HashMap contains $1 entries, gen=$2>",
-        this, m_map.size(), m_gen);
+    return absl::Substitute("<$0: HashMap contains $1 entries, gen=$2, native=$3>",
+        this, m_map.size(), m_gen, m_eq.isNative());
 }
 
 bool
@@ -74,6 +74,44 @@ HashMapRef::put(const lyric_runtime::DataCell &key, const lyric_runtime::DataCel
     return prev;
 }
 
+/**
+ * Put each entry of the other map into this map, replacing the value of any key which is
+ * already present.
+ *
+ * @param other The map to copy entries from.
+ */
+void
+HashMapRef::putAll(HashMapRef *other)
+{
+    TU_ASSERT (other != nullptr);
+    if (other == this || other->m_map.empty())
+        return;
+    m_map.reserve(m_map.size() + other->m_map.size());
+    for (const auto &entry : other->m_map) {
+        // like put(), an existing entry is replaced including its key
+        HashMapKey k{ entry.first.cell };
+        m_map.erase(k);
+        m_map.emplace(k, entry.second);
+    }
+    ++m_gen;
+}
+
+/**
+ * Grow the map so that it can hold at least the specified number of entries without rehashing.
+ */
+void
+HashMapRef::reserve(int capacity)
+{
+    if (capacity <= 0)
+        return;
+    auto bucketCount = m_map.bucket_count();
+    m_map.reserve(capacity);
+    // growing the map rehashes the entries, which invalidates any iterators
+    if (m_map.bucket_count() != bucketCount) {
+        ++m_gen;
+    }
+}
+
 lyric_runtime::DataCell
 HashMapRef::remove(const lyric_runtime::DataCell &key)
 {
@@ -149,19 +187,34 @@ HashMapEq::HashMapEq(
       m_ctxArgument(ctxArgument),
       m_equalsCall(equalsCall)
 {
+    // keys compared by a standard Equality instance don't need to run the subinterpreter
+    m_nativeKeyType = detect_native_key_type(m_ctxArgument);
 }
 
 HashMapEq::HashMapEq(const HashMapEq &other) noexcept
     : m_interp(other.m_interp),
       m_state(other.m_state),
       m_ctxArgument(other.m_ctxArgument),
-      m_equalsCall(other.m_equalsCall)
+      m_equalsCall(other.m_equalsCall),
+      m_nativeKeyType(other.m_nativeKeyType)
+{
+}
+
+/**
+ * Returns true if keys are compared natively rather than through the subinterpreter.
+ */
+bool
+HashMapEq::isNative() const
 {
+    return m_nativeKeyType != NativeKeyType::None;
 }
 
 bool
 HashMapEq::operator()(const HashMapKey& lhs, const HashMapKey& rhs) const
 {
+    if (m_nativeKeyType != NativeKeyType::None)
+        return native_key_equals(lhs.cell, rhs.cell);
+
     auto *currentCoro = m_state->currentCoro();
     auto *subroutineManager = m_state->subroutineManager();
 
@@ -10,6 +10,7 @@
 #include <lyric_runtime/bytecode_interpreter.h>
 
 #include "hashmap_key.h"
+#include "native_key.h"
 
 class HashMapEq {
 public:
@@ -22,11 +23,14 @@ public:
     HashMapEq(const HashMapEq &other) noexcept;
     bool operator()(const HashMapKey& lhs, const HashMapKey& rhs) const;
 
+    bool isNative() const;
+
 private:
     lyric_runtime::BytecodeInterpreter *m_interp = nullptr;
     lyric_runtime::InterpreterState *m_state = nullptr;
     lyric_runtime::DataCell m_ctxArgument;
     lyric_runtime::DataCell m_equalsCall;
+    NativeKeyType m_nativeKeyType = NativeKeyType::None;
 };
 
 using HashMapImpl = absl::flat_hash_map<
@@ -51,6 +55,8 @@ public:
     int generation() const;
 
     lyric_runtime::DataCell put(const lyric_runtime::DataCell &key, const lyric_runtime::DataCell &value);
+    void putAll(HashMapRef *other);
+    void reserve(int capacity);
     lyric_runtime::DataCell remove(const lyric_runtime::DataCell &key);
     HashMapImpl::iterator begin();
     HashMapImpl::iterator end();
@@ -1,5 +1,7 @@
 /* SPDX-License-Identifier: BSD-3-Clause */
 
+#include <limits>
+
 #include <tempo_utils/log_stream.h>
 
 #include "hashmap_ref.h"
@@ -41,6 +43,9 @@ hashmap_ctor(
 
     instance->initialize(HashMapEq(interp, state, ctxArgument, equalsCall));
 
+    // size the map for the initial entries so that putting them does not rehash
+    instance->reserve(frame.numRest());
+
     return {};
 }
 
@@ -146,6 +151,52 @@ hashmap_remove(
     return {};
 }
 
+tempo_utils::Status
+hashmap_put_all(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable)
+{
+    auto *currentCoro = state->currentCoro();
+
+    auto &frame = currentCoro->currentCallOrThrow();
+
+    TU_ASSERT(frame.numArguments() == 1);
+    const auto &argument = frame.getArgument(0);
+    TU_ASSERT(argument.type == lyric_runtime::DataCellType::REF);
+    auto *other = static_cast<HashMapRef *>(argument.data.ref);
+
+    auto receiver = frame.getReceiver();
+    TU_ASSERT(receiver.type == lyric_runtime::DataCellType::REF);
+    auto *instance = static_cast<HashMapRef *>(receiver.data.ref);
+    instance->putAll(other);
+    return {};
+}
+
+tempo_utils::Status
+hashmap_reserve(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable)
+{
+    auto *currentCoro = state->currentCoro();
+
+    auto &frame = currentCoro->currentCallOrThrow();
+
+    TU_ASSERT(frame.numArguments() == 1);
+    const auto &capacity = frame.getArgument(0);
+    TU_ASSERT(capacity.type == lyric_runtime::DataCellType::I64);
+
+    auto receiver = frame.getReceiver();
+    TU_ASSERT(receiver.type == lyric_runtime::DataCellType::REF);
+    auto *instance = static_cast<HashMapRef *>(receiver.data.ref);
+    // capacity is only a hint, so a capacity which is out of range is ignored
+    if (0 < capacity.data.i64 && capacity.data.i64 <= std::numeric_limits<int>::max()) {
+        instance->reserve(static_cast<int>(capacity.data.i64));
+    }
+    return {};
+}
+
 tempo_utils::Status
 hashmap_clear(
     lyric_runtime::BytecodeInterpreter *interp,
@@ -41,6 +41,16 @@ tempo_utils::Status hashmap_remove(
     lyric_runtime::InterpreterState *state,
     const lyric_runtime::VirtualTable *vtable);
 
+tempo_utils::Status hashmap_put_all(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable);
+
+tempo_utils::Status hashmap_reserve(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable);
+
 tempo_utils::Status hashmap_clear(
     lyric_runtime::BytecodeInterpreter *interp,
     lyric_runtime::InterpreterState *state,
@@ -10,7 +10,7 @@
 #include "treeset_traps.h"
 #include "vector_traps.h"
 
-std::array<lyric_runtime::NativeTrap,53> kStdCollectionsTraps = {{
+std::array<lyric_runtime::NativeTrap,58> kStdCollectionsTraps = {{
     {hashmap_alloc, "STD_COLLECTIONS_HASHMAP_ALLOC", 0},
     {hashmap_ctor, "STD_COLLECTIONS_HASHMAP_CTOR", 0},
     {hashmap_size, "STD_COLLECTIONS_HASHMAP_SIZE", 0},
@@ -19,6 +19,8 @@ std::array<lyric_runtime::NativeTrap,53> kStdCollectionsTraps = {{
     {hashmap_put, "STD_COLLECTIONS_HASHMAP_PUT", 0},
     {hashmap_remove, "STD_COLLECTIONS_HASHMAP_REMOVE", 0},
     {hashmap_clear, "STD_COLLECTIONS_HASHMAP_CLEAR", 0},
+    {hashmap_put_all, "STD_COLLECTIONS_HASHMAP_PUT_ALL", 0},
+    {hashmap_reserve, "STD_COLLECTIONS_HASHMAP_RESERVE", 0},
     {hashmap_iterate, "STD_COLLECTIONS_HASHMAP_ITERABLE_ITERATE", 0},
     {hashmap_iterator_alloc, "STD_COLLECTIONS_HASHMAP_ITERATOR_ALLOC", 0},
     {hashmap_iterator_valid, "STD_COLLECTIONS_HASHMAP_ITERATOR_VALID", 0},
@@ -47,6 +49,7 @@ std::array<lyric_runtime::NativeTrap,53> kStdCollectionsTraps = {{
     {treeset_remove, "STD_COLLECTIONS_TREESET_REMOVE", 0},
     {treeset_replace, "STD_COLLECTIONS_TREESET_REPLACE", 0},
     {treeset_clear, "STD_COLLECTIONS_TREESET_CLEAR", 0},
+    {treeset_add_all, "STD_COLLECTIONS_TREESET_ADD_ALL", 0},
     {treeset_iterate, "STD_COLLECTIONS_TREESET_ITERABLE_ITERATE", 0},
     {treeset_iterator_alloc, "STD_COLLECTIONS_TREESET_ITERATOR_ALLOC", 0},
     {treeset_iterator_next, "STD_COLLECTIONS_TREESET_ITERATOR_NEXT", 0},
@@ -60,6 +63,8 @@ std::array<lyric_runtime::NativeTrap,53> kStdCollectionsTraps = {{
     {vector_replace, "STD_COLLECTIONS_VECTOR_REPLACE", 0},
     {vector_remove, "STD_COLLECTIONS_VECTOR_REMOVE", 0},
     {vector_clear, "STD_COLLECTIONS_VECTOR_CLEAR", 0},
+    {vector_extend, "STD_COLLECTIONS_VECTOR_EXTEND", 0},
+    {vector_reserve, "STD_COLLECTIONS_VECTOR_RESERVE", 0},
     {vector_iterate, "STD_COLLECTIONS_VECTOR_ITERABLE_ITERATE", 0},
     {vector_iterator_alloc, "STD_COLLECTIONS_VECTOR_ITERATOR_ALLOC", 0},
     {vector_iterator_next, "STD_COLLECTIONS_VECTOR_ITERATOR_NEXT", 0},
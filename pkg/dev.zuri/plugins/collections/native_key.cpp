@@ -0,0 +1,161 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+
+#include <array>
+#include <cmath>
+#include <string_view>
+
+#include <lyric_common/symbol_url.h>
+#include <lyric_runtime/base_ref.h>
+#include <lyric_runtime/string_ref.h>
+#include <lyric_runtime/url_ref.h>
+
+#include "native_key.h"
+
+struct StandardInstance {
+    lyric_common::SymbolUrl symbolUrl;
+    NativeKeyType keyType;
+};
+
+/**
+ * Returns the standard instances declared in the bootstrap prelude which operate on keys that
+ * can be compared natively. The symbol urls are constructed once on first use.
+ */
+static const std::array<StandardInstance,6> &
+standard_instances()
+{
+    static const auto preludeLocation = lyric_common::ModuleLocation::fromString("dev.zuri.bootstrap:/prelude");
+    static const std::array<StandardInstance,6> instances = {{
+        {lyric_common::SymbolUrl(preludeLocation, lyric_common::SymbolPath({"BoolInstance"})), NativeKeyType::Bool},
+        {lyric_common::SymbolUrl(preludeLocation, lyric_common::SymbolPath({"CharInstance"})), NativeKeyType::Char},
+        {lyric_common::SymbolUrl(preludeLocation, lyric_common::SymbolPath({"IntInstance"})), NativeKeyType::Int},
+        {lyric_common::SymbolUrl(preludeLocation, lyric_common::SymbolPath({"FloatInstance"})), NativeKeyType::Float},
+        {lyric_common::SymbolUrl(preludeLocation, lyric_common::SymbolPath({"StringInstance"})), NativeKeyType::String},
+        {lyric_common::SymbolUrl(preludeLocation, lyric_common::SymbolPath({"UrlInstance"})), NativeKeyType::Url},
+    }};
+    return instances;
+}
+
+/**
+ * Determine whether the specified instance is one of the standard instances declared in the
+ * bootstrap prelude, and if so return the key type it operates on. Any other instance, including
+ * user-defined instances for the same types, must be invoked through the subinterpreter. This is
+ * called once when a collection comparator is constructed, and the result is stored in the
+ * comparator.
+ *
+ * @param instance The instance passed to the collection constructor.
+ * @return The key type, or NativeKeyType::None if the keys cannot be compared natively.
+ */
+NativeKeyType
+detect_native_key_type(const lyric_runtime::DataCell &instance)
+{
+    if (instance.type != lyric_runtime::DataCellType::REF || instance.data.ref == nullptr)
+        return NativeKeyType::None;
+    const auto *vtable = instance.data.ref->getVirtualTable();
+    if (vtable == nullptr)
+        return NativeKeyType::None;
+
+    const auto &symbolUrl = vtable->getSymbolUrl();
+    for (const auto &standardInstance : standard_instances()) {
+        if (symbolUrl == standardInstance.symbolUrl)
+            return standardInstance.keyType;
+    }
+    return NativeKeyType::None;
+}
+
+/**
+ * Returns a view of the utf-8 data of the specified string cell.
+ */
+static std::string_view
+string_view_of(const lyric_runtime::DataCell &cell)
+{
+    return std::string_view(cell.data.str->getStringData(), cell.data.str->getStringSize());
+}
+
+/**
+ * Compare the specified keys for equality using the semantics of the standard Equality instances.
+ *
+ * @param lhs The left-hand key.
+ * @param rhs The right-hand key.
+ * @return true if the keys are equal, otherwise false.
+ */
+bool
+native_key_equals(const lyric_runtime::DataCell &lhs, const lyric_runtime::DataCell &rhs)
+{
+    if (lhs.type != rhs.type)
+        return false;
+    switch (lhs.type) {
+        case lyric_runtime::DataCellType::BOOL:
+            return lhs.data.b == rhs.data.b;
+        case lyric_runtime::DataCellType::CHAR32:
+            return lhs.data.chr == rhs.data.chr;
+        case lyric_runtime::DataCellType::I64:
+            return lhs.data.i64 == rhs.data.i64;
+        case lyric_runtime::DataCellType::DBL:
+            return lhs.data.dbl == rhs.data.dbl;
+        case lyric_runtime::DataCellType::STRING:
+            return lhs.data.str == rhs.data.str || string_view_of(lhs) == string_view_of(rhs);
+        case lyric_runtime::DataCellType::URL: {
+            if (lhs.data.url == rhs.data.url)
+                return true;
+            auto lhsUrl = lhs.data.url->getUrl();
+            auto rhsUrl = rhs.data.url->getUrl();
+            return std::string_view(lhsUrl.uriView()) == std::string_view(rhsUrl.uriView());
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * Returns true if keys of the specified type can be ordered natively using the semantics of the
+ * standard Ordered instance for the type.
+ */
+bool
+is_native_ordered_key_type(NativeKeyType keyType)
+{
+    switch (keyType) {
+        case NativeKeyType::Char:
+        case NativeKeyType::Int:
+        case NativeKeyType::Float:
+        case NativeKeyType::String:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Order the specified keys using the semantics of the standard Ordered instances. Strings are
+ * ordered by code point, and NaN is ordered after all other floats.
+ *
+ * @param lhs The left-hand key.
+ * @param rhs The right-hand key.
+ * @return true if lhs is ordered before rhs, otherwise false.
+ */
+bool
+native_key_less(const lyric_runtime::DataCell &lhs, const lyric_runtime::DataCell &rhs)
+{
+    // keys of a single collection have the same type, but order by type anyway so the
+    // ordering is always a strict weak ordering
+    if (lhs.type != rhs.type)
+        return lhs.type < rhs.type;
+    switch (lhs.type) {
+        case lyric_runtime::DataCellType::CHAR32:
+            return lhs.data.chr < rhs.data.chr;
+        case lyric_runtime::DataCellType::I64:
+            return lhs.data.i64 < rhs.data.i64;
+        case lyric_runtime::DataCellType::DBL: {
+            // NaN is ordered after every other value and equal to itself, so the ordering is total
+            if (std::isnan(lhs.data.dbl))
+                return false;
+            if (std::isnan(rhs.data.dbl))
+                return true;
+            return lhs.data.dbl < rhs.data.dbl;
+        }
+        case lyric_runtime::DataCellType::STRING:
+            // utf-8 byte order is equivalent to code point order
+            return lhs.data.str != rhs.data.str && string_view_of(lhs) < string_view_of(rhs);
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,30 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+
+#ifndef ZURI_STD_COLLECTIONS_NATIVE_KEY_H
+#define ZURI_STD_COLLECTIONS_NATIVE_KEY_H
+
+#include <lyric_runtime/data_cell.h>
+
+/**
+ * The key types which collections can compare natively, without running the comparison
+ * through the subinterpreter.
+ */
+enum class NativeKeyType {
+    None,
+    Bool,
+    Char,
+    Int,
+    Float,
+    String,
+    Url,
+};
+
+NativeKeyType detect_native_key_type(const lyric_runtime::DataCell &instance);
+
+bool native_key_equals(const lyric_runtime::DataCell &lhs, const lyric_runtime::DataCell &rhs);
+
+bool is_native_ordered_key_type(NativeKeyType keyType);
+
+bool native_key_less(const lyric_runtime::DataCell &lhs, const lyric_runtime::DataCell &rhs);
+
+#endif // ZURI_STD_COLLECTIONS_NATIVE_KEY_H
@@ -173,19 +173,25 @@ TreeMapComparator::TreeMapComparator(
       m_ctxArgument(ctxArgument),
       m_compareCall(compareCall)
 {
+    // keys ordered by a standard Ordered instance don't need to run the subinterpreter
+    m_isNative = is_native_ordered_key_type(detect_native_key_type(m_ctxArgument));
 }
 
 TreeMapComparator::TreeMapComparator(const TreeMapComparator &other) noexcept
     : m_interp(other.m_interp),
       m_state(other.m_state),
       m_ctxArgument(other.m_ctxArgument),
-      m_compareCall(other.m_compareCall)
+      m_compareCall(other.m_compareCall),
+      m_isNative(other.m_isNative)
 {
 }
 
 bool
 TreeMapComparator::operator()(const lyric_runtime::DataCell& lhs, const lyric_runtime::DataCell& rhs) const
 {
+    if (m_isNative)
+        return native_key_less(lhs, rhs);
+
     auto *currentCoro = m_state->currentCoro();
 
     std::vector args {lhs, rhs, m_ctxArgument};
@@ -8,6 +8,8 @@
 #include <lyric_runtime/base_ref.h>
 #include <lyric_runtime/bytecode_interpreter.h>
 
+#include "native_key.h"
+
 class TreeMapComparator {
 public:
     TreeMapComparator() = default;
@@ -24,6 +26,7 @@ private:
     lyric_runtime::InterpreterState *m_state = nullptr;
     lyric_runtime::DataCell m_ctxArgument;
     lyric_runtime::DataCell m_compareCall;
+    bool m_isNative = false;
 };
 
 using TreeMapImpl = absl::btree_map<
@@ -77,6 +77,29 @@ TreeSetRef::add(const lyric_runtime::DataCell &value)
     return lyric_runtime::DataCell(result.second);
 }
 
+/**
+ * Add each element of the other set to this set.
+ *
+ * @param other The set to copy elements from.
+ * @return true if any element was added, otherwise false.
+ */
+bool
+TreeSetRef::addAll(const TreeSetRef *other)
+{
+    TU_ASSERT (other != nullptr);
+    if (other == this)
+        return false;
+    bool changed = false;
+    for (const auto &value : other->m_set) {
+        changed |= m_set.insert(value).second;
+    }
+    // iterators remain valid if no elements were inserted
+    if (changed) {
+        ++m_gen;
+    }
+    return changed;
+}
+
 lyric_runtime::DataCell
 TreeSetRef::remove(const lyric_runtime::DataCell &value)
 {
@@ -150,19 +173,25 @@ TreeSetComparator::TreeSetComparator(
       m_ctxArgument(ctxArgument),
       m_compareCall(compareCall)
 {
+    // keys ordered by a standard Ordered instance don't need to run the subinterpreter
+    m_isNative = is_native_ordered_key_type(detect_native_key_type(m_ctxArgument));
 }
 
 TreeSetComparator::TreeSetComparator(const TreeSetComparator &other) noexcept
     : m_interp(other.m_interp),
       m_state(other.m_state),
       m_ctxArgument(other.m_ctxArgument),
-      m_compareCall(other.m_compareCall)
+      m_compareCall(other.m_compareCall),
+      m_isNative(other.m_isNative)
 {
 }
 
 bool
 TreeSetComparator::operator()(const lyric_runtime::DataCell& lhs, const lyric_runtime::DataCell& rhs) const
 {
+    if (m_isNative)
+        return native_key_less(lhs, rhs);
+
     auto *currentCoro = m_state->currentCoro();
 
     std::vector args {lhs, rhs, m_ctxArgument};
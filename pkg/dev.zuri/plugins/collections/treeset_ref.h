@@ -8,6 +8,8 @@
 #include <lyric_runtime/base_ref.h>
 #include <lyric_runtime/bytecode_interpreter.h>
 
+#include "native_key.h"
+
 class TreeSetComparator {
 public:
     TreeSetComparator() = default;
@@ -24,6 +26,7 @@ private:
     lyric_runtime::InterpreterState *m_state = nullptr;
     lyric_runtime::DataCell m_ctxArgument;
     lyric_runtime::DataCell m_compareCall;
+    bool m_isNative = false;
 };
 
 class TreeSetRef : public lyric_runtime::BaseRef {
@@ -43,6 +46,7 @@ public:
     int generation() const;
 
     lyric_runtime::DataCell add(const lyric_runtime::DataCell &value);
+    bool addAll(const TreeSetRef *other);
     lyric_runtime::DataCell remove(const lyric_runtime::DataCell &value);
     lyric_runtime::DataCell replace(const lyric_runtime::DataCell &value);
     absl::btree_set<lyric_runtime::DataCell,TreeSetComparator>::iterator begin();
@@ -40,6 +40,11 @@ treeset_ctor(
     TU_ASSERT(compareCall.type == lyric_runtime::DataCellType::CALL);
     instance->initialize(TreeSetComparator(interp, state, ctxArgument, compareCall));
 
+    // add the initial elements here rather than once per element from the constructor
+    for (int i = 0; i < frame.numRest(); i++) {
+        instance->add(frame.getRest(i));
+    }
+
     return {};
 }
 
@@ -145,6 +150,29 @@ treeset_replace(
     return {};
 }
 
+tempo_utils::Status
+treeset_add_all(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable)
+{
+    auto *currentCoro = state->currentCoro();
+
+    auto &frame = currentCoro->currentCallOrThrow();
+
+    TU_ASSERT(frame.numArguments() == 1);
+    const auto &argument = frame.getArgument(0);
+    TU_ASSERT(argument.type == lyric_runtime::DataCellType::REF);
+    auto *other = static_cast<TreeSetRef *>(argument.data.ref);
+
+    auto receiver = frame.getReceiver();
+    TU_ASSERT(receiver.type == lyric_runtime::DataCellType::REF);
+    auto *instance = static_cast<TreeSetRef *>(receiver.data.ref);
+    auto changed = instance->addAll(other);
+    currentCoro->pushData(lyric_runtime::DataCell(changed));
+    return {};
+}
+
 tempo_utils::Status
 treeset_clear(
     lyric_runtime::BytecodeInterpreter *interp,
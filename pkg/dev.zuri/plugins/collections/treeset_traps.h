@@ -41,6 +41,11 @@ tempo_utils::Status treeset_replace(
     lyric_runtime::InterpreterState *state,
     const lyric_runtime::VirtualTable *vtable);
 
+tempo_utils::Status treeset_add_all(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable);
+
 tempo_utils::Status treeset_clear(
     lyric_runtime::BytecodeInterpreter *interp,
     lyric_runtime::InterpreterState *state,
@@ -87,6 +87,36 @@ VectorRef::append(const lyric_runtime::DataCell &value)
     m_seq.push_back(value);
 }
 
+/**
+ * Append each element of the other vector to the end of this vector.
+ *
+ * @param other The vector to copy elements from.
+ */
+void
+VectorRef::extend(const VectorRef *other)
+{
+    TU_ASSERT (other != nullptr);
+    if (other == this) {
+        // copy first, growing the sequence would invalidate the source range
+        auto elements = m_seq;
+        m_seq.insert(m_seq.end(), elements.cbegin(), elements.cend());
+        return;
+    }
+    m_seq.insert(m_seq.end(), other->m_seq.cbegin(), other->m_seq.cend());
+}
+
+/**
+ * Grow the vector so that it can hold at least the specified number of elements without
+ * reallocating.
+ */
+void
+VectorRef::reserve(int capacity)
+{
+    if (capacity > 0) {
+        m_seq.reserve(capacity);
+    }
+}
+
 lyric_runtime::DataCell
 VectorRef::update(int index, lyric_runtime::DataCell value)
 {
@@ -24,6 +24,8 @@ public:
 
     void insert(int index, lyric_runtime::DataCell value);
     void append(const lyric_runtime::DataCell &value);
+    void extend(const VectorRef *other);
+    void reserve(int capacity);
     lyric_runtime::DataCell update(int index, lyric_runtime::DataCell value);
     lyric_runtime::DataCell remove(int index);
     absl::InlinedVector<lyric_runtime::DataCell,16>::iterator begin();
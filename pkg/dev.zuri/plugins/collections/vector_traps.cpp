@@ -1,5 +1,7 @@
 /* SPDX-License-Identifier: BSD-3-Clause */
 
+#include <limits>
+
 #include <tempo_utils/log_stream.h>
 
 #include <lyric_runtime/interpreter_state.h>
@@ -31,6 +33,13 @@ vector_ctor(
     auto &frame = currentCoro->currentCallOrThrow();
     auto receiver = frame.getReceiver();
     TU_ASSERT(receiver.type == lyric_runtime::DataCellType::REF);
+    auto *instance = static_cast<VectorRef *>(receiver.data.ref);
+
+    // append the initial elements here rather than once per element from the constructor
+    instance->reserve(frame.numRest());
+    for (int i = 0; i < frame.numRest(); i++) {
+        instance->append(frame.getRest(i));
+    }
     return {};
 }
 
@@ -159,6 +168,52 @@ vector_remove(
     return {};
 }
 
+tempo_utils::Status
+vector_extend(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable)
+{
+    auto *currentCoro = state->currentCoro();
+
+    auto &frame = currentCoro->currentCallOrThrow();
+
+    TU_ASSERT(frame.numArguments() == 1);
+    const auto &argument = frame.getArgument(0);
+    TU_ASSERT(argument.type == lyric_runtime::DataCellType::REF);
+    auto *other = static_cast<VectorRef *>(argument.data.ref);
+
+    auto receiver = frame.getReceiver();
+    TU_ASSERT(receiver.type == lyric_runtime::DataCellType::REF);
+    auto *instance = static_cast<VectorRef *>(receiver.data.ref);
+    instance->extend(other);
+    return {};
+}
+
+tempo_utils::Status
+vector_reserve(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable)
+{
+    auto *currentCoro = state->currentCoro();
+
+    auto &frame = currentCoro->currentCallOrThrow();
+
+    TU_ASSERT(frame.numArguments() == 1);
+    const auto &capacity = frame.getArgument(0);
+    TU_ASSERT(capacity.type == lyric_runtime::DataCellType::I64);
+
+    auto receiver = frame.getReceiver();
+    TU_ASSERT(receiver.type == lyric_runtime::DataCellType::REF);
+    auto *instance = static_cast<VectorRef *>(receiver.data.ref);
+    // capacity is only a hint, so a capacity which is out of range is ignored
+    if (0 < capacity.data.i64 && capacity.data.i64 <= std::numeric_limits<int>::max()) {
+        instance->reserve(static_cast<int>(capacity.data.i64));
+    }
+    return {};
+}
+
 tempo_utils::Status
 vector_clear(
     lyric_runtime::BytecodeInterpreter *interp,
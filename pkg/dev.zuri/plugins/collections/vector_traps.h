@@ -46,6 +46,16 @@ tempo_utils::Status vector_remove(
     lyric_runtime::InterpreterState *state,
     const lyric_runtime::VirtualTable *vtable);
 
+tempo_utils::Status vector_extend(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable);
+
+tempo_utils::Status vector_reserve(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable);
+
 tempo_utils::Status vector_clear(
     lyric_runtime::BytecodeInterpreter *interp,
     lyric_runtime::InterpreterState *state,
@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+
+#ifndef ZURI_STD_PLUGIN_VTABLES_H
+#define ZURI_STD_PLUGIN_VTABLES_H
+
+#include <array>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include <lyric_runtime/interpreter_state.h>
+#include <tempo_utils/log_stream.h>
+
+/**
+ * Cache of the virtual tables for the classes which a plugin allocates instances of from native
+ * code. ClassEnum enumerates the classes and must end with NUM_CLASSES. The virtual tables are
+ * keyed by the segment of the module which declares the classes, and the entry for a segment is
+ * removed when the plugin is unloaded from it so a later segment at the same address is resolved
+ * again.
+ */
+template<typename ClassEnum>
+class PluginVirtualTables {
+public:
+    static constexpr int kNumClasses = static_cast<int>(ClassEnum::NUM_CLASSES);
+
+    explicit PluginVirtualTables(const std::array<const char *,kNumClasses> &classNames)
+        : m_classNames(classNames)
+    {
+    }
+
+    /**
+     * Returns the virtual table for the specified class declared in the module of the current
+     * segment. The virtual table is resolved the first time it is requested for the segment, and
+     * subsequent calls return the cached virtual table without looking up the class symbol again.
+     *
+     * @param state The interpreter state.
+     * @param pluginClass The class.
+     * @return The virtual table, or nullptr if the virtual table could not be resolved.
+     */
+    const lyric_runtime::VirtualTable *
+    resolve(lyric_runtime::InterpreterState *state, ClassEnum pluginClass)
+    {
+        auto *segment = state->currentCoro()->peekSP();
+        auto index = static_cast<int>(pluginClass);
+
+        {
+            absl::ReaderMutexLock locker(&m_lock);
+            auto entry = m_vtables.find(segment);
+            if (entry != m_vtables.cend() && entry->second[index] != nullptr)
+                return entry->second[index];
+        }
+
+        const auto *vtable = resolveClass(state, segment, m_classNames[index]);
+        if (vtable == nullptr)
+            return nullptr;
+
+        absl::MutexLock locker(&m_lock);
+        auto &vtables = m_vtables[segment];
+        vtables[index] = vtable;
+        return vtable;
+    }
+
+    /**
+     * Drop the cached virtual tables for the specified segment.
+     */
+    void
+    release(const lyric_runtime::BytecodeSegment *segment)
+    {
+        absl::MutexLock locker(&m_lock);
+        m_vtables.erase(segment);
+    }
+
+private:
+    using VirtualTables = std::array<const lyric_runtime::VirtualTable *,kNumClasses>;
+
+    const std::array<const char *,kNumClasses> m_classNames;
+    absl::Mutex m_lock;
+    absl::flat_hash_map<const lyric_runtime::BytecodeSegment *,VirtualTables> m_vtables
+        ABSL_GUARDED_BY(m_lock);
+
+    static const lyric_runtime::VirtualTable *
+    resolveClass(
+        lyric_runtime::InterpreterState *state,
+        lyric_runtime::BytecodeSegment *segment,
+        const char *className)
+    {
+        auto *segmentManager = state->segmentManager();
+
+        auto object = segment->getObject();
+        auto symbol = object.findSymbol(lyric_common::SymbolPath({className}));
+        TU_ASSERT (symbol.isValid());
+
+        lyric_runtime::InterpreterStatus status;
+        auto descriptor = segmentManager->resolveDescriptor(segment,
+            symbol.getLinkageSection(), symbol.getLinkageIndex(), status);
+        TU_ASSERT (descriptor.type == lyric_runtime::DataCellType::CLASS);
+        return segmentManager->resolveClassVirtualTable(descriptor, status);
+    }
+};
+
+#endif // ZURI_STD_PLUGIN_VTABLES_H
@@ -6,9 +6,11 @@
 #include "native_system.h"
 #include "port_ref.h"
 #include "system_traps.h"
+#include "work_batch_ref.h"
 #include "work_queue_ref.h"
+#include "system_vtables.h"
 
-std::array<lyric_runtime::NativeTrap,16> kStdSystemTraps = {{
+std::array<lyric_runtime::NativeTrap,26> kStdSystemTraps = {{
     {future_alloc, "STD_SYSTEM_FUTURE_ALLOC", 0},
     {future_ctor, "STD_SYSTEM_FUTURE_CTOR", 0},
     {future_complete, "STD_SYSTEM_FUTURE_COMPLETE", 0},
@@ -18,8 +20,18 @@ std::array<lyric_runtime::NativeTrap,16> kStdSystemTraps = {{
     {port_receive, "STD_SYSTEM_PORT_RECEIVE", 0},
     {port_send, "STD_SYSTEM_PORT_SEND", 0},
     {work_queue_alloc, "STD_SYSTEM_WORK_QUEUE_ALLOC", 0},
+    {work_queue_ctor, "STD_SYSTEM_WORK_QUEUE_CTOR", 0},
     {work_queue_pop, "STD_SYSTEM_WORK_QUEUE_POP", 0},
     {work_queue_push, "STD_SYSTEM_WORK_QUEUE_PUSH", 0},
+    {work_queue_push_async, "STD_SYSTEM_WORK_QUEUE_PUSH_ASYNC", 0},
+    {work_queue_pop_many, "STD_SYSTEM_WORK_QUEUE_POP_MANY", 0},
+    {work_batch_alloc, "STD_SYSTEM_WORK_BATCH_ALLOC", 0},
+    {work_batch_size, "STD_SYSTEM_WORK_BATCH_SIZE", 0},
+    {work_batch_at, "STD_SYSTEM_WORK_BATCH_AT", 0},
+    {work_batch_iterate, "STD_SYSTEM_WORK_BATCH_ITERABLE_ITERATE", 0},
+    {work_batch_iterator_alloc, "STD_SYSTEM_WORK_BATCH_ITERATOR_ALLOC", 0},
+    {work_batch_iterator_valid, "STD_SYSTEM_WORK_BATCH_ITERATOR_VALID", 0},
+    {work_batch_iterator_next, "STD_SYSTEM_WORK_BATCH_ITERATOR_NEXT", 0},
     {std_system_acquire, "STD_SYSTEM_ACQUIRE", 0},
     {std_system_await, "STD_SYSTEM_AWAIT", 0},
     {std_system_get_result, "STD_SYSTEM_GET_RESULT", 0},
@@ -54,6 +66,7 @@ NativeStdSystem::load(lyric_runtime::BytecodeSegment *segment) const
 void
 NativeStdSystem::unload(lyric_runtime::BytecodeSegment *segment) const
 {
+    release_system_vtables(segment);
 }
 
 uint32_t
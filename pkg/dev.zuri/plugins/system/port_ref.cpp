@@ -10,6 +10,7 @@
 
 #include "future_ref.h"
 #include "port_ref.h"
+#include "system_vtables.h"
 
 #include <tempo_utils/memory_bytes.h>
 
@@ -197,7 +198,6 @@ port_receive(
     const lyric_runtime::VirtualTable *unused)
 {
     auto *currentCoro = state->currentCoro();
-    auto *segmentManager = state->segmentManager();
     auto *scheduler = state->systemScheduler();
 
     auto &frame = currentCoro->currentCallOrThrow();
@@ -209,15 +209,7 @@ port_receive(
     auto *instance = static_cast<PortRef *>(receiver.data.ref);
 
     //
-    auto *segment = currentCoro->peekSP();
-    auto object = segment->getObject();
-    auto symbol = object.findSymbol(lyric_common::SymbolPath({"Future"}));
-    TU_ASSERT (symbol.isValid());
-    lyric_runtime::InterpreterStatus status;
-    auto descriptor = segmentManager->resolveDescriptor(segment,
-        symbol.getLinkageSection(), symbol.getLinkageIndex(), status);
-    TU_ASSERT (descriptor.type == lyric_runtime::DataCellType::CLASS);
-    const auto *vtable = segmentManager->resolveClassVirtualTable(descriptor, status);
+    const auto *vtable = resolve_system_vtable(state, SystemClass::Future);
     TU_ASSERT(vtable != nullptr);
 
     // create a new future to wait for receive result
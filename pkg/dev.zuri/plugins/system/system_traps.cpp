@@ -9,6 +9,7 @@
 #include "future_ref.h"
 #include "port_ref.h"
 #include "system_traps.h"
+#include "system_vtables.h"
 
 tempo_utils::Status
 std_system_acquire(
@@ -37,18 +38,9 @@ std_system_acquire(
 
     //
     auto *multiplexer = state->portMultiplexer();
-    auto *segmentManager = state->segmentManager();
     auto *heapManager = state->heapManager();
 
-    auto *segment = currentCoro->peekSP();
-    auto object = segment->getObject();
-    auto symbol = object.findSymbol(lyric_common::SymbolPath({"Port"}));
-    TU_ASSERT (symbol.isValid());
-    lyric_runtime::InterpreterStatus status;
-    auto descriptor = segmentManager->resolveDescriptor(segment,
-        symbol.getLinkageSection(), symbol.getLinkageIndex(), status);
-    TU_ASSERT (descriptor.type == lyric_runtime::DataCellType::CLASS);
-    const auto *vtable = segmentManager->resolveClassVirtualTable(descriptor, status);
+    const auto *vtable = resolve_system_vtable(state, SystemClass::Port);
     TU_ASSERT(vtable != nullptr);
 
     // create a new port and return it to caller
@@ -137,19 +129,9 @@ std_system_sleep(
     TU_ASSERT(cell.type == lyric_runtime::DataCellType::I64);
     uint64_t timeout = cell.data.i64 > 0? cell.data.i64 : 0;
 
-    auto *segmentManager = state->segmentManager();
     auto *heapManager = state->heapManager();
 
-    auto *segment = currentCoro->peekSP();
-    auto object = segment->getObject();
-    auto symbol = object.findSymbol(lyric_common::SymbolPath({"Future"}));
-    TU_ASSERT (symbol.isValid());
-
-    lyric_runtime::InterpreterStatus status;
-    auto descriptor = segmentManager->resolveDescriptor(segment,
-        symbol.getLinkageSection(), symbol.getLinkageIndex(), status);
-    TU_ASSERT (descriptor.type == lyric_runtime::DataCellType::CLASS);
-    const auto *vtable = segmentManager->resolveClassVirtualTable(descriptor, status);
+    const auto *vtable = resolve_system_vtable(state, SystemClass::Future);
     TU_ASSERT(vtable != nullptr);
 
     // create a new future to wait for sleep result
@@ -204,19 +186,9 @@ std_system_spawn(
     TU_ASSERT(cell.type == lyric_runtime::DataCellType::REF);
     auto *closure = cell.data.ref;
 
-    auto *segmentManager = state->segmentManager();
     auto *heapManager = state->heapManager();
 
-    auto *segment = currentCoro->peekSP();
-    auto object = segment->getObject();
-    auto symbol = object.findSymbol(lyric_common::SymbolPath({"Future"}));
-    TU_ASSERT (symbol.isValid());
-
-    lyric_runtime::InterpreterStatus status;
-    auto descriptor = segmentManager->resolveDescriptor(segment,
-        symbol.getLinkageSection(), symbol.getLinkageIndex(), status);
-    TU_ASSERT (descriptor.type == lyric_runtime::DataCellType::CLASS);
-    const auto *vtable = segmentManager->resolveClassVirtualTable(descriptor, status);
+    const auto *vtable = resolve_system_vtable(state, SystemClass::Future);
     TU_ASSERT(vtable != nullptr);
 
     // create a new future to wait for spawn result
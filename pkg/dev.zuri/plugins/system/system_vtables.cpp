@@ -0,0 +1,32 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+
+#include "../plugin_vtables.h"
+#include "system_vtables.h"
+
+static PluginVirtualTables<SystemClass> systemVirtualTables({{
+    "Future",
+    "Port",
+    "WorkBatch",
+}});
+
+/**
+ * Returns the virtual table for the specified class declared in the system module.
+ *
+ * @param state The interpreter state.
+ * @param systemClass The class.
+ * @return The virtual table, or nullptr if the virtual table could not be resolved.
+ */
+const lyric_runtime::VirtualTable *
+resolve_system_vtable(lyric_runtime::InterpreterState *state, SystemClass systemClass)
+{
+    return systemVirtualTables.resolve(state, systemClass);
+}
+
+/**
+ * Drop the cached virtual tables for the specified segment.
+ */
+void
+release_system_vtables(const lyric_runtime::BytecodeSegment *segment)
+{
+    systemVirtualTables.release(segment);
+}
@@ -0,0 +1,24 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+
+#ifndef ZURI_STD_SYSTEM_SYSTEM_VTABLES_H
+#define ZURI_STD_SYSTEM_SYSTEM_VTABLES_H
+
+#include <lyric_runtime/interpreter_state.h>
+
+/**
+ * The classes which the system plugin allocates instances of from native code.
+ */
+enum class SystemClass {
+    Future,
+    Port,
+    WorkBatch,
+    NUM_CLASSES,
+};
+
+const lyric_runtime::VirtualTable *resolve_system_vtable(
+    lyric_runtime::InterpreterState *state,
+    SystemClass systemClass);
+
+void release_system_vtables(const lyric_runtime::BytecodeSegment *segment);
+
+#endif // ZURI_STD_SYSTEM_SYSTEM_VTABLES_H
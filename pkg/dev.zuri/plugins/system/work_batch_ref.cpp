@@ -0,0 +1,278 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+
+#include <absl/strings/substitute.h>
+
+#include <tempo_utils/log_stream.h>
+
+#include "work_batch_ref.h"
+
+WorkBatchRef::WorkBatchRef(const lyric_runtime::VirtualTable *vtable)
+    : BaseRef(vtable)
+{
+}
+
+WorkBatchRef::~WorkBatchRef()
+{
+    TU_LOG_INFO << "free" << WorkBatchRef::toString();
+}
+
+std::string
+WorkBatchRef::toString() const
+{
+    return absl::Substitute("<$0: WorkBatch contains $1 elements>", this, m_elements.size());
+}
+
+lyric_runtime::DataCell
+WorkBatchRef::at(int index) const
+{
+    return m_elements[index];
+}
+
+int
+WorkBatchRef::size() const
+{
+    return m_elements.size();
+}
+
+void
+WorkBatchRef::reserve(int capacity)
+{
+    m_elements.reserve(capacity);
+}
+
+void
+WorkBatchRef::append(const lyric_runtime::DataCell &element)
+{
+    m_elements.push_back(element);
+}
+
+std::vector<lyric_runtime::DataCell>::const_iterator
+WorkBatchRef::begin() const
+{
+    return m_elements.cbegin();
+}
+
+std::vector<lyric_runtime::DataCell>::const_iterator
+WorkBatchRef::end() const
+{
+    return m_elements.cend();
+}
+
+void
+WorkBatchRef::setMembersReachable()
+{
+    for (auto &cell : m_elements) {
+        if (cell.type == lyric_runtime::DataCellType::REF) {
+            TU_ASSERT (cell.data.ref != nullptr);
+            cell.data.ref->setReachable();
+        }
+    }
+}
+
+void
+WorkBatchRef::clearMembersReachable()
+{
+    for (auto &cell : m_elements) {
+        if (cell.type == lyric_runtime::DataCellType::REF) {
+            TU_ASSERT (cell.data.ref != nullptr);
+            cell.data.ref->clearReachable();
+        }
+    }
+}
+
+WorkBatchIterator::WorkBatchIterator(const lyric_runtime::VirtualTable *vtable)
+    : BaseRef(vtable),
+      m_batch(nullptr)
+{
+}
+
+WorkBatchIterator::WorkBatchIterator(
+    const lyric_runtime::VirtualTable *vtable,
+    WorkBatchRef *batch)
+    : BaseRef(vtable),
+      m_batch(batch)
+{
+    TU_ASSERT (m_batch != nullptr);
+    m_iter = batch->begin();
+}
+
+std::string
+WorkBatchIterator::toString() const
+{
+    return absl::Substitute("<$0: WorkBatchIterator>", this);
+}
+
+bool
+WorkBatchIterator::iteratorValid()
+{
+    // the batch is never modified after it is filled, so the iterator cannot be invalidated
+    return m_batch && m_iter != m_batch->end();
+}
+
+bool
+WorkBatchIterator::iteratorNext(lyric_runtime::DataCell &next)
+{
+    if (!iteratorValid())
+        return false;
+    next = *m_iter++;
+    return true;
+}
+
+void
+WorkBatchIterator::setMembersReachable()
+{
+    if (m_batch) {
+        m_batch->setReachable();
+    }
+}
+
+void
+WorkBatchIterator::clearMembersReachable()
+{
+    if (m_batch) {
+        m_batch->clearReachable();
+    }
+}
+
+tempo_utils::Status
+work_batch_alloc(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable)
+{
+    TU_ASSERT(vtable != nullptr);
+    auto *currentCoro = state->currentCoro();
+    auto ref = state->heapManager()->allocateRef<WorkBatchRef>(vtable);
+    currentCoro->pushData(ref);
+    return {};
+}
+
+tempo_utils::Status
+work_batch_size(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable)
+{
+    auto *currentCoro = state->currentCoro();
+
+    auto &frame = currentCoro->currentCallOrThrow();
+
+    TU_ASSERT(frame.numArguments() == 0);
+
+    auto receiver = frame.getReceiver();
+    TU_ASSERT(receiver.type == lyric_runtime::DataCellType::REF);
+    auto *instance = static_cast<WorkBatchRef *>(receiver.data.ref);
+    currentCoro->pushData(lyric_runtime::DataCell(static_cast<int64_t>(instance->size())));
+    return {};
+}
+
+tempo_utils::Status
+work_batch_at(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable)
+{
+    auto *currentCoro = state->currentCoro();
+
+    auto &frame = currentCoro->currentCallOrThrow();
+
+    TU_ASSERT(frame.numArguments() == 1);
+    const auto &idx = frame.getArgument(0);
+    TU_ASSERT(idx.type == lyric_runtime::DataCellType::I64);
+
+    auto receiver = frame.getReceiver();
+    TU_ASSERT(receiver.type == lyric_runtime::DataCellType::REF);
+    auto *instance = static_cast<WorkBatchRef *>(receiver.data.ref);
+    if (idx.data.i64 < 0 || instance->size() <= idx.data.i64)
+        return lyric_runtime::InterpreterStatus::forCondition(
+            lyric_runtime::InterpreterCondition::kRuntimeInvariant,
+            "index {} is out of range for WorkBatch of size {}", idx.data.i64, instance->size());
+    currentCoro->pushData(instance->at(idx.data.i64));
+    return {};
+}
+
+tempo_utils::Status
+work_batch_iterate(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *unused)
+{
+    auto *currentCoro = state->currentCoro();
+
+    auto &frame = currentCoro->currentCallOrThrow();
+
+    lyric_runtime::DataCell cell;
+    TU_RETURN_IF_NOT_OK (currentCoro->popData(cell));
+    TU_ASSERT(cell.type == lyric_runtime::DataCellType::CLASS);
+
+    auto receiver = frame.getReceiver();
+    TU_ASSERT(receiver.type == lyric_runtime::DataCellType::REF);
+    auto *instance = static_cast<WorkBatchRef *>(receiver.data.ref);
+
+    lyric_runtime::InterpreterStatus status;
+    const auto *vtable = state->segmentManager()->resolveClassVirtualTable(cell, status);
+    TU_ASSERT(vtable != nullptr);
+
+    auto ref = state->heapManager()->allocateRef<WorkBatchIterator>(vtable, instance);
+    currentCoro->pushData(ref);
+
+    return {};
+}
+
+tempo_utils::Status
+work_batch_iterator_alloc(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable)
+{
+    TU_ASSERT(vtable != nullptr);
+    auto *currentCoro = state->currentCoro();
+    auto ref = state->heapManager()->allocateRef<WorkBatchIterator>(vtable);
+    currentCoro->pushData(ref);
+    return {};
+}
+
+tempo_utils::Status
+work_batch_iterator_valid(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable)
+{
+    auto *currentCoro = state->currentCoro();
+
+    auto &frame = currentCoro->currentCallOrThrow();
+
+    TU_ASSERT(frame.numArguments() == 0);
+
+    auto receiver = frame.getReceiver();
+    TU_ASSERT(receiver.type == lyric_runtime::DataCellType::REF);
+    auto *instance = static_cast<lyric_runtime::AbstractRef *>(receiver.data.ref);
+    currentCoro->pushData(lyric_runtime::DataCell(instance->iteratorValid()));
+
+    return {};
+}
+
+tempo_utils::Status
+work_batch_iterator_next(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable)
+{
+    auto *currentCoro = state->currentCoro();
+
+    auto &frame = currentCoro->currentCallOrThrow();
+
+    TU_ASSERT(frame.numArguments() == 0);
+
+    auto receiver = frame.getReceiver();
+    TU_ASSERT(receiver.type == lyric_runtime::DataCellType::REF);
+    auto *instance = static_cast<lyric_runtime::AbstractRef *>(receiver.data.ref);
+
+    lyric_runtime::DataCell next;
+    if (!instance->iteratorNext(next)) {
+        next = lyric_runtime::DataCell();
+    }
+    currentCoro->pushData(next);
+
+    return {};
+}
@@ -0,0 +1,97 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+
+#ifndef ZURI_STD_SYSTEM_WORK_BATCH_REF_H
+#define ZURI_STD_SYSTEM_WORK_BATCH_REF_H
+
+#include <vector>
+
+#include <lyric_runtime/base_ref.h>
+#include <lyric_runtime/bytecode_interpreter.h>
+#include <lyric_runtime/interpreter_state.h>
+
+/**
+ * The elements drained from a WorkQueue by a single PopMany call. The batch is immutable once it
+ * has been filled.
+ */
+class WorkBatchRef : public lyric_runtime::BaseRef {
+
+public:
+    explicit WorkBatchRef(const lyric_runtime::VirtualTable *vtable);
+    ~WorkBatchRef() override;
+
+    std::string toString() const override;
+
+    lyric_runtime::DataCell at(int index) const;
+    int size() const;
+
+    void reserve(int capacity);
+    void append(const lyric_runtime::DataCell &element);
+    std::vector<lyric_runtime::DataCell>::const_iterator begin() const;
+    std::vector<lyric_runtime::DataCell>::const_iterator end() const;
+
+protected:
+    void setMembersReachable() override;
+    void clearMembersReachable() override;
+
+private:
+    std::vector<lyric_runtime::DataCell> m_elements;
+};
+
+class WorkBatchIterator : public lyric_runtime::BaseRef {
+
+public:
+    explicit WorkBatchIterator(const lyric_runtime::VirtualTable *vtable);
+    WorkBatchIterator(
+        const lyric_runtime::VirtualTable *vtable,
+        WorkBatchRef *batch);
+
+    std::string toString() const override;
+
+    bool iteratorValid() override;
+    bool iteratorNext(lyric_runtime::DataCell &next) override;
+
+protected:
+    void setMembersReachable() override;
+    void clearMembersReachable() override;
+
+private:
+    std::vector<lyric_runtime::DataCell>::const_iterator m_iter;
+    WorkBatchRef *m_batch;
+};
+
+tempo_utils::Status work_batch_alloc(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable);
+
+tempo_utils::Status work_batch_size(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable);
+
+tempo_utils::Status work_batch_at(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable);
+
+tempo_utils::Status work_batch_iterate(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable);
+
+tempo_utils::Status work_batch_iterator_alloc(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable);
+
+tempo_utils::Status work_batch_iterator_valid(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable);
+
+tempo_utils::Status work_batch_iterator_next(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable);
+
+#endif // ZURI_STD_SYSTEM_WORK_BATCH_REF_H
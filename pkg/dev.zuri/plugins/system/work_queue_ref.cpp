@@ -1,5 +1,8 @@
 /* SPDX-License-Identifier: BSD-3-Clause */
 
+#include <algorithm>
+#include <limits>
+
 #include <absl/strings/substitute.h>
 
 #include <lyric_object/bytecode_iterator.h>
@@ -8,10 +11,13 @@
 #include <tempo_utils/log_stream.h>
 
 #include "future_ref.h"
+#include "work_batch_ref.h"
 #include "work_queue_ref.h"
+#include "system_vtables.h"
 
 WorkQueueRef::WorkQueueRef(const lyric_runtime::VirtualTable *vtable)
-    : BaseRef(vtable)
+    : BaseRef(vtable),
+      m_capacity(0)
 {
 }
 
@@ -26,18 +32,48 @@ WorkQueueRef::toString() const
     return absl::Substitute("<$0: WorkQueue>", this);
 }
 
+/**
+ * Set the maximum number of elements the queue holds. A capacity of zero or less means the queue
+ * is unbounded.
+ *
+ * @param capacity The queue capacity.
+ */
+void
+WorkQueueRef::initialize(int capacity)
+{
+    m_capacity = capacity > 0 ? capacity : 0;
+}
+
+int
+WorkQueueRef::capacity() const
+{
+    return m_capacity;
+}
+
+bool
+WorkQueueRef::isFull() const
+{
+    return m_capacity > 0 && m_elements.size() >= m_capacity;
+}
+
+/**
+ * Push the element onto the queue. If a pop is waiting then the element is handed directly to
+ * the waiter. Returns false without pushing the element if the queue is bounded and full.
+ */
 bool
 WorkQueueRef::push(const lyric_runtime::DataCell &element)
 {
     // if there are no registered futures then push the element and return
     if (m_waiting.empty()) {
+        if (isFull())
+            return false;
         m_elements.push_back(element);
         return true;
     }
 
     // otherwise pop the topmost future
     auto waiting = m_waiting.front();
-    m_waiting.erase(m_waiting.begin());
+    m_waiting.pop_front();
 
     // set the result of the future and signal the scheduler to resume task
     waiting.first->complete(element);
@@ -52,12 +88,31 @@ WorkQueueRef::containsAvailableElement() const
     return m_waiting.empty() && !m_elements.empty();
 }
 
+int
+WorkQueueRef::numAvailableElements() const
+{
+    return m_waiting.empty()? m_elements.size() : 0;
+}
+
+/**
+ * Take the element at the front of the queue. If a push is blocked waiting for capacity then the
+ * blocked element takes the freed slot and the blocked push is completed.
+ */
 lyric_runtime::DataCell
 WorkQueueRef::takeAvailableElement()
 {
     TU_ASSERT (!m_elements.empty());
     auto next = m_elements.front();
-    m_elements.erase(m_elements.begin());
+    m_elements.pop_front();
+
+    if (!m_blocked.empty()) {
+        auto blocked = std::move(m_blocked.front());
+        m_blocked.pop_front();
+        m_elements.push_back(blocked.element);
+        blocked.promise->complete(lyric_runtime::DataCell(true));
+        uv_async_send(blocked.async);
+    }
+
     return next;
 }
 
@@ -68,6 +123,20 @@ WorkQueueRef::waitForPush(std::shared_ptr<lyric_runtime::Promise> promise, uv_as
     return true;
 }
 
+/**
+ * Block the push of the specified element until the queue has capacity for it. The promise is
+ * completed once the element has been pushed.
+ */
+bool
+WorkQueueRef::waitForCapacity(
+    const lyric_runtime::DataCell &element,
+    std::shared_ptr<lyric_runtime::Promise> promise,
+    uv_async_t *async)
+{
+    m_blocked.push_back({element, promise, async});
+    return true;
+}
+
 void
 WorkQueueRef::setMembersReachable()
 {
@@ -76,6 +145,11 @@ WorkQueueRef::setMembersReachable()
             element.data.ref->setReachable();
         }
     }
+    for (auto &blocked : m_blocked) {
+        if (blocked.element.type == lyric_runtime::DataCellType::REF) {
+            blocked.element.data.ref->setReachable();
+        }
+    }
 //    for (auto &waiting : m_waiting) {
 //        waiting.first->setReachable();
 //    }
@@ -89,6 +163,11 @@ WorkQueueRef::clearMembersReachable()
             element.data.ref->clearReachable();
         }
     }
+    for (auto &blocked : m_blocked) {
+        if (blocked.element.type == lyric_runtime::DataCellType::REF) {
+            blocked.element.data.ref->clearReachable();
+        }
+    }
 //    for (auto &waiting : m_waiting) {
 //        waiting.first->clearReachable();
 //    }
@@ -107,6 +186,36 @@ work_queue_alloc(
     return {};
 }
 
+tempo_utils::Status
+work_queue_ctor(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable)
+{
+    auto *currentCoro = state->currentCoro();
+
+    auto &frame = currentCoro->currentCallOrThrow();
+
+    TU_ASSERT(frame.numArguments() == 1);
+    const auto &arg0 = frame.getArgument(0);
+    TU_ASSERT(arg0.type == lyric_runtime::DataCellType::I64);
+
+    auto receiver = frame.getReceiver();
+    TU_ASSERT(receiver.type == lyric_runtime::DataCellType::REF);
+    auto *instance = static_cast<WorkQueueRef *>(receiver.data.ref);
+
+    // a capacity of zero means the queue is unbounded
+    auto capacity = arg0.data.i64;
+    if (capacity < 0 || capacity > std::numeric_limits<int>::max())
+        return lyric_runtime::InterpreterStatus::forCondition(
+            lyric_runtime::InterpreterCondition::kRuntimeInvariant,
+            "invalid WorkQueue capacity {}; must be between 0 and {}",
+            capacity, std::numeric_limits<int>::max());
+    instance->initialize(static_cast<int>(capacity));
+
+    return {};
+}
+
 tempo_utils::Status
 work_queue_push(
     lyric_runtime::BytecodeInterpreter *interp,
@@ -138,50 +247,93 @@ on_async_accept(
     // do nothing
 }
 
-tempo_utils::Status
-work_queue_pop(
-    lyric_runtime::BytecodeInterpreter *interp,
+/**
+ * Allocate a new Future, push it onto the top of the stack, and return a promise attached to the
+ * future along with an async handle which signals the scheduler when the promise is completed.
+ */
+static tempo_utils::Status
+push_future(
     lyric_runtime::InterpreterState *state,
-    const lyric_runtime::VirtualTable *unused)
+    std::shared_ptr<lyric_runtime::Promise> &promise,
+    uv_async_t **async)
 {
     auto *currentCoro = state->currentCoro();
-    auto *segmentManager = state->segmentManager();
     auto *scheduler = state->systemScheduler();
 
-    auto &frame = currentCoro->currentCallOrThrow();
-    TU_ASSERT(frame.numArguments() == 0);
-
-    auto receiver = frame.getReceiver();
-    TU_ASSERT(receiver.type == lyric_runtime::DataCellType::REF);
-    auto *instance = static_cast<WorkQueueRef *>(receiver.data.ref);
-
     // resolve the virtual table for Future
-    auto *segment = currentCoro->peekSP();
-    auto object = segment->getObject();
-    auto symbol = object.findSymbol(lyric_common::SymbolPath({"Future"}));
-    TU_ASSERT (symbol.isValid());
-    lyric_runtime::InterpreterStatus status;
-    auto descriptor = segmentManager->resolveDescriptor(segment,
-        symbol.getLinkageSection(), symbol.getLinkageIndex(), status);
-    TU_ASSERT (descriptor.type == lyric_runtime::DataCellType::CLASS);
-    const auto *vtable = segmentManager->resolveClassVirtualTable(descriptor, status);
+    const auto *vtable = resolve_system_vtable(state, SystemClass::Future);
     TU_ASSERT(vtable != nullptr);
 
-    // create a new future to wait for receive result and push it onto the top of the stack
+    // create a new future and push it onto the top of the stack
     auto ref = state->heapManager()->allocateRef<FutureRef>(vtable);
     currentCoro->pushData(ref);
     auto *fut = static_cast<FutureRef *>(ref.data.ref);
 
     //
-    auto promise = lyric_runtime::Promise::create(on_async_accept);
+    promise = lyric_runtime::Promise::create(on_async_accept);
 
     // register an async waiter
-    uv_async_t *async = nullptr;
-    scheduler->registerAsync(&async, promise);
+    scheduler->registerAsync(async, promise);
 
     // attach the promise to the future
     fut->prepareFuture(promise);
 
+    return {};
+}
+
+tempo_utils::Status
+work_queue_push_async(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *unused)
+{
+    auto *currentCoro = state->currentCoro();
+
+    auto &frame = currentCoro->currentCallOrThrow();
+    TU_ASSERT(frame.numArguments() == 1);
+    const auto &arg0 = frame.getArgument(0);
+
+    auto receiver = frame.getReceiver();
+    TU_ASSERT(receiver.type == lyric_runtime::DataCellType::REF);
+    auto *instance = static_cast<WorkQueueRef *>(receiver.data.ref);
+
+    // create a new future to wait for push result and push it onto the top of the stack
+    std::shared_ptr<lyric_runtime::Promise> promise;
+    uv_async_t *async = nullptr;
+    TU_RETURN_IF_NOT_OK (push_future(state, promise, &async));
+
+    // special case: if the queue has capacity then push the element and set the future immediately
+    if (instance->push(arg0)) {
+        promise->complete(lyric_runtime::DataCell(true));
+        return {};
+    }
+
+    // otherwise block the push until a pop frees capacity
+    instance->waitForCapacity(arg0, promise, async);
+
+    return {};
+}
+
+tempo_utils::Status
+work_queue_pop(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *unused)
+{
+    auto *currentCoro = state->currentCoro();
+
+    auto &frame = currentCoro->currentCallOrThrow();
+    TU_ASSERT(frame.numArguments() == 0);
+
+    auto receiver = frame.getReceiver();
+    TU_ASSERT(receiver.type == lyric_runtime::DataCellType::REF);
+    auto *instance = static_cast<WorkQueueRef *>(receiver.data.ref);
+
+    // create a new future to wait for receive result and push it onto the top of the stack
+    std::shared_ptr<lyric_runtime::Promise> promise;
+    uv_async_t *async = nullptr;
+    TU_RETURN_IF_NOT_OK (push_future(state, promise, &async));
+
     // special case: if the queue has an available element then take it and set the future immediately
     if (instance->containsAvailableElement()) {
         promise->complete(instance->takeAvailableElement());
@@ -193,3 +345,42 @@ work_queue_pop(
 
     return {};
 }
+
+/**
+ * Pop up to the specified maximum number of elements which are available without waiting into a
+ * new WorkBatch, which is pushed onto the stack as the result.
+ */
+tempo_utils::Status
+work_queue_pop_many(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable)
+{
+    auto *currentCoro = state->currentCoro();
+
+    auto &frame = currentCoro->currentCallOrThrow();
+
+    TU_ASSERT(frame.numArguments() == 1);
+    const auto &arg0 = frame.getArgument(0);
+    TU_ASSERT(arg0.type == lyric_runtime::DataCellType::I64);
+
+    auto receiver = frame.getReceiver();
+    TU_ASSERT(receiver.type == lyric_runtime::DataCellType::REF);
+    auto *instance = static_cast<WorkQueueRef *>(receiver.data.ref);
+
+    // create a new batch and push it onto the top of the stack
+    const auto *batchVtable = resolve_system_vtable(state, SystemClass::WorkBatch);
+    TU_ASSERT(batchVtable != nullptr);
+    auto ref = state->heapManager()->allocateRef<WorkBatchRef>(batchVtable);
+    currentCoro->pushData(ref);
+    auto *batch = static_cast<WorkBatchRef *>(ref.data.ref);
+
+    auto numElements = static_cast<int>(std::max<int64_t>(0,
+        std::min<int64_t>(instance->numAvailableElements(), arg0.data.i64)));
+    batch->reserve(numElements);
+    for (int i = 0; i < numElements; i++) {
+        batch->append(instance->takeAvailableElement());
+    }
+
+    return {};
+}
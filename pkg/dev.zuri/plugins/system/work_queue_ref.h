@@ -3,6 +3,8 @@
 #ifndef ZURI_STD_SYSTEM_WORK_QUEUE_REF_H
 #define ZURI_STD_SYSTEM_WORK_QUEUE_REF_H
 
+#include <deque>
+
 #include <lyric_runtime/base_ref.h>
 #include <lyric_runtime/bytecode_interpreter.h>
 #include <lyric_runtime/gc_heap.h>
@@ -18,12 +20,21 @@ public:
 
     std::string toString() const override;
 
+    void initialize(int capacity);
+    int capacity() const;
+    bool isFull() const;
+
     bool push(const lyric_runtime::DataCell &element);
 
     bool containsAvailableElement() const;
+    int numAvailableElements() const;
     lyric_runtime::DataCell takeAvailableElement();
 
     bool waitForPush(std::shared_ptr<lyric_runtime::Promise> promise, uv_async_t *async);
+    bool waitForCapacity(
+        const lyric_runtime::DataCell &element,
+        std::shared_ptr<lyric_runtime::Promise> promise,
+        uv_async_t *async);
     bool completePop();
 
 protected:
@@ -31,10 +42,23 @@ protected:
     void clearMembersReachable() override;
 
 private:
-    std::vector<lyric_runtime::DataCell> m_elements;
-    std::vector<std::pair<std::shared_ptr<lyric_runtime::Promise>, uv_async_t *>> m_waiting;
+    struct BlockedPush {
+        lyric_runtime::DataCell element;
+        std::shared_ptr<lyric_runtime::Promise> promise;
+        uv_async_t *async;
+    };
+
+    int m_capacity;
+    std::deque<lyric_runtime::DataCell> m_elements;
+    std::deque<std::pair<std::shared_ptr<lyric_runtime::Promise>, uv_async_t *>> m_waiting;
+    std::deque<BlockedPush> m_blocked;
 };
 
+tempo_utils::Status work_queue_ctor(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable);
+
 tempo_utils::Status work_queue_alloc(
     lyric_runtime::BytecodeInterpreter *interp,
     lyric_runtime::InterpreterState *state,
@@ -45,9 +69,19 @@ tempo_utils::Status work_queue_push(
     lyric_runtime::InterpreterState *state,
     const lyric_runtime::VirtualTable *vtable);
 
+tempo_utils::Status work_queue_push_async(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable);
+
 tempo_utils::Status work_queue_pop(
     lyric_runtime::BytecodeInterpreter *interp,
     lyric_runtime::InterpreterState *state,
     const lyric_runtime::VirtualTable *vtable);
 
+tempo_utils::Status work_queue_pop_many(
+    lyric_runtime::BytecodeInterpreter *interp,
+    lyric_runtime::InterpreterState *state,
+    const lyric_runtime::VirtualTable *vtable);
+
 #endif // ZURI_STD_SYSTEM_WORK_QUEUE_REF_H
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "native_time.h"
 #include "timezone_ref.h"
 #include "time_traps.h"
+#include "time_vtables.h"
 
 std::array<lyric_runtime::NativeTrap,9> kStdTimeTraps = {{
     {std_time_datetime_alloc, "STD_TIME_DATETIME_ALLOC", 0},
@@ -47,6 +48,7 @@ NativeStdTime::load(lyric_runtime::BytecodeSegment *segment) const
 void
 NativeStdTime::unload(lyric_runtime::BytecodeSegment *segment) const
 {
+    release_time_vtables(segment);
 }
 
 uint32_t
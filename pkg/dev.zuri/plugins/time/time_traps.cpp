@@ -9,6 +9,7 @@
 #include "timezone_ref.h"
 #include "time_traps.h"
 #include "instant_ref.h"
+#include "time_vtables.h"
 
 tempo_utils::Status
 std_time_now(
@@ -21,19 +22,9 @@ std_time_now(
     auto &frame = currentCoro->currentCallOrThrow();
     TU_ASSERT(frame.numArguments() == 0);
 
-    auto *segmentManager = state->segmentManager();
     auto *heapManager = state->heapManager();
 
-    auto *segment = currentCoro->peekSP();
-    auto object = segment->getObject();
-    auto symbol = object.findSymbol(lyric_common::SymbolPath({"Instant"}));
-    TU_ASSERT (symbol.isValid());
-
-    lyric_runtime::InterpreterStatus status;
-    auto descriptor = segmentManager->resolveDescriptor(segment,
-        symbol.getLinkageSection(), symbol.getLinkageIndex(), status);
-    TU_ASSERT (descriptor.type == lyric_runtime::DataCellType::CLASS);
-    const auto *vtable = segmentManager->resolveClassVirtualTable(descriptor, status);
+    const auto *vtable = resolve_time_vtable(state, TimeClass::Instant);
     TU_ASSERT(vtable != nullptr);
 
     // create a new instant instance
@@ -73,19 +64,9 @@ std_time_parse_timezone(
         return lyric_runtime::InterpreterStatus::forCondition(
             lyric_runtime::InterpreterCondition::kRuntimeInvariant, "failed to load timezone {}", tzName);
 
-    auto *segmentManager = state->segmentManager();
     auto *heapManager = state->heapManager();
 
-    auto *segment = currentCoro->peekSP();
-    auto object = segment->getObject();
-    auto symbol = object.findSymbol(lyric_common::SymbolPath({"Timezone"}));
-    TU_ASSERT (symbol.isValid());
-
-    lyric_runtime::InterpreterStatus status;
-    auto descriptor = segmentManager->resolveDescriptor(segment,
-        symbol.getLinkageSection(), symbol.getLinkageIndex(), status);
-    TU_ASSERT (descriptor.type == lyric_runtime::DataCellType::CLASS);
-    const auto *vtable = segmentManager->resolveClassVirtualTable(descriptor, status);
+    const auto *vtable = resolve_time_vtable(state, TimeClass::Timezone);
     TU_ASSERT(vtable != nullptr);
 
     // create a new timezone instance
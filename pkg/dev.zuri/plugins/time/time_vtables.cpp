@@ -0,0 +1,31 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+
+#include "../plugin_vtables.h"
+#include "time_vtables.h"
+
+static PluginVirtualTables<TimeClass> timeVirtualTables({{
+    "Instant",
+    "Timezone",
+}});
+
+/**
+ * Returns the virtual table for the specified class declared in the time module.
+ *
+ * @param state The interpreter state.
+ * @param timeClass The class.
+ * @return The virtual table, or nullptr if the virtual table could not be resolved.
+ */
+const lyric_runtime::VirtualTable *
+resolve_time_vtable(lyric_runtime::InterpreterState *state, TimeClass timeClass)
+{
+    return timeVirtualTables.resolve(state, timeClass);
+}
+
+/**
+ * Drop the cached virtual tables for the specified segment.
+ */
+void
+release_time_vtables(const lyric_runtime::BytecodeSegment *segment)
+{
+    timeVirtualTables.release(segment);
+}
@@ -0,0 +1,23 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+
+#ifndef ZURI_STD_TIME_TIME_VTABLES_H
+#define ZURI_STD_TIME_TIME_VTABLES_H
+
+#include <lyric_runtime/interpreter_state.h>
+
+/**
+ * The classes which the time plugin allocates instances of from native code.
+ */
+enum class TimeClass {
+    Instant,
+    Timezone,
+    NUM_CLASSES,
+};
+
+const lyric_runtime::VirtualTable *resolve_time_vtable(
+    lyric_runtime::InterpreterState *state,
+    TimeClass timeClass);
+
+void release_time_vtables(const lyric_runtime::BytecodeSegment *segment);
+
+#endif // ZURI_STD_TIME_TIME_VTABLES_H
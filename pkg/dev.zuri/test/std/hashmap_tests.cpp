@@ -97,6 +97,22 @@ TEST_F(StdCollectionsHashMap, TestEvaluateHashMapPutAndGet)
         RunModule(DataCellInt(12LL))));
 }
 
+TEST_F(StdCollectionsHashMap, TestEvaluateHashMapWithStringKeysPutAndGet)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/collections" ...
+        val strings: HashMap[String,Int] = HashMap[String,Int]{}
+        strings.Put("one", 11)
+        strings.Put("two", 12)
+        strings.Put("three", 13)
+        strings.Put("two", 22)
+        strings.Get("two")
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(
+        RunModule(DataCellInt(22LL))));
+}
+
 TEST_F(StdCollectionsHashMap, TestEvaluateHashMapPutAndRemove)
 {
     auto result = tester->runModule(R"(
@@ -147,3 +163,118 @@ TEST_F(StdCollectionsHashMap, TestEvaluateHashMapIterate)
     ASSERT_THAT (result, tempo_test::ContainsResult(
         RunModule(DataCellInt(36))));
 }
+
+TEST_F(StdCollectionsHashMap, TestEvaluateHashMapWithStandardEqualityComparesNatively)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/collections" ...
+        val ints: HashMap[Int,Int] = HashMap[Int,Int]{
+            Tuple2[Int,Int]{1, 11},
+            Tuple2[Int,Int]{2, 12}
+        }
+        ints
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(RunModule(
+        DataCellRef(
+            lyric_common::SymbolUrl(
+                lyric_common::ModuleLocation::fromString("dev.zuri.pkg://std-0.0.1@zuri.dev/collections"),
+                lyric_common::SymbolPath({"HashMap"}))))));
+
+    auto mainReturn = result.getResult().getInterpreterExit().mainReturn;
+    ASSERT_EQ (lyric_runtime::DataCellType::REF, mainReturn.type);
+    ASSERT_THAT (mainReturn.data.ref->toString(), ::testing::HasSubstr("native=true"));
+}
+
+TEST_F(StdCollectionsHashMap, TestEvaluateHashMapWithUserDefinedEqualityUsesSubinterpreter)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/collections" ...
+
+        definstance IntIdentity {
+            impl Equality[Int,Int] {
+                def Equals(lhs: Int, rhs: Int): Bool {
+                    lhs == rhs
+                }
+            }
+        }
+        using IntIdentity
+
+        val ints: HashMap[Int,Int] = HashMap[Int,Int]{
+            Tuple2[Int,Int]{1, 11},
+            Tuple2[Int,Int]{2, 12}
+        }
+        ints
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(RunModule(
+        DataCellRef(
+            lyric_common::SymbolUrl(
+                lyric_common::ModuleLocation::fromString("dev.zuri.pkg://std-0.0.1@zuri.dev/collections"),
+                lyric_common::SymbolPath({"HashMap"}))))));
+
+    auto mainReturn = result.getResult().getInterpreterExit().mainReturn;
+    ASSERT_EQ (lyric_runtime::DataCellType::REF, mainReturn.type);
+    ASSERT_THAT (mainReturn.data.ref->toString(), ::testing::HasSubstr("native=false"));
+}
+
+TEST_F(StdCollectionsHashMap, TestEvaluateHashMapPutAll)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/collections" ...
+        val ints: HashMap[Int,Int] = HashMap[Int,Int]{
+            Tuple2[Int,Int]{1, 11},
+            Tuple2[Int,Int]{2, 12}
+        }
+        val others: HashMap[Int,Int] = HashMap[Int,Int]{
+            Tuple2[Int,Int]{2, 22},
+            Tuple2[Int,Int]{3, 23}
+        }
+        ints.PutAll(others)
+        ints.Size()
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(
+        RunModule(DataCellInt(3LL))));
+}
+
+TEST_F(StdCollectionsHashMap, TestEvaluateHashMapPutAllReplacesExistingEntries)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/collections" ...
+        val ints: HashMap[Int,Int] = HashMap[Int,Int]{
+            Tuple2[Int,Int]{1, 11},
+            Tuple2[Int,Int]{2, 12}
+        }
+        val others: HashMap[Int,Int] = HashMap[Int,Int]{
+            Tuple2[Int,Int]{2, 22},
+            Tuple2[Int,Int]{3, 23}
+        }
+        ints.PutAll(others)
+        ints.Get(2)
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(
+        RunModule(DataCellInt(22LL))));
+}
+
+TEST_F(StdCollectionsHashMap, TestEvaluateHashMapReserve)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/collections" ...
+        val ints: HashMap[Int,Int] = HashMap[Int,Int]{
+            Tuple2[Int,Int]{1, 11}
+        }
+        ints.Reserve(100)
+        ints.Put(2, 12)
+        ints.Put(3, 13)
+        var sum: Int = 0
+        for entry: Tuple2[Int,Int] in ints {
+            set sum += entry.Element1
+        }
+        sum
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(
+        RunModule(DataCellInt(36LL))));
+}
@@ -97,6 +97,21 @@ TEST_F(StdCollectionsTreeMap, TestEvaluateMapPutAndGet)
         RunModule(DataCellInt(12LL))));
 }
 
+TEST_F(StdCollectionsTreeMap, TestEvaluateMapWithStringKeysPutAndGet)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/collections" ...
+        val strings: TreeMap[String,Int] = TreeMap[String,Int]{}
+        strings.Put("charlie", 13)
+        strings.Put("alpha", 11)
+        strings.Put("bravo", 12)
+        strings.Get("bravo")
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(
+        RunModule(DataCellInt(12LL))));
+}
+
 TEST_F(StdCollectionsTreeMap, TestEvaluateMapPutAndRemove)
 {
     auto result = tester->runModule(R"(
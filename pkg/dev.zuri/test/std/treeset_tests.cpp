@@ -135,4 +135,77 @@ TEST_F(StdCollectionsTreeSet, TestEvaluateTreeSetIterate)
 
     ASSERT_THAT (result, tempo_test::ContainsResult(
         RunModule(DataCellInt(6LL))));
-}
\ No newline at end of file
+}
+TEST_F(StdCollectionsTreeSet, TestEvaluateConstructTreeSetWithUnorderedDuplicateElements)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/collections" ...
+        val ints: TreeSet[Int] = TreeSet[Int]{3, 1, 2, 1, 3}
+        var digits: Int = 0
+        for n: Int in ints {
+            set digits = digits * 10 + n
+        }
+        digits
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(
+        RunModule(DataCellInt(123LL))));
+}
+
+TEST_F(StdCollectionsTreeSet, TestEvaluateTreeSetAddAll)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/collections" ...
+        val ints: TreeSet[Int] = TreeSet[Int]{1, 2}
+        val others: TreeSet[Int] = TreeSet[Int]{2, 3, 4}
+        ints.AddAll(others)
+        ints.Size()
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(
+        RunModule(DataCellInt(4LL))));
+}
+
+TEST_F(StdCollectionsTreeSet, TestEvaluateTreeSetAddAllReturnsTrueWhenElementAdded)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/collections" ...
+        val ints: TreeSet[Int] = TreeSet[Int]{1, 2}
+        val others: TreeSet[Int] = TreeSet[Int]{2, 3}
+        ints.AddAll(others)
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(
+        RunModule(DataCellBool(true))));
+}
+
+TEST_F(StdCollectionsTreeSet, TestEvaluateTreeSetAddAllReturnsFalseWhenNothingAdded)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/collections" ...
+        val ints: TreeSet[Int] = TreeSet[Int]{1, 2, 3}
+        val others: TreeSet[Int] = TreeSet[Int]{1, 3}
+        ints.AddAll(others)
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(
+        RunModule(DataCellBool(false))));
+}
+
+TEST_F(StdCollectionsTreeSet, TestEvaluateTreeSetIterateAfterAddAllOfSubset)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/collections" ...
+        val ints: TreeSet[Int] = TreeSet[Int]{1, 2, 3}
+        val others: TreeSet[Int] = TreeSet[Int]{2}
+        var sum: Int = 0
+        for n: Int in ints {
+            ints.AddAll(others)
+            set sum += n
+        }
+        sum
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(
+        RunModule(DataCellInt(6LL))));
+}
@@ -48,6 +48,20 @@ TEST_F(StdCollectionsVector, TestEvaluateConstructVectorWithElements)
         DataCellInt(3))));
 }
 
+TEST_F(StdCollectionsVector, TestEvaluateVectorExtend)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/collections" ...
+        val ints: Vector[Int] = Vector[Int]{1, 2}
+        ints.Reserve(4)
+        ints.Extend(Vector[Int]{3, 4})
+        ints.At(3)
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(
+        RunModule(DataCellInt(4LL))));
+}
+
 TEST_F(StdCollectionsVector, TestEvaluateVectorSize)
 {
     auto result = tester->runModule(R"(
@@ -68,3 +68,64 @@ TEST_F(StdSystemWorkQueue, EvaluatePushMultipleAndAwaitPopInSeparateTasks)
 
     ASSERT_THAT (result, tempo_test::ContainsResult(RunModule(DataCellInt(3))));
 }
+
+TEST_F(StdSystemWorkQueue, EvaluatePushMultipleAndPopMany)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/system" ...
+        val queue: WorkQueue[Int] = WorkQueue[Int]{}
+        queue.Push(1)
+        queue.Push(2)
+        queue.Push(3)
+        val elements: WorkBatch[Int] = queue.PopMany(2)
+        elements.Size() + elements.At(1) + AwaitOrDefault(queue.Pop(), 0)
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(RunModule(DataCellInt(7))));
+}
+
+TEST_F(StdSystemWorkQueue, EvaluateIteratePopManyBatch)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/system" ...
+        val queue: WorkQueue[Int] = WorkQueue[Int]{}
+        queue.Push(1)
+        queue.Push(2)
+        queue.Push(3)
+        val elements: WorkBatch[Int] = queue.PopMany(5)
+        var sum: Int = 0
+        for element: Int in elements {
+            set sum += element
+        }
+        sum
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(RunModule(DataCellInt(6))));
+}
+
+TEST_F(StdSystemWorkQueue, EvaluatePushToFullBoundedQueue)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/system" ...
+        val queue: WorkQueue[Int] = WorkQueue[Int]{1}
+        queue.Push(1) and queue.Push(2)
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(RunModule(DataCellBool(false))));
+}
+
+TEST_F(StdSystemWorkQueue, EvaluatePushAsyncBlocksUntilPopFreesCapacity)
+{
+    auto result = tester->runModule(R"(
+        import from "dev.zuri.pkg://std-0.0.1@zuri.dev/system" ...
+        val queue: WorkQueue[Int] = WorkQueue[Int]{1}
+        queue.Push(1)
+        val pushed: Future[Bool] = queue.PushAsync(2)
+        val first: Int = AwaitOrDefault(queue.Pop(), 0)
+        val completed: Bool = AwaitOrDefault(pushed, false)
+        val second: Int = AwaitOrDefault(queue.Pop(), 0)
+        completed then first * 10 + second else 0
+    )");
+
+    ASSERT_THAT (result, tempo_test::ContainsResult(RunModule(DataCellInt(12))));
+}